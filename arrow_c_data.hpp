@@ -0,0 +1,255 @@
+#ifndef ARROW_C_DATA_HPP
+#define ARROW_C_DATA_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "dyn_array.hpp"
+
+// Apache Arrow C Data Interface, verbatim from the specification so it can coexist with arrow's own headers
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+    struct ArrowSchema {
+        const char* format;
+        const char* name;
+        const char* metadata;
+        int64_t flags;
+        int64_t n_children;
+        struct ArrowSchema** children;
+        struct ArrowSchema* dictionary;
+        void (*release)(struct ArrowSchema*);
+        void* private_data;
+    };
+
+    struct ArrowArray {
+        int64_t length;
+        int64_t null_count;
+        int64_t offset;
+        int64_t n_buffers;
+        int64_t n_children;
+        const void** buffers;
+        struct ArrowArray** children;
+        struct ArrowArray* dictionary;
+        void (*release)(struct ArrowArray*);
+        void* private_data;
+    };
+}
+
+#endif
+
+namespace cz {
+
+    namespace detail {
+        namespace arrow {
+            // primitive format strings; nullptr for types without a matching fixed-width layout
+            template <typename T>
+            constexpr const char* format() noexcept {
+                if constexpr (std::is_same<T, bool>::value) {
+                    return nullptr; // arrow booleans are bit-packed
+                } else if constexpr (std::is_integral<T>::value) {
+                    constexpr bool s = std::is_signed<T>::value;
+                    switch (sizeof(T)) {
+                    case 1: return s ? "c" : "C";
+                    case 2: return s ? "s" : "S";
+                    case 4: return s ? "i" : "I";
+                    case 8: return s ? "l" : "L";
+                    default: return nullptr;
+                    }
+                } else if constexpr (std::is_same<T, float>::value) {
+                    return "f";
+                } else if constexpr (std::is_same<T, double>::value) {
+                    return "g";
+                } else {
+                    return nullptr;
+                }
+            }
+
+            template <typename Array>
+            struct exported_buffer {
+                typename Array::allocator_type allocator;
+                typename Array::pointer data;
+                typename Array::size_type size;
+                typename Array::size_type cap;
+                const void* buffers[2];
+            };
+
+            template <typename Array>
+            void release_array(ArrowArray* array) {
+                auto holder = static_cast<exported_buffer<Array>*>(array->private_data);
+                if (holder->data != nullptr) {
+                    for (typename Array::size_type i = 0; i < holder->size; ++i) {
+                        holder->allocator.destroy(holder->data + i);
+                    }
+                    holder->allocator.deallocate(holder->data, holder->cap);
+                }
+                delete holder;
+                array->release = nullptr;
+            }
+
+            inline void release_schema(ArrowSchema* schema) {
+                delete[] static_cast<char*>(schema->private_data);
+                schema->release = nullptr;
+            }
+        }
+    }
+
+    // hands the array's storage to an arrow consumer without copying; the consumer frees it
+    // through the release callback, which deallocates with the array's allocator
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void export_to_arrow(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>&& arr, ArrowArray* out_array, ArrowSchema* out_schema, const char* name = nullptr) {
+        using array_type = dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>;
+        static_assert(detail::arrow::format<T>() != nullptr, "no arrow primitive layout for this element type");
+
+        auto holder = new detail::arrow::exported_buffer<array_type>{arr.get_allocator(), nullptr, arr.size(), arr.cap(), {nullptr, nullptr}};
+        holder->data = arr.release();
+        holder->buffers[1] = holder->data;
+
+        out_array->length = static_cast<int64_t>(holder->size);
+        out_array->null_count = 0;
+        out_array->offset = 0;
+        out_array->n_buffers = 2;
+        out_array->n_children = 0;
+        out_array->buffers = holder->buffers;
+        out_array->children = nullptr;
+        out_array->dictionary = nullptr;
+        out_array->release = &detail::arrow::release_array<array_type>;
+        out_array->private_data = holder;
+
+        char* name_copy = nullptr;
+        if (name != nullptr) {
+            const std::size_t len = std::strlen(name);
+            name_copy = new char[len + 1];
+            std::memcpy(name_copy, name, len + 1);
+        }
+
+        out_schema->format = detail::arrow::format<T>();
+        out_schema->name = name_copy;
+        out_schema->metadata = nullptr;
+        out_schema->flags = 0;
+        out_schema->n_children = 0;
+        out_schema->children = nullptr;
+        out_schema->dictionary = nullptr;
+        out_schema->release = &detail::arrow::release_schema;
+        out_schema->private_data = name_copy;
+    }
+
+    // read-only view over an imported arrow primitive array; owns the ArrowArray and releases it on destruction
+    template <typename T, typename SizeT = std::size_t>
+    class arrow_array_view {
+
+        static_assert(detail::arrow::format<T>() != nullptr, "no arrow primitive layout for this element type");
+
+    public:
+
+        using view_type = dyn_array_view<T const, SizeT>;
+        using size_type = SizeT;
+
+    private:
+
+        ArrowArray m_array{};
+        view_type m_view;
+
+        arrow_array_view(ArrowArray* array) noexcept
+            : m_array{*array} {
+            array->release = nullptr; // moved: the producer's struct no longer owns anything
+            auto values = static_cast<T const*>(m_array.buffers[1]);
+            m_view = view_type(values == nullptr ? nullptr : values + m_array.offset, static_cast<size_type>(m_array.length));
+        }
+
+    public:
+
+        // takes ownership only of a plain primitive array: the schema matches T, neither side has children or a
+        // dictionary (a dictionary-encoded column's buffer holds indices, not values), the values are aligned
+        // for T, and there are no nulls, either counted (0) or unknown (-1) with no validity buffer; otherwise
+        // returns nullopt and leaves the array with the caller
+        static std::optional<arrow_array_view> import(ArrowArray* array, ArrowSchema const* schema) noexcept {
+            if (array == nullptr || array->release == nullptr || schema == nullptr || schema->format == nullptr) {
+                return std::nullopt;
+            }
+            if (std::strcmp(schema->format, detail::arrow::format<T>()) != 0) {
+                return std::nullopt;
+            }
+            if (schema->n_children != 0 || schema->dictionary != nullptr || array->n_children != 0 || array->dictionary != nullptr) {
+                return std::nullopt;
+            }
+            if (array->n_buffers != 2 || array->length < 0 || array->offset < 0) {
+                return std::nullopt;
+            }
+            if (array->null_count != 0 && !(array->null_count == -1 && array->buffers[0] == nullptr)) {
+                return std::nullopt;
+            }
+            if (array->length > 0 && array->buffers[1] == nullptr) {
+                return std::nullopt;
+            }
+            if (reinterpret_cast<std::uintptr_t>(array->buffers[1]) % alignof(T) != 0) {
+                return std::nullopt; // offset is in elements, so an aligned buffer keeps every element aligned
+            }
+            return arrow_array_view(array);
+        }
+
+        arrow_array_view(arrow_array_view&& other) noexcept
+            : m_array{other.m_array}
+            , m_view{other.m_view} {
+            other.m_array.release = nullptr;
+            other.m_view = view_type();
+        }
+
+        arrow_array_view& operator=(arrow_array_view&& other) noexcept {
+            assert(this != &other);
+            if (m_array.release != nullptr) {
+                m_array.release(&m_array);
+            }
+            m_array = other.m_array;
+            m_view = other.m_view;
+            other.m_array.release = nullptr;
+            other.m_view = view_type();
+            return *this;
+        }
+
+        arrow_array_view(arrow_array_view const&) = delete;
+        arrow_array_view& operator=(arrow_array_view const&) = delete;
+
+        ~arrow_array_view() {
+            if (m_array.release != nullptr) {
+                m_array.release(&m_array);
+            }
+        }
+
+        dyn_array_always_inline T const& operator[](size_type idx) const noexcept {
+            return m_view[idx];
+        }
+
+        dyn_array_always_inline view_type view() const noexcept {
+            return m_view;
+        }
+
+        dyn_array_always_inline T const* data() const noexcept {
+            return m_view.data();
+        }
+
+        dyn_array_always_inline T const* begin() const noexcept {
+            return m_view.begin();
+        }
+
+        dyn_array_always_inline T const* end() const noexcept {
+            return m_view.end();
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_view.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_view.is_empty();
+        }
+    };
+}
+
+#endif
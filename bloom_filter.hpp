@@ -0,0 +1,480 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+#include "dyn_array.hpp"
+
+// split-block Bloom filters: a key hashes to one 256-bit block and sets eight bits inside it, two per
+// 64-bit word, each picked by multiplying the key by its own odd salt. Blocks are 32-byte aligned so a
+// probe touches a single cache line, and the eight probes are tested together with one AVX2 compare.
+// The raw words are the serialized form, in host byte order.
+
+namespace cz {
+
+    namespace detail {
+        namespace bloom {
+            constexpr std::size_t block_words = 4;
+            constexpr std::size_t batch = 32;
+
+            alignas(32) constexpr std::uint32_t salts[8] = {
+                0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+            };
+
+            template <typename K>
+            inline std::uint64_t hash_key(K const& k) noexcept {
+                if constexpr (std::is_integral<K>::value) {
+                    return hashing::mix(static_cast<std::uint64_t>(k) ^ hashing::p0, hashing::p1);
+                } else {
+                    return hashing::range(&k, 1, hashing::p2);
+                }
+            }
+
+            // high half of the hash picks the block, low half the bits within it
+            inline std::size_t block_of(std::uint64_t h, std::size_t blocks) noexcept {
+                return static_cast<std::size_t>((h >> 32) * blocks >> 32);
+            }
+
+            // bit position 0..63 of probe i, which lands in word i / 2
+            inline unsigned probe_bit(std::uint32_t key, std::size_t i) noexcept {
+                return static_cast<std::uint32_t>(key * salts[i]) >> 26;
+            }
+
+            namespace scalar {
+                inline void block_mask(std::uint32_t key, std::uint64_t* m) noexcept {
+                    for (std::size_t w = 0; w < block_words; ++w) {
+                        m[w] = std::uint64_t{1} << probe_bit(key, 2 * w) | std::uint64_t{1} << probe_bit(key, 2 * w + 1);
+                    }
+                }
+
+                inline void insert(std::uint64_t* words, std::size_t blocks, std::uint64_t h) noexcept {
+                    std::uint64_t m[block_words];
+                    block_mask(static_cast<std::uint32_t>(h), m);
+                    std::uint64_t* b = words + block_of(h, blocks) * block_words;
+                    for (std::size_t w = 0; w < block_words; ++w) {
+                        b[w] |= m[w];
+                    }
+                }
+
+                inline bool contains(std::uint64_t const* words, std::size_t blocks, std::uint64_t h) noexcept {
+                    std::uint64_t m[block_words];
+                    block_mask(static_cast<std::uint32_t>(h), m);
+                    std::uint64_t const* b = words + block_of(h, blocks) * block_words;
+                    std::uint64_t missing = 0;
+                    for (std::size_t w = 0; w < block_words; ++w) {
+                        missing |= m[w] & ~b[w];
+                    }
+                    return missing == 0;
+                }
+
+                inline void insert_batch(std::uint64_t* words, std::size_t blocks, std::uint64_t const* h, std::size_t n) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        insert(words, blocks, h[i]);
+                    }
+                }
+
+                inline void contains_batch(std::uint64_t const* words, std::size_t blocks, std::uint64_t const* h, std::size_t n, std::uint8_t* out) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        out[i] = contains(words, blocks, h[i]);
+                    }
+                }
+            }
+
+#ifdef DYN_ARRAY_SIMD_X86
+DYN_ARRAY_SIMD_TARGET_BEGIN("avx2")
+            namespace avx2 {
+                // the eight 6-bit positions come out of one 32-bit multiply; even lanes feed the low
+                // bit of each 64-bit word and odd lanes the high one
+                inline __m256i block_mask(std::uint32_t key) noexcept {
+                    const __m256i salt = _mm256_load_si256(reinterpret_cast<__m256i const*>(salts));
+                    const __m256i pos = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt), 26);
+                    const __m256i one = _mm256_set1_epi64x(1);
+                    const __m256i lo = _mm256_and_si256(pos, _mm256_set1_epi64x(0xffffffff));
+                    const __m256i hi = _mm256_srli_epi64(pos, 32);
+                    return _mm256_or_si256(_mm256_sllv_epi64(one, lo), _mm256_sllv_epi64(one, hi));
+                }
+
+                inline void insert(std::uint64_t* words, std::size_t blocks, std::uint64_t h) noexcept {
+                    auto b = reinterpret_cast<__m256i*>(words + block_of(h, blocks) * block_words);
+                    _mm256_store_si256(b, _mm256_or_si256(_mm256_load_si256(b), block_mask(static_cast<std::uint32_t>(h))));
+                }
+
+                inline bool contains(std::uint64_t const* words, std::size_t blocks, std::uint64_t h) noexcept {
+                    auto b = reinterpret_cast<__m256i const*>(words + block_of(h, blocks) * block_words);
+                    return _mm256_testc_si256(_mm256_load_si256(b), block_mask(static_cast<std::uint32_t>(h))) != 0;
+                }
+
+                inline void insert_batch(std::uint64_t* words, std::size_t blocks, std::uint64_t const* h, std::size_t n) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        insert(words, blocks, h[i]);
+                    }
+                }
+
+                inline void contains_batch(std::uint64_t const* words, std::size_t blocks, std::uint64_t const* h, std::size_t n, std::uint8_t* out) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        out[i] = contains(words, blocks, h[i]);
+                    }
+                }
+            }
+DYN_ARRAY_SIMD_TARGET_END
+#endif
+
+            inline void insert(std::uint64_t* words, std::size_t blocks, std::uint64_t h) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::insert(words, blocks, h);
+                }
+#endif
+                scalar::insert(words, blocks, h);
+            }
+
+            inline bool contains(std::uint64_t const* words, std::size_t blocks, std::uint64_t h) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::contains(words, blocks, h);
+                }
+#endif
+                return scalar::contains(words, blocks, h);
+            }
+
+            inline void insert_batch(std::uint64_t* words, std::size_t blocks, std::uint64_t const* h, std::size_t n) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::insert_batch(words, blocks, h, n);
+                }
+#endif
+                scalar::insert_batch(words, blocks, h, n);
+            }
+
+            inline void contains_batch(std::uint64_t const* words, std::size_t blocks, std::uint64_t const* h, std::size_t n, std::uint8_t* out) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::contains_batch(words, blocks, h, n, out);
+                }
+#endif
+                scalar::contains_batch(words, blocks, h, n, out);
+            }
+
+            // hashes keys in batches, prefetching every block of a batch before any of them is probed
+            // once the filter outgrows the caches; run(hashes, first, count) then does the probing
+            template <typename Keys, typename Run>
+            void batched(Keys const& keys, std::uint64_t const* words, std::size_t blocks, std::size_t block_bytes, Run run) {
+                const std::size_t n = static_cast<std::size_t>(keys.size());
+                const bool prefetch = blocks * block_bytes >= simd::prefetch_min_bytes;
+                auto const* k = keys.data();
+
+                std::uint64_t h[batch];
+                for (std::size_t first = 0; first < n; first += batch) {
+                    const std::size_t m = n - first < batch ? n - first : batch;
+                    for (std::size_t i = 0; i < m; ++i) {
+                        h[i] = hash_key(k[first + i]);
+                    }
+                    if (prefetch) {
+                        for (std::size_t i = 0; i < m; ++i) {
+                            DYN_ARRAY_PREFETCH(reinterpret_cast<char const*>(words) + block_of(h[i], blocks) * block_bytes);
+                        }
+                    }
+                    run(h, first, m);
+                }
+            }
+
+            // expected false positive rate at a mean load of lambda keys per block: loads are Poisson, and a
+            // block holding x keys has 2x random bits in each word, of which a query needs two
+            inline double false_positive_rate(double lambda) noexcept {
+                const double spread = 12.0 * std::sqrt(lambda) + 12.0;
+                const auto lo = static_cast<std::size_t>(lambda > spread ? lambda - spread : 0.0);
+                const auto hi = static_cast<std::size_t>(lambda + spread);
+                double rate = 0.0;
+                for (std::size_t x = lo; x <= hi; ++x) {
+                    const double px = std::exp(static_cast<double>(x) * std::log(lambda) - lambda - std::lgamma(static_cast<double>(x) + 1.0));
+                    const double word = 1.0 - std::pow(63.0 / 64.0, 2.0 * static_cast<double>(x));
+                    rate += px * std::pow(word * word, 4);
+                }
+                return rate;
+            }
+
+            // fewest blocks that hold expected_keys at or below the target rate
+            inline std::size_t blocks_for(std::size_t expected_keys, double target) noexcept {
+                assert(target > 0.0 && target < 1.0);
+                if (expected_keys == 0) {
+                    return 1;
+                }
+                const auto n = static_cast<double>(expected_keys);
+                std::size_t lo = 1, hi = 1;
+                while (false_positive_rate(n / static_cast<double>(hi)) > target) {
+                    lo = hi + 1;
+                    hi *= 2;
+                }
+                while (lo < hi) {
+                    const std::size_t mid = lo + (hi - lo) / 2;
+                    if (false_positive_rate(n / static_cast<double>(mid)) > target) {
+                        lo = mid + 1;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                return hi;
+            }
+        }
+    }
+
+    class blocked_bloom_filter {
+    public:
+
+        using words_type = dyn_array<std::uint64_t, detail::aligned_allocator<std::uint64_t, 32>>;
+
+    private:
+
+        words_type m_words;
+        std::size_t m_blocks;
+
+        friend class counting_bloom_filter;
+
+        explicit blocked_bloom_filter(std::size_t blocks, int)
+            : m_words(blocks * detail::bloom::block_words, std::uint64_t{0})
+            , m_blocks{blocks} {
+        }
+
+    public:
+
+        // sized for expected_keys at the given false positive rate
+        explicit blocked_bloom_filter(std::size_t expected_keys, double false_positive_rate = 0.01)
+            : blocked_bloom_filter(detail::bloom::blocks_for(expected_keys, false_positive_rate), 0) {
+        }
+
+        // nullopt unless words holds a whole, non-zero number of blocks
+        static std::optional<blocked_bloom_filter> from_words(dyn_array_view<std::uint64_t const> words) {
+            if (words.size() == 0 || words.size() % detail::bloom::block_words != 0) {
+                return std::nullopt;
+            }
+            blocked_bloom_filter f(words.size() / detail::bloom::block_words, 0);
+            std::memcpy(f.m_words.data(), words.data(), words.size() * sizeof(std::uint64_t));
+            return f;
+        }
+
+        dyn_array_always_inline void insert_hash(std::uint64_t h) noexcept {
+            detail::bloom::insert(m_words.data(), m_blocks, h);
+        }
+
+        dyn_array_always_inline bool contains_hash(std::uint64_t h) const noexcept {
+            return detail::bloom::contains(m_words.data(), m_blocks, h);
+        }
+
+        template <typename K>
+        dyn_array_always_inline void insert(K const& key) noexcept {
+            insert_hash(detail::bloom::hash_key(key));
+        }
+
+        // false means definitely absent
+        template <typename K>
+        dyn_array_always_inline bool contains(K const& key) const noexcept {
+            return contains_hash(detail::bloom::hash_key(key));
+        }
+
+        template <typename Keys>
+        void insert_all(Keys const& keys) {
+            detail::bloom::batched(keys, m_words.data(), m_blocks, 32, [&](std::uint64_t const* h, std::size_t, std::size_t m) {
+                detail::bloom::insert_batch(m_words.data(), m_blocks, h, m);
+            });
+        }
+
+        // one byte per key, 1 where the key may be present
+        template <typename Keys>
+        dyn_array<std::uint8_t> contains_all(Keys const& keys) const {
+            dyn_array<std::uint8_t> out;
+            out.resize_and_overwrite(static_cast<std::size_t>(keys.size()), [&](std::uint8_t* p, std::size_t n) {
+                detail::bloom::batched(keys, m_words.data(), m_blocks, 32, [&](std::uint64_t const* h, std::size_t first, std::size_t m) {
+                    detail::bloom::contains_batch(m_words.data(), m_blocks, h, m, p + first);
+                });
+                return n;
+            });
+            return out;
+        }
+
+        // other must have the same number of blocks
+        blocked_bloom_filter& operator|=(blocked_bloom_filter const& other) noexcept {
+            assert(m_blocks == other.m_blocks);
+            for (std::size_t i = 0; i < m_words.size(); ++i) {
+                m_words[i] |= other.m_words[i];
+            }
+            return *this;
+        }
+
+        void clear() noexcept {
+            m_words.fill(0);
+        }
+
+        dyn_array_always_inline words_type const& words() const noexcept {
+            return m_words;
+        }
+
+        dyn_array_always_inline std::size_t blocks() const noexcept {
+            return m_blocks;
+        }
+
+        dyn_array_always_inline std::size_t size_bytes() const noexcept {
+            return m_words.size() * sizeof(std::uint64_t);
+        }
+    };
+
+    // same hashing and layout as blocked_bloom_filter, with each bit widened to a 4-bit counter so keys can
+    // be removed; a block's 256 counters fill two adjacent cache lines. Counters stick at 15 once reached
+    class counting_bloom_filter {
+    public:
+
+        using words_type = dyn_array<std::uint64_t, detail::aligned_allocator<std::uint64_t, 128>>;
+
+    private:
+
+        static constexpr std::size_t _block_words = 16;
+
+        words_type m_words;
+        std::size_t m_blocks;
+
+        explicit counting_bloom_filter(std::size_t blocks, int)
+            : m_words(blocks * _block_words, std::uint64_t{0})
+            , m_blocks{blocks} {
+        }
+
+        // word and shift of the counter behind probe i
+        dyn_array_always_inline static void _counter(std::uint64_t h, std::size_t blocks, std::size_t i, std::size_t& word, unsigned& shift) noexcept {
+            const unsigned bit = detail::bloom::probe_bit(static_cast<std::uint32_t>(h), i);
+            word = detail::bloom::block_of(h, blocks) * _block_words + (i / 2) * 4 + bit / 16;
+            shift = (bit % 16) * 4;
+        }
+
+        bool _contains(std::uint64_t h) const noexcept {
+            bool all = true;
+            for (std::size_t i = 0; i < 8; ++i) {
+                std::size_t w;
+                unsigned s;
+                _counter(h, m_blocks, i, w, s);
+                all &= (m_words[w] >> s & 0xf) != 0;
+            }
+            return all;
+        }
+
+    public:
+
+        explicit counting_bloom_filter(std::size_t expected_keys, double false_positive_rate = 0.01)
+            : counting_bloom_filter(detail::bloom::blocks_for(expected_keys, false_positive_rate), 0) {
+        }
+
+        static std::optional<counting_bloom_filter> from_words(dyn_array_view<std::uint64_t const> words) {
+            if (words.size() == 0 || words.size() % _block_words != 0) {
+                return std::nullopt;
+            }
+            counting_bloom_filter f(words.size() / _block_words, 0);
+            std::memcpy(f.m_words.data(), words.data(), words.size() * sizeof(std::uint64_t));
+            return f;
+        }
+
+        void insert_hash(std::uint64_t h) noexcept {
+            for (std::size_t i = 0; i < 8; ++i) {
+                std::size_t w;
+                unsigned s;
+                _counter(h, m_blocks, i, w, s);
+                m_words[w] += static_cast<std::uint64_t>((m_words[w] >> s & 0xf) != 0xf) << s;
+            }
+        }
+
+        // h must have been inserted; saturated counters are left alone since their true count is unknown
+        void remove_hash(std::uint64_t h) noexcept {
+            assert(_contains(h) && "removing a key that was never inserted");
+            for (std::size_t i = 0; i < 8; ++i) {
+                std::size_t w;
+                unsigned s;
+                _counter(h, m_blocks, i, w, s);
+                m_words[w] -= static_cast<std::uint64_t>((m_words[w] >> s & 0xf) != 0xf) << s;
+            }
+        }
+
+        dyn_array_always_inline bool contains_hash(std::uint64_t h) const noexcept {
+            return _contains(h);
+        }
+
+        template <typename K>
+        dyn_array_always_inline void insert(K const& key) noexcept {
+            insert_hash(detail::bloom::hash_key(key));
+        }
+
+        template <typename K>
+        dyn_array_always_inline void remove(K const& key) noexcept {
+            remove_hash(detail::bloom::hash_key(key));
+        }
+
+        template <typename K>
+        dyn_array_always_inline bool contains(K const& key) const noexcept {
+            return _contains(detail::bloom::hash_key(key));
+        }
+
+        template <typename Keys>
+        void insert_all(Keys const& keys) {
+            detail::bloom::batched(keys, m_words.data(), m_blocks, 128, [&](std::uint64_t const* h, std::size_t, std::size_t m) {
+                for (std::size_t i = 0; i < m; ++i) {
+                    insert_hash(h[i]);
+                }
+            });
+        }
+
+        template <typename Keys>
+        void remove_all(Keys const& keys) {
+            detail::bloom::batched(keys, m_words.data(), m_blocks, 128, [&](std::uint64_t const* h, std::size_t, std::size_t m) {
+                for (std::size_t i = 0; i < m; ++i) {
+                    remove_hash(h[i]);
+                }
+            });
+        }
+
+        template <typename Keys>
+        dyn_array<std::uint8_t> contains_all(Keys const& keys) const {
+            dyn_array<std::uint8_t> out;
+            out.resize_and_overwrite(static_cast<std::size_t>(keys.size()), [&](std::uint8_t* p, std::size_t n) {
+                detail::bloom::batched(keys, m_words.data(), m_blocks, 128, [&](std::uint64_t const* h, std::size_t first, std::size_t m) {
+                    for (std::size_t i = 0; i < m; ++i) {
+                        p[first + i] = _contains(h[i]);
+                    }
+                });
+                return n;
+            });
+            return out;
+        }
+
+        // the plain filter answering the same queries, a quarter of the size
+        blocked_bloom_filter compact() const {
+            blocked_bloom_filter f(m_blocks, 0);
+            for (std::size_t b = 0; b < m_blocks; ++b) {
+                for (std::size_t w = 0; w < detail::bloom::block_words; ++w) {
+                    std::uint64_t bits = 0;
+                    for (std::size_t c = 0; c < 64; ++c) {
+                        const std::uint64_t word = m_words[b * _block_words + w * 4 + c / 16];
+                        bits |= static_cast<std::uint64_t>((word >> (c % 16 * 4) & 0xf) != 0) << c;
+                    }
+                    f.m_words[b * detail::bloom::block_words + w] = bits;
+                }
+            }
+            return f;
+        }
+
+        void clear() noexcept {
+            m_words.fill(0);
+        }
+
+        dyn_array_always_inline words_type const& words() const noexcept {
+            return m_words;
+        }
+
+        dyn_array_always_inline std::size_t blocks() const noexcept {
+            return m_blocks;
+        }
+
+        dyn_array_always_inline std::size_t size_bytes() const noexcept {
+            return m_words.size() * sizeof(std::uint64_t);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef COLUMN_TABLE_HPP
+#define COLUMN_TABLE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include "dyn_array.hpp"
+#include "dyn_array_parallel.hpp"
+
+namespace cz {
+
+    using selection_vector = dyn_array<std::uint32_t>;
+
+    template <typename K, typename V>
+    struct group_aggregates {
+        dyn_array<K> keys; // in order of first appearance
+        dyn_array<std::uint64_t> count;
+        dyn_array<V> sum;
+        dyn_array<V> min;
+        dyn_array<V> max;
+
+        dyn_array_always_inline std::size_t size() const noexcept {
+            return keys.size();
+        }
+    };
+
+    namespace detail {
+        namespace table {
+            template <typename K>
+            inline std::uint64_t hash_key(K const& k) noexcept {
+                if constexpr (std::is_integral<K>::value) {
+                    return hashing::mix(static_cast<std::uint64_t>(k) ^ hashing::p0, hashing::p1);
+                } else {
+                    return hashing::mix(static_cast<std::uint64_t>(std::hash<K>{}(k)) ^ hashing::p0, hashing::p1);
+                }
+            }
+
+            // open addressing with linear probing; slots hold group index + 1, 0 marks empty
+            template <typename K, typename V>
+            class group_table {
+
+                dyn_array<std::uint32_t> m_slots;
+                std::size_t m_mask;
+                group_aggregates<K, V> m_groups;
+
+                void _grow() {
+                    dyn_array<std::uint32_t> slots(m_slots.size() * 2, std::uint32_t{0});
+                    m_mask = slots.size() - 1;
+                    for (std::size_t g = 0; g < m_groups.size(); ++g) {
+                        std::size_t s = hash_key(m_groups.keys[g]) & m_mask;
+                        while (slots[s] != 0) {
+                            s = (s + 1) & m_mask;
+                        }
+                        slots[s] = static_cast<std::uint32_t>(g + 1);
+                    }
+                    m_slots = std::move(slots);
+                }
+
+            public:
+
+                group_table()
+                    : m_slots(std::size_t{64}, std::uint32_t{0})
+                    , m_mask{63} {
+                }
+
+                std::size_t group_of(K const& key, V const& first_value) {
+                    std::size_t s = hash_key(key) & m_mask;
+                    for (;;) {
+                        const std::uint32_t g = m_slots[s];
+                        if (g == 0) {
+                            break;
+                        }
+                        if (m_groups.keys[g - 1] == key) {
+                            return g - 1;
+                        }
+                        s = (s + 1) & m_mask;
+                    }
+
+                    const std::size_t g = m_groups.size();
+                    m_slots[s] = static_cast<std::uint32_t>(g + 1);
+                    m_groups.keys.push_back(key);
+                    m_groups.count.push_back(0);
+                    m_groups.sum.push_back(V{});
+                    m_groups.min.push_back(first_value);
+                    m_groups.max.push_back(first_value);
+                    if (m_groups.size() * 2 > m_slots.size()) {
+                        _grow();
+                    }
+                    return g;
+                }
+
+                dyn_array_always_inline void add(K const& key, V const& value) {
+                    const std::size_t g = group_of(key, value);
+                    ++m_groups.count[g];
+                    m_groups.sum[g] += value;
+                    if (value < m_groups.min[g]) {
+                        m_groups.min[g] = value;
+                    }
+                    if (m_groups.max[g] < value) {
+                        m_groups.max[g] = value;
+                    }
+                }
+
+                void merge(group_table const& other) {
+                    auto const& o = other.m_groups;
+                    for (std::size_t i = 0; i < o.size(); ++i) {
+                        const std::size_t g = group_of(o.keys[i], o.min[i]);
+                        m_groups.count[g] += o.count[i];
+                        m_groups.sum[g] += o.sum[i];
+                        if (o.min[i] < m_groups.min[g]) {
+                            m_groups.min[g] = o.min[i];
+                        }
+                        if (m_groups.max[g] < o.max[i]) {
+                            m_groups.max[g] = o.max[i];
+                        }
+                    }
+                }
+
+                group_aggregates<K, V> release() {
+                    return std::move(m_groups);
+                }
+            };
+        }
+    }
+
+    // named columns of equal length, processed a column at a time
+    class column_table {
+    public:
+
+        using column_type = std::variant<
+            dyn_array<std::int8_t>, dyn_array<std::int16_t>, dyn_array<std::int32_t>, dyn_array<std::int64_t>,
+            dyn_array<std::uint8_t>, dyn_array<std::uint16_t>, dyn_array<std::uint32_t>, dyn_array<std::uint64_t>,
+            dyn_array<float>, dyn_array<double>
+        >;
+
+    private:
+
+        dyn_array<std::string> m_names;
+        dyn_array<column_type> m_columns;
+        std::size_t m_rows = 0;
+
+        std::size_t _index(std::string_view name) const noexcept {
+            for (std::size_t i = 0; i < m_names.size(); ++i) {
+                if (m_names[i] == name) {
+                    return i;
+                }
+            }
+            return m_names.size();
+        }
+
+    public:
+
+        column_table() = default;
+
+        template <typename T>
+        void add_column(std::string name, dyn_array<T> values) {
+            assert((m_columns.is_empty() || values.size() == m_rows) && "columns must have equal length");
+            assert(_index(name) == m_names.size() && "duplicate column name");
+            m_rows = values.size();
+            m_names.push_back(std::move(name));
+            m_columns.push_back(column_type(std::move(values)));
+        }
+
+        template <typename T>
+        dyn_array<T> const& column(std::string_view name) const noexcept {
+            const std::size_t i = _index(name);
+            assert(i < m_columns.size() && "no such column");
+            auto p = std::get_if<dyn_array<T>>(&m_columns[i]);
+            assert(p != nullptr && "column has a different element type");
+            return *p;
+        }
+
+        dyn_array_always_inline bool has_column(std::string_view name) const noexcept {
+            return _index(name) != m_names.size();
+        }
+
+        // rows whose value in the named column satisfies pred; the selection is written branch-free
+        // (every row is stored, the cursor only advances on a match) so the loop has no data-dependent jumps
+        template <typename T, typename Pred>
+        selection_vector filter(std::string_view name, Pred pred, unsigned threads = 1) const {
+            assert(m_rows <= std::numeric_limits<std::uint32_t>::max());
+            dyn_array<T> const& col = column<T>(name);
+
+            selection_vector sel(m_rows, std::uint32_t{0});
+            dyn_array<std::size_t> found(std::size_t{threads == 0 ? 1u : threads} + 1, std::size_t{0});
+            dyn_array<std::size_t> starts(found.size(), std::size_t{0});
+
+            detail::parallel::for_each_chunk(m_rows, threads, [&](std::size_t c, std::size_t f, std::size_t l) {
+                std::uint32_t* out = sel.data() + f;
+                std::size_t n = 0;
+                for (std::size_t i = f; i < l; ++i) {
+                    out[n] = static_cast<std::uint32_t>(i);
+                    n += pred(col[i]) ? 1 : 0;
+                }
+                found[c] = n;
+                starts[c] = f;
+            });
+
+            // chunks wrote into their own row range; close the gaps
+            std::size_t total = 0;
+            for (std::size_t c = 0; c < found.size(); ++c) {
+                if (found[c] != 0 && starts[c] != total) {
+                    std::memmove(sel.data() + total, sel.data() + starts[c], found[c] * sizeof(std::uint32_t));
+                }
+                total += found[c];
+            }
+            sel.resize(total);
+            return sel;
+        }
+
+        // narrows an existing selection
+        template <typename T, typename Pred>
+        selection_vector filter(std::string_view name, Pred pred, selection_vector const& within) const {
+            dyn_array<T> const& col = column<T>(name);
+            selection_vector sel(within.size(), std::uint32_t{0});
+            std::size_t n = 0;
+            for (auto row : within) {
+                sel[n] = row;
+                n += pred(col[row]) ? 1 : 0;
+            }
+            sel.resize(n);
+            return sel;
+        }
+
+        // a new table holding the selected rows, in selection order
+        column_table gather(selection_vector const& sel) const {
+            column_table out;
+            out.m_rows = sel.size();
+            out.m_names = m_names;
+            out.m_columns.reserve(m_columns.size());
+            for (auto const& col : m_columns) {
+                out.m_columns.push_back(std::visit([&sel](auto const& values) {
+                    return column_type(values.gather(sel));
+                }, col));
+            }
+            return out;
+        }
+
+        // count/sum/min/max of the value column per distinct key; each thread aggregates its row chunk
+        // into a private table, and the partial tables are merged in chunk order
+        template <typename K, typename V>
+        group_aggregates<K, V> group_by(std::string_view key, std::string_view value, unsigned threads = 1) const {
+            dyn_array<K> const& keys = column<K>(key);
+            dyn_array<V> const& values = column<V>(value);
+
+            dyn_array<detail::table::group_table<K, V>> partial(std::size_t{threads == 0 ? 1u : threads});
+            detail::parallel::for_each_chunk(m_rows, threads, [&](std::size_t c, std::size_t f, std::size_t l) {
+                auto& t = partial[c];
+                for (std::size_t i = f; i < l; ++i) {
+                    t.add(keys[i], values[i]);
+                }
+            });
+
+            for (std::size_t c = 1; c < partial.size(); ++c) {
+                partial[0].merge(partial[c]);
+            }
+            return partial[0].release();
+        }
+
+        template <typename K, typename V>
+        group_aggregates<K, V> group_by(std::string_view key, std::string_view value, selection_vector const& sel) const {
+            dyn_array<K> const& keys = column<K>(key);
+            dyn_array<V> const& values = column<V>(value);
+
+            detail::table::group_table<K, V> t;
+            for (auto row : sel) {
+                t.add(keys[row], values[row]);
+            }
+            return t.release();
+        }
+
+        dyn_array_always_inline dyn_array<std::string> const& names() const noexcept {
+            return m_names;
+        }
+
+        dyn_array_always_inline std::size_t rows() const noexcept {
+            return m_rows;
+        }
+
+        dyn_array_always_inline std::size_t columns() const noexcept {
+            return m_columns.size();
+        }
+    };
+}
+
+#endif
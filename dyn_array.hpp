@@ -2,7 +2,19 @@
 #define DYN_ARRAY_HPP
 
 #include <memory>
+#include <new>
 #include <cassert>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+#include "dyn_array_simd.hpp"
+#include "dyn_array_sort.hpp"
+
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
 
 #ifdef __GNUC__
 #   define dyn_array_always_inline __attribute__((always_inline))
@@ -25,8 +37,293 @@ namespace cz {
             std::is_convertible<decltype(std::declval<U>() != std::declval<T>()), bool>::value
         >::type> : std::true_type {
         };
+
+        // storage that can be filled, copied and compared with plain memory operations
+        template <typename T, typename alloc_t>
+        struct is_bitwise_storage : std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value &&
+            std::is_same<alloc_t, std::allocator<T>>::value
+        > {
+        };
+
+        // std::allocator with a fixed over-alignment, for storage that must start on a cache line or similar boundary
+        template <typename T, std::size_t Align>
+        struct aligned_allocator {
+            using value_type = T;
+
+            T* allocate(std::size_t n) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+            }
+
+            void deallocate(T* p, std::size_t) noexcept {
+                ::operator delete(p, std::align_val_t{Align});
+            }
+
+            template <typename... Types>
+            void construct(T* p, Types&&... args) {
+                ::new (static_cast<void*>(p)) T(std::forward<Types>(args)...);
+            }
+
+            void destroy(T* p) noexcept {
+                p->~T();
+            }
+
+            bool operator==(aligned_allocator const&) const noexcept {
+                return true;
+            }
+
+            bool operator!=(aligned_allocator const&) const noexcept {
+                return false;
+            }
+        };
+
+        template <typename T>
+        struct is_byte : std::integral_constant<bool,
+            std::is_integral<T>::value && sizeof(T) == 1 && !std::is_same<T, bool>::value
+        > {
+        };
+
+        namespace bits {
+            dyn_array_always_inline inline unsigned ctz64(std::uint64_t x) noexcept { // x != 0
+#if defined(__GNUC__)
+                return static_cast<unsigned>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_WIN64)
+                unsigned long idx;
+                _BitScanForward64(&idx, x);
+                return static_cast<unsigned>(idx);
+#else
+                unsigned n = 0;
+                for (; (x & 1) == 0; x >>= 1) {
+                    ++n;
+                }
+                return n;
+#endif
+            }
+
+            dyn_array_always_inline inline unsigned popcount64(std::uint64_t x) noexcept {
+#if defined(__GNUC__)
+                return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+                x = x - ((x >> 1) & 0x5555555555555555ull);
+                x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+                x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+                return static_cast<unsigned>((x * 0x0101010101010101ull) >> 56);
+#endif
+            }
+        }
+
+        namespace hashing {
+            // wyhash-style multiply-fold mixing over 64-bit reads
+            constexpr std::uint64_t p0 = 0xa0761d6478bd642full;
+            constexpr std::uint64_t p1 = 0xe7037ed1a0b428dbull;
+            constexpr std::uint64_t p2 = 0x8ebc6af09c88c6e3ull;
+            constexpr std::uint64_t p3 = 0x589965cc75374cc3ull;
+
+            inline std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+                __extension__ typedef unsigned __int128 u128;
+                const u128 r = static_cast<u128>(a) * b;
+                return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+                const std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+                const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+                const std::uint64_t t = rl + (rm0 << 32);
+                std::uint64_t lo = t + (rm1 << 32);
+                std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+                return lo ^ hi;
+#endif
+            }
+
+            inline std::uint64_t read64(unsigned char const* p) noexcept {
+                std::uint64_t v;
+                std::memcpy(&v, p, 8);
+                return v;
+            }
+
+            inline std::uint64_t read32(unsigned char const* p) noexcept {
+                std::uint32_t v;
+                std::memcpy(&v, p, 4);
+                return v;
+            }
+
+            inline std::uint64_t bytes(void const* data, std::size_t len, std::uint64_t seed = 0) noexcept {
+                auto p = static_cast<unsigned char const*>(data);
+                seed ^= mix(seed ^ p0, p1);
+
+                std::uint64_t a, b;
+                if (len <= 16) {
+                    if (len >= 4) {
+                        a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+                        b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+                    } else if (len > 0) {
+                        a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+                        b = 0;
+                    } else {
+                        a = b = 0;
+                    }
+                } else {
+                    std::size_t i = len;
+                    if (i > 48) {
+                        // three independent lanes keep the multipliers busy
+                        std::uint64_t s1 = seed, s2 = seed;
+                        do {
+                            seed = mix(read64(p) ^ p1, read64(p + 8) ^ seed);
+                            s1 = mix(read64(p + 16) ^ p2, read64(p + 24) ^ s1);
+                            s2 = mix(read64(p + 32) ^ p3, read64(p + 40) ^ s2);
+                            p += 48;
+                            i -= 48;
+                        } while (i > 48);
+                        seed ^= s1 ^ s2;
+                    }
+                    while (i > 16) {
+                        seed = mix(read64(p) ^ p1, read64(p + 8) ^ seed);
+                        p += 16;
+                        i -= 16;
+                    }
+                    a = read64(p + i - 16);
+                    b = read64(p + i - 8);
+                }
+
+                return mix(p1 ^ len, mix(a ^ p1, b ^ seed));
+            }
+
+            template <typename T>
+            std::uint64_t range(T const* p, std::size_t n, std::uint64_t seed) {
+                if constexpr (std::has_unique_object_representations<T>::value) {
+                    return bytes(p, n * sizeof(T), seed);
+                } else {
+                    std::uint64_t h = seed ^ mix(n ^ p0, p1);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        h = mix(h ^ static_cast<std::uint64_t>(std::hash<T>{}(p[i])), p2);
+                    }
+                    return h;
+                }
+            }
+        }
+    }
+
+    template <typename T, typename SizeT>
+    class dyn_array_view;
+
+    namespace detail {
+        template <typename T>
+        struct is_dyn_array_view : std::false_type {
+        };
+
+        template <typename T, typename SizeT>
+        struct is_dyn_array_view<dyn_array_view<T, SizeT>> : std::true_type {
+        };
     }
 
+    // non-owning [data, data + size) range; invalidated by anything that reallocates the viewed array
+    template <typename T, typename SizeT = std::size_t>
+    class dyn_array_view {
+
+        static_assert(std::is_integral<SizeT>::value);
+
+    public:
+
+        using value_type = typename std::remove_cv<T>::type;
+        using size_type = SizeT;
+        using reference = T&;
+        using const_reference = T const&;
+        using pointer = T*;
+        using const_pointer = T const*;
+        using iterator = T*;
+        using const_iterator = T const*;
+
+    private:
+
+        pointer m_begin = nullptr;
+        size_type m_size = 0;
+
+    public:
+
+        constexpr dyn_array_view() noexcept = default;
+
+        constexpr dyn_array_view(pointer p, size_type n) noexcept
+            : m_begin{p}
+            , m_size{n} {
+        }
+
+        template <typename Container, typename = typename std::enable_if<
+            !detail::is_dyn_array_view<typename std::remove_cv<Container>::type>::value &&
+            std::is_convertible<decltype(std::declval<Container&>().data()), pointer>::value
+        >::type>
+        constexpr dyn_array_view(Container& c) noexcept
+            : m_begin{c.data()}
+            , m_size{static_cast<size_type>(c.size())} {
+        }
+
+        // view<T> to view<T const>, also from temporaries such as a.view()
+        template <typename U, typename S, typename = typename std::enable_if<
+            !std::is_same<dyn_array_view<U, S>, dyn_array_view>::value &&
+            std::is_convertible<U*, pointer>::value
+        >::type>
+        constexpr dyn_array_view(dyn_array_view<U, S> const& other) noexcept
+            : m_begin{other.data()}
+            , m_size{static_cast<size_type>(other.size())} {
+        }
+
+        template <typename other_value_type, typename other_size_type>
+        bool operator==(dyn_array_view<other_value_type, other_size_type> const& other) const {
+            return static_cast<std::size_t>(m_size) == static_cast<std::size_t>(other.size()) && std::equal(begin(), end(), other.begin());
+        }
+
+        template <typename other_value_type, typename other_size_type>
+        dyn_array_always_inline bool operator!=(dyn_array_view<other_value_type, other_size_type> const& other) const {
+            return not (*this == other);
+        }
+
+        dyn_array_always_inline reference operator[](size_type idx) const noexcept {
+            assert(idx < m_size);
+            return m_begin[idx];
+        }
+
+        dyn_array_always_inline dyn_array_view slice(size_type f, size_type l) const noexcept { // [first, last)
+            assert(f <= l && l <= m_size);
+            return dyn_array_view(m_begin + f, l - f);
+        }
+
+        dyn_array_always_inline reference front() const noexcept {
+            assert(m_size > 0);
+            return *m_begin;
+        }
+
+        dyn_array_always_inline reference back() const noexcept {
+            assert(m_size > 0);
+            return m_begin[m_size - 1];
+        }
+
+        dyn_array_always_inline pointer data() const noexcept {
+            return m_begin;
+        }
+
+        dyn_array_always_inline iterator begin() const noexcept {
+            return m_begin;
+        }
+
+        dyn_array_always_inline const_iterator cbegin() const noexcept {
+            return m_begin;
+        }
+
+        dyn_array_always_inline iterator end() const noexcept {
+            return m_begin + m_size;
+        }
+
+        dyn_array_always_inline const_iterator cend() const noexcept {
+            return m_begin + m_size;
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_size;
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_size == 0;
+        }
+    };
+
     template <
         typename T,
         typename alloc_t = std::allocator<T>,
@@ -51,9 +348,12 @@ namespace cz {
         using const_pointer = T const*;
         using iterator = T*;
         using const_iterator = T const*;
+        using view_type = dyn_array_view<T, SizeT>;
+        using const_view_type = dyn_array_view<T const, SizeT>;
 
         static constexpr size_type default_initial_cap = 8;
         static constexpr size_type default_multiplier = 2;
+        static constexpr size_type npos = static_cast<size_type>(-1);
 
     private:
 
@@ -62,6 +362,8 @@ namespace cz {
         size_type m_size = 0;
         size_type m_cap = 0;
 
+        static constexpr bool _bitwise = detail::is_bitwise_storage<T, alloc_t>::value;
+
         void _set_cap_and_alloc(size_type minimal_cap) {
             if (m_cap == 0) {
                 m_cap = initial_cap;
@@ -91,9 +393,13 @@ namespace cz {
         void _fill_with_val(const_reference value = {}) {
             assert(m_begin != nullptr && "dyn_array internal error");
 
-            const const_iterator _end = end();
-            for (iterator it = m_begin; it != _end; ++it) {
-                m_allocator.construct(it, value);
+            if constexpr (_bitwise && detail::simd::is_element<T>::value) {
+                detail::simd::fill(m_begin, static_cast<std::size_t>(m_size), value);
+            } else {
+                const const_iterator _end = end();
+                for (iterator it = m_begin; it != _end; ++it) {
+                    m_allocator.construct(it, value);
+                }
             }
         }
 
@@ -101,9 +407,15 @@ namespace cz {
         void _fill_from_range_unchecked(InIterator f) {
             assert(m_begin != nullptr && "dyn_array internal error");
 
-            const const_iterator _end = end();
-            for (iterator it = m_begin; it != _end; ++it) {
-                m_allocator.construct(it, *f++);
+            if constexpr (_bitwise && (std::is_same<InIterator, pointer>::value || std::is_same<InIterator, const_pointer>::value)) {
+                if (m_size != 0) {
+                    std::memcpy(m_begin, f, sizeof(T) * m_size);
+                }
+            } else {
+                const const_iterator _end = end();
+                for (iterator it = m_begin; it != _end; ++it) {
+                    m_allocator.construct(it, *f++);
+                }
             }
         }
 
@@ -118,6 +430,37 @@ namespace cz {
             }
         }
 
+        // destroys [n, size()) in one sweep, a no-op for trivially destructible T
+        void _truncate(size_type n) {
+            if constexpr (!std::is_trivially_destructible<T>::value) {
+                for (size_type i = n; i < m_size; ++i) {
+                    m_allocator.destroy(m_begin + i);
+                }
+            }
+            m_size = n;
+        }
+
+        // one pass: survivors are moved down over the gaps, then the surplus tail is destroyed at once
+        template <typename Same>
+        size_type _dedup(Same same, bool shrink) {
+            size_type w = m_size < 2 ? m_size : 1;
+            for (size_type r = 1; r < m_size; ++r) {
+                if (!same(m_begin[w - 1], m_begin[r])) {
+                    if (w != r) {
+                        m_begin[w] = std::move(m_begin[r]);
+                    }
+                    ++w;
+                }
+            }
+
+            const size_type removed = m_size - w;
+            _truncate(w);
+            if (shrink) {
+                shrink_to_fit();
+            }
+            return removed;
+        }
+
         void _dealloc() {
             if (m_begin == nullptr) {
                 return;
@@ -130,8 +473,15 @@ namespace cz {
             const auto old_p = m_begin;
             m_begin = m_allocator.allocate(size);
 
-            for (size_type i = 0; i < m_size; ++i) {
-                m_allocator.construct(m_begin + i, std::move(old_p[i]));
+            if constexpr (_bitwise) {
+                if (m_size != 0) {
+                    std::memcpy(m_begin, old_p, sizeof(T) * m_size);
+                }
+            } else {
+                for (size_type i = 0; i < m_size; ++i) {
+                    m_allocator.construct(m_begin + i, std::move(old_p[i]));
+                    m_allocator.destroy(old_p + i);
+                }
             }
 
             if (old_p) {
@@ -141,6 +491,59 @@ namespace cz {
             m_cap = size;
         }
 
+        std::size_t _index_of(const_reference value) const {
+            if constexpr (detail::simd::is_element<T>::value) {
+                return detail::simd::find(m_begin, static_cast<std::size_t>(m_size), value);
+            } else {
+                return static_cast<std::size_t>(std::find(begin(), end(), value) - begin());
+            }
+        }
+
+        std::size_t _last_index_of(const_reference value) const {
+            if constexpr (detail::simd::is_element<T>::value) {
+                return detail::simd::find_last(m_begin, static_cast<std::size_t>(m_size), value);
+            } else {
+                for (size_type i = m_size; i-- > 0;) {
+                    if (m_begin[i] == value) {
+                        return i;
+                    }
+                }
+                return static_cast<std::size_t>(-1);
+            }
+        }
+
+        std::size_t _index_of_any(const_pointer set, std::size_t set_size) const {
+            if constexpr (detail::simd::is_element<T>::value) {
+                return detail::simd::find_first_of(m_begin, static_cast<std::size_t>(m_size), set, set_size);
+            } else {
+                return static_cast<std::size_t>(std::find_first_of(begin(), end(), set, set + set_size) - begin());
+            }
+        }
+
+        std::size_t _index_of_bytes(const_view_type pattern) const {
+            return detail::simd::find_bytes(
+                reinterpret_cast<std::uint8_t const*>(m_begin), static_cast<std::size_t>(m_size),
+                reinterpret_cast<std::uint8_t const*>(pattern.data()), static_cast<std::size_t>(pattern.size()));
+        }
+
+        std::size_t _index_of_any_byte(const_view_type bytes) const {
+            if (bytes.size() <= 16) {
+                return _index_of_any(bytes.data(), bytes.size());
+            }
+
+            bool in_set[256] = {};
+            for (auto b : bytes) {
+                in_set[static_cast<unsigned char>(b)] = true;
+            }
+
+            for (size_type i = 0; i < m_size; ++i) {
+                if (in_set[static_cast<unsigned char>(m_begin[i])]) {
+                    return i;
+                }
+            }
+            return m_size;
+        }
+
         template <template <typename> typename cmp_type, typename other_value_type>
         dyn_array_always_inline bool _lex_cmp(dyn_array<other_value_type> const& other) const {
             return std::lexicographical_compare(begin(), end(), other.begin(), other.end(), cmp_type<typename std::common_type<value_type, other_value_type>::type>{});
@@ -271,6 +674,10 @@ namespace cz {
                 return false;
             }
 
+            if constexpr (std::is_same<other_value_type, value_type>::value && _bitwise && std::has_unique_object_representations<T>::value) {
+                return m_size == 0 || std::memcmp(m_begin, other.m_begin, sizeof(T) * m_size) == 0;
+            }
+
             auto p = other.begin();
             for (auto const& e : *this) {
                 if (e != *p++) {
@@ -333,12 +740,34 @@ namespace cz {
             }
         }
 
+        // reserves n slots and lets op(data(), n) write them in place; op returns the new size, at most n.
+        // Slots past the old size start uninitialized, hence the trivially copyable requirement
+        template <typename Op>
+        void resize_and_overwrite(size_type n, Op op) {
+            static_assert(std::is_trivially_copyable<T>::value);
+            reserve(n);
+            const size_type k = static_cast<size_type>(op(m_begin, n));
+            assert(k <= n);
+            m_size = k;
+        }
+
+        // gives up ownership of the storage; the caller must destroy the size() elements and
+        // deallocate cap() slots through get_allocator(), so read those before calling
+        dyn_array_always_inline pointer release() noexcept {
+            const pointer p = m_begin;
+            m_begin = nullptr;
+            m_size = 0;
+            m_cap = 0;
+            return p;
+        }
+
         void push_back(T const& arg) {
             if (m_size == m_cap) {
                 _set_cap_and_realloc(m_size + 1);
             }
 
-            m_allocator.construct(m_begin + m_size++, arg);
+            m_allocator.construct(m_begin + m_size, arg);
+            ++m_size; // only once constructed, so a throwing constructor leaves the size alone
         }
 
         void push_back(T&& arg) {
@@ -346,7 +775,8 @@ namespace cz {
                 _set_cap_and_realloc(m_size + 1);
             }
 
-            m_allocator.construct(m_begin + m_size++, std::move(arg));
+            m_allocator.construct(m_begin + m_size, std::move(arg));
+            ++m_size; // only once constructed, so a throwing constructor leaves the size alone
         }
 
         template <typename... Types>
@@ -355,19 +785,39 @@ namespace cz {
                 _set_cap_and_realloc(m_size + 1);
             }
 
-            m_allocator.construct(m_begin + m_size++, std::forward<Types>(args)...);
+            m_allocator.construct(m_begin + m_size, std::forward<Types>(args)...);
+            ++m_size; // only once constructed, so a throwing constructor leaves the size alone
         }
 
         dyn_array_always_inline value_type pop_back() {
             assert(m_size > 0);
-            return std::move(m_begin[--m_size]);
+            value_type last = std::move(m_begin[m_size - 1]);
+            m_allocator.destroy(m_begin + --m_size);
+            return last;
         }
 
         void remove_at(size_type idx) {
             assert(idx < m_size);
-            for (auto _end = --m_size; idx < _end; ++idx) {
+            for (auto _end = m_size - 1; idx < _end; ++idx) {
                 m_begin[idx] = std::move(m_begin[idx + 1]);
             }
+            m_allocator.destroy(m_begin + --m_size);
+        }
+
+        // removes consecutive equal elements, keeping the first of each run; returns how many went
+        size_type unique(bool shrink = false) {
+            return _dedup([](const_reference a, const_reference b) { return a == b; }, shrink);
+        }
+
+        size_type sort_unique(bool shrink = false) {
+            std::sort(begin(), end());
+            return unique(shrink);
+        }
+
+        // removes consecutive elements whose key(element) compares equal, keeping the first of each run
+        template <typename KeyFn>
+        size_type dedup_by_key(KeyFn key, bool shrink = false) {
+            return _dedup([&key](const_reference a, const_reference b) { return key(a) == key(b); }, shrink);
         }
 
         void resize(size_type n) {
@@ -386,6 +836,316 @@ namespace cz {
             m_size = n;
         }
 
+        void fill(const_reference value) {
+            if constexpr (_bitwise && detail::simd::is_element<T>::value) {
+                detail::simd::fill(m_begin, static_cast<std::size_t>(m_size), value);
+            } else {
+                std::fill(begin(), end(), value);
+            }
+        }
+
+        value_type sum() const {
+            if constexpr (detail::simd::is_integral_element<T>::value) {
+                return detail::simd::sum(m_begin, static_cast<std::size_t>(m_size));
+            } else {
+                return std::accumulate(begin(), end(), value_type{});
+            }
+        }
+
+        // element k of the result is (*this)[indices[k]]; indices is any contiguous container of integers
+        template <typename Indices>
+        dyn_array gather(Indices const& indices) const {
+            using index_type = typename std::decay<decltype(*indices.data())>::type;
+            static_assert(std::is_integral<index_type>::value);
+
+            const auto idx = indices.data();
+            const std::size_t n = static_cast<std::size_t>(indices.size());
+            const bool prefetch = sizeof(T) * static_cast<std::size_t>(m_size) >= detail::simd::prefetch_min_bytes;
+
+            dyn_array out(m_allocator);
+            if (n == 0) {
+                return out;
+            }
+            out._realloc(static_cast<size_type>(n));
+
+            if constexpr (_bitwise && (sizeof(T) == 4 || sizeof(T) == 8) && sizeof(index_type) == 4) {
+                if (static_cast<std::size_t>(m_size) <= 0x7fffffff) { // hardware gathers take signed 32-bit indices
+                    assert(std::all_of(idx, idx + n, [this](index_type i) { return static_cast<std::size_t>(i) < static_cast<std::size_t>(m_size); }));
+                    detail::simd::gather<sizeof(T)>(m_begin, reinterpret_cast<std::uint32_t const*>(idx), n, out.m_begin, prefetch);
+                    out.m_size = static_cast<size_type>(n);
+                    return out;
+                }
+            }
+
+            for (std::size_t k = 0; k < n; ++k) {
+                if (prefetch && k + detail::simd::prefetch_distance < n) {
+                    DYN_ARRAY_PREFETCH(m_begin + idx[k + detail::simd::prefetch_distance]);
+                }
+                assert(static_cast<std::size_t>(idx[k]) < static_cast<std::size_t>(m_size));
+                out.m_allocator.construct(out.m_begin + k, m_begin[idx[k]]);
+                ++out.m_size;
+            }
+            return out;
+        }
+
+        // (*this)[indices[k]] = values[k]; with repeated indices the last write wins
+        template <typename Indices, typename Values>
+        void scatter(Indices const& indices, Values const& values) {
+            using index_type = typename std::decay<decltype(*indices.data())>::type;
+            static_assert(std::is_integral<index_type>::value);
+            assert(indices.size() == values.size());
+
+            const auto idx = indices.data();
+            const auto src = values.data();
+            const std::size_t n = static_cast<std::size_t>(indices.size());
+            const bool prefetch = sizeof(T) * static_cast<std::size_t>(m_size) >= detail::simd::prefetch_min_bytes;
+
+            for (std::size_t k = 0; k < n; ++k) {
+                if (prefetch && k + detail::simd::prefetch_distance < n) {
+                    DYN_ARRAY_PREFETCH_W(m_begin + idx[k + detail::simd::prefetch_distance]);
+                }
+                assert(static_cast<std::size_t>(idx[k]) < static_cast<std::size_t>(m_size));
+                m_begin[idx[k]] = src[k];
+            }
+        }
+
+        // reorders so that the new (*this)[k] is the old (*this)[perm[k]], following each cycle once;
+        // visited positions are marked in the top bit of perm, which is restored before returning
+        template <typename Indices>
+        void apply_permutation_in_place(Indices& perm) {
+            using index_type = typename std::decay<decltype(*perm.data())>::type;
+            using U = typename std::make_unsigned<index_type>::type;
+            static_assert(std::is_integral<index_type>::value);
+            assert(static_cast<std::size_t>(perm.size()) == static_cast<std::size_t>(m_size));
+
+            constexpr U seen = static_cast<U>(U{1} << (sizeof(U) * 8 - 1));
+            assert(static_cast<std::size_t>(m_size) <= static_cast<std::size_t>(seen));
+
+            const auto p = perm.data();
+            const std::size_t n = static_cast<std::size_t>(m_size);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                if ((static_cast<U>(p[i]) & seen) != 0) {
+                    continue;
+                }
+
+                value_type tmp = std::move(m_begin[i]);
+                std::size_t j = i;
+                for (;;) {
+                    const std::size_t k = static_cast<std::size_t>(p[j]);
+                    assert(k < n);
+                    p[j] = static_cast<index_type>(static_cast<U>(p[j]) | seen);
+                    if (k == i) {
+                        m_begin[j] = std::move(tmp);
+                        break;
+                    }
+                    m_begin[j] = std::move(m_begin[k]);
+                    j = k;
+                }
+            }
+
+            for (std::size_t i = 0; i < n; ++i) {
+                p[i] = static_cast<index_type>(static_cast<U>(p[i]) & ~seen);
+            }
+        }
+
+        // indexes that order the array ascending, equal elements kept in index order; arithmetic
+        // elements are radix sorted, with NaNs placed by sign past the infinities
+        dyn_array<size_type> argsort() const {
+            dyn_array<size_type> idx(static_cast<std::size_t>(m_size));
+            if constexpr (detail::simd::is_element<T>::value) {
+                if (m_size >= 64) {
+                    detail::sort::radix_argsort(m_begin, static_cast<std::size_t>(m_size), idx.data());
+                } else {
+                    std::iota(idx.begin(), idx.end(), size_type{0});
+                    std::stable_sort(idx.begin(), idx.end(), [this](size_type a, size_type b) {
+                        return detail::sort::radix_key(m_begin[a]) < detail::sort::radix_key(m_begin[b]);
+                    });
+                }
+            } else {
+                std::iota(idx.begin(), idx.end(), size_type{0});
+                std::stable_sort(idx.begin(), idx.end(), [this](size_type a, size_type b) {
+                    return m_begin[a] < m_begin[b];
+                });
+            }
+            return idx;
+        }
+
+        // indexes of the k largest elements, largest first, ties going to the lower index; NaNs are skipped.
+        // Past the first k candidates only elements beating the current k-th best are visited, so the
+        // scan is one vectorized pass with a k-entry heap update per hit
+        dyn_array<size_type> top_k(size_type k) const {
+            using entry = std::pair<value_type, size_type>;
+            const auto better = [](entry const& a, entry const& b) {
+                return b.first < a.first || (!(a.first < b.first) && a.second < b.second);
+            };
+
+            dyn_array<entry> heap;
+            heap.reserve(k);
+
+            size_type i = 0;
+            for (; i < m_size && heap.size() < k; ++i) {
+                if constexpr (std::is_floating_point<T>::value) {
+                    if (m_begin[i] != m_begin[i]) {
+                        continue;
+                    }
+                }
+                heap.emplace_back(m_begin[i], i);
+            }
+            std::make_heap(heap.begin(), heap.end(), better); // front is the worst kept entry
+
+            const auto replace = [&](size_type j) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = entry(m_begin[j], j);
+                std::push_heap(heap.begin(), heap.end(), better);
+            };
+
+            if (k != 0 && heap.size() == k) {
+                if constexpr (detail::simd::is_element<T>::value) {
+                    while (i < m_size) {
+                        const std::size_t j = i + detail::simd::find_greater(m_begin + i, static_cast<std::size_t>(m_size - i), heap.front().first);
+                        if (j == m_size) {
+                            break;
+                        }
+                        replace(static_cast<size_type>(j));
+                        i = static_cast<size_type>(j + 1);
+                    }
+                } else {
+                    for (; i < m_size; ++i) {
+                        if (heap.front().first < m_begin[i]) {
+                            replace(i);
+                        }
+                    }
+                }
+            }
+
+            std::sort_heap(heap.begin(), heap.end(), better);
+            dyn_array<size_type> idx;
+            idx.reserve(heap.size());
+            for (auto const& e : heap) {
+                idx.push_back(e.second);
+            }
+            return idx;
+        }
+
+        // places the element that sorting would put at position n there, with nothing greater before
+        // it and nothing smaller after; introselect, so linear on average and O(n log n) at worst
+        template <typename Compare = std::less<T>>
+        void nth_element(size_type n, Compare cmp = {}) {
+            assert(n < m_size);
+            detail::sort::introselect(begin(), begin() + n, end(), cmp);
+        }
+
+        // the k smallest elements sorted at the front, the rest in unspecified order
+        template <typename Compare = std::less<T>>
+        void partial_sort(size_type k, Compare cmp = {}) {
+            assert(k <= m_size);
+            if (k == 0) {
+                return;
+            }
+            if (k < m_size) {
+                nth_element(k - 1, cmp);
+            }
+            std::sort(begin(), begin() + k, cmp);
+        }
+
+        dyn_array_always_inline iterator find(const_reference value) {
+            return m_begin + _index_of(value);
+        }
+
+        dyn_array_always_inline const_iterator find(const_reference value) const {
+            return m_begin + _index_of(value);
+        }
+
+        iterator rfind(const_reference value) { // end() if not found
+            const std::size_t idx = _last_index_of(value);
+            return idx == static_cast<std::size_t>(-1) ? end() : m_begin + idx;
+        }
+
+        const_iterator rfind(const_reference value) const {
+            const std::size_t idx = _last_index_of(value);
+            return idx == static_cast<std::size_t>(-1) ? end() : m_begin + idx;
+        }
+
+        dyn_array_always_inline size_type index_of(const_reference value) const { // npos if not found
+            const std::size_t idx = _index_of(value);
+            return idx == m_size ? npos : static_cast<size_type>(idx);
+        }
+
+        dyn_array_always_inline bool contains(const_reference value) const {
+            return _index_of(value) != m_size;
+        }
+
+        size_type count(const_reference value) const {
+            if constexpr (detail::simd::is_element<T>::value) {
+                return static_cast<size_type>(detail::simd::count(m_begin, static_cast<std::size_t>(m_size), value));
+            } else {
+                return static_cast<size_type>(std::count(begin(), end(), value));
+            }
+        }
+
+        dyn_array_always_inline iterator find_first_of(dyn_array const& set) {
+            return m_begin + _index_of_any(set.m_begin, set.m_size);
+        }
+
+        dyn_array_always_inline const_iterator find_first_of(dyn_array const& set) const {
+            return m_begin + _index_of_any(set.m_begin, set.m_size);
+        }
+
+        dyn_array_always_inline iterator find_first_of(std::initializer_list<value_type> set) {
+            return m_begin + _index_of_any(set.begin(), set.size());
+        }
+
+        dyn_array_always_inline const_iterator find_first_of(std::initializer_list<value_type> set) const {
+            return m_begin + _index_of_any(set.begin(), set.size());
+        }
+
+        template <typename U = T, typename = typename std::enable_if<detail::is_byte<U>::value>::type>
+        iterator find(const_view_type pattern) {
+            return m_begin + _index_of_bytes(pattern);
+        }
+
+        template <typename U = T, typename = typename std::enable_if<detail::is_byte<U>::value>::type>
+        const_iterator find(const_view_type pattern) const {
+            return m_begin + _index_of_bytes(pattern);
+        }
+
+        template <typename U = T, typename = typename std::enable_if<detail::is_byte<U>::value>::type>
+        iterator find_any_of(const_view_type bytes) {
+            return m_begin + _index_of_any_byte(bytes);
+        }
+
+        template <typename U = T, typename = typename std::enable_if<detail::is_byte<U>::value>::type>
+        const_iterator find_any_of(const_view_type bytes) const {
+            return m_begin + _index_of_any_byte(bytes);
+        }
+
+        // fields between delimiters, empty ones included; the views alias this array
+        template <typename U = T, typename = typename std::enable_if<detail::is_byte<U>::value>::type>
+        dyn_array<const_view_type> split_on(value_type delim) const {
+            dyn_array<const_view_type> fields;
+
+            std::size_t f = 0;
+            for (;;) {
+                const std::size_t l = f + detail::simd::find(m_begin + f, static_cast<std::size_t>(m_size) - f, delim);
+                fields.emplace_back(m_begin + f, static_cast<size_type>(l - f));
+                if (l == m_size) {
+                    break;
+                }
+                f = l + 1;
+            }
+
+            return fields;
+        }
+
+        dyn_array_always_inline view_type view() noexcept {
+            return view_type(m_begin, m_size);
+        }
+
+        dyn_array_always_inline const_view_type view() const noexcept {
+            return const_view_type(m_begin, m_size);
+        }
+
         void clear() {
             _destroy_all();
             m_size = 0;
@@ -497,6 +1257,33 @@ namespace cz {
             return m_size == 0;
         }
     };
+
+    // bitwise-hashable element types are hashed straight from memory, others by composing std::hash
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    std::uint64_t hash(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& arr, std::uint64_t seed = 0) {
+        return detail::hashing::range(arr.data(), static_cast<std::size_t>(arr.size()), seed);
+    }
+
+    template <typename T, typename SizeT>
+    std::uint64_t hash(dyn_array_view<T, SizeT> const& view, std::uint64_t seed = 0) {
+        return detail::hashing::range<typename std::remove_cv<T>::type>(view.data(), static_cast<std::size_t>(view.size()), seed);
+    }
+}
+
+namespace std {
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    struct hash<cz::dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>> {
+        size_t operator()(cz::dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& arr) const {
+            return static_cast<size_t>(cz::hash(arr));
+        }
+    };
+
+    template <typename T, typename SizeT>
+    struct hash<cz::dyn_array_view<T, SizeT>> {
+        size_t operator()(cz::dyn_array_view<T, SizeT> const& view) const noexcept {
+            return static_cast<size_t>(cz::hash(view));
+        }
+    };
 }
 
 #endif
@@ -0,0 +1,42 @@
+#ifndef DYN_ARRAY_PARALLEL_HPP
+#define DYN_ARRAY_PARALLEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace cz {
+    namespace detail {
+        namespace parallel {
+            // runs f(chunk, first, last) over [0, n) split into at most `threads` contiguous chunks
+            template <typename F>
+            void for_each_chunk(std::size_t n, unsigned threads, F f) {
+                constexpr std::size_t min_chunk = 1 << 14;
+                std::size_t chunks = threads == 0 ? 1 : threads;
+                if (chunks > 1 && n / chunks < min_chunk) {
+                    chunks = n / min_chunk > 1 ? n / min_chunk : 1;
+                }
+
+                if (chunks == 1) {
+                    f(std::size_t{0}, std::size_t{0}, n);
+                    return;
+                }
+
+                // dyn_array needs copyable elements, so the workers live in a plain array; chunk 0 runs on the caller
+                const std::size_t step = (n + chunks - 1) / chunks;
+                std::unique_ptr<std::thread[]> workers(new std::thread[chunks - 1]);
+                for (std::size_t c = 1; c < chunks; ++c) {
+                    const std::size_t first = c * step < n ? c * step : n;
+                    const std::size_t last = first + step < n ? first + step : n;
+                    workers[c - 1] = std::thread([&f, c, first, last] { f(c, first, last); });
+                }
+                f(std::size_t{0}, std::size_t{0}, step < n ? step : n);
+                for (std::size_t c = 1; c < chunks; ++c) {
+                    workers[c - 1].join();
+                }
+            }
+        }
+    }
+}
+
+#endif
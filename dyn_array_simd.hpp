@@ -0,0 +1,792 @@
+#ifndef DYN_ARRAY_SIMD_HPP
+#define DYN_ARRAY_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if !defined(DYN_ARRAY_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#   define DYN_ARRAY_SIMD_X86 1
+#   include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define DYN_ARRAY_PREFETCH(p) __builtin_prefetch(p, 0, 3)
+#   define DYN_ARRAY_PREFETCH_W(p) __builtin_prefetch(p, 1, 3)
+#else
+#   define DYN_ARRAY_PREFETCH(p) ((void)0)
+#   define DYN_ARRAY_PREFETCH_W(p) ((void)0)
+#endif
+
+#define DYN_ARRAY_SIMD_STR_(x) #x
+#define DYN_ARRAY_SIMD_STR(x) DYN_ARRAY_SIMD_STR_(x)
+
+#if defined(__clang__)
+#   define DYN_ARRAY_SIMD_TARGET_BEGIN(isa) _Pragma(DYN_ARRAY_SIMD_STR(clang attribute push(__attribute__((target(isa))), apply_to = function)))
+#   define DYN_ARRAY_SIMD_TARGET_END _Pragma("clang attribute pop")
+#else
+#   define DYN_ARRAY_SIMD_TARGET_BEGIN(isa) _Pragma("GCC push_options") _Pragma(DYN_ARRAY_SIMD_STR(GCC target(isa)))
+#   define DYN_ARRAY_SIMD_TARGET_END _Pragma("GCC pop_options")
+#endif
+
+namespace cz {
+
+    enum class simd_level : int {
+        scalar = 0,
+        sse42,
+        avx2,
+        avx512
+    };
+
+    namespace detail {
+        namespace simd {
+            // element types the kernels can broadcast and compare
+            template <typename T>
+            struct is_element : std::integral_constant<bool,
+                std::is_arithmetic<T>::value &&
+                !std::is_same<T, bool>::value &&
+                (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+            > {
+            };
+
+            template <typename T>
+            struct is_integral_element : std::integral_constant<bool,
+                is_element<T>::value && std::is_integral<T>::value
+            > {
+            };
+
+            // random-access kernels prefetch this many elements ahead, and only once the
+            // source outgrows the private caches; below that the prefetches are pure overhead
+            constexpr std::size_t prefetch_distance = 16;
+            constexpr std::size_t prefetch_min_bytes = std::size_t{1} << 20;
+
+            inline simd_level detect_level() noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+                    return simd_level::avx512;
+                }
+                if (__builtin_cpu_supports("avx2")) {
+                    return simd_level::avx2;
+                }
+                if (__builtin_cpu_supports("sse4.2")) {
+                    return simd_level::sse42;
+                }
+#endif
+                return simd_level::scalar;
+            }
+
+            inline simd_level& current_level() noexcept {
+                static simd_level level = detect_level();
+                return level;
+            }
+
+            inline simd_level active_level() noexcept {
+                return current_level();
+            }
+
+            namespace scalar {
+                template <typename T>
+                std::size_t find(T const* p, std::size_t n, T value) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (p[i] == value) {
+                            return i;
+                        }
+                    }
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t find_last(T const* p, std::size_t n, T value) noexcept {
+                    while (n-- > 0) {
+                        if (p[n] == value) {
+                            return n;
+                        }
+                    }
+                    return static_cast<std::size_t>(-1);
+                }
+
+                template <typename T>
+                std::size_t find_first_of(T const* p, std::size_t n, T const* set, std::size_t m) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        for (std::size_t j = 0; j < m; ++j) {
+                            if (p[i] == set[j]) {
+                                return i;
+                            }
+                        }
+                    }
+                    return n;
+                }
+
+                inline std::size_t find_bytes(std::uint8_t const* p, std::size_t n, std::uint8_t const* needle, std::size_t k) noexcept {
+                    if (k == 0) {
+                        return 0;
+                    }
+
+                    for (std::size_t i = 0; i + k <= n; ++i) {
+                        if (p[i] == needle[0] && std::memcmp(p + i, needle, k) == 0) {
+                            return i;
+                        }
+                    }
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t find_greater(T const* p, std::size_t n, T value) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (value < p[i]) {
+                            return i;
+                        }
+                    }
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t count(T const* p, std::size_t n, T value) noexcept {
+                    std::size_t c = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        c += p[i] == value;
+                    }
+                    return c;
+                }
+
+                template <typename T>
+                void fill(T* p, std::size_t n, T value) noexcept {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        p[i] = value;
+                    }
+                }
+
+                // src is rows x cols row-major, dst becomes cols x rows; walked in cache-sized blocks
+                inline void transpose32(void const* src, void* dst, std::size_t rows, std::size_t cols) noexcept {
+                    constexpr std::size_t block = 32;
+                    auto s = static_cast<unsigned char const*>(src);
+                    auto d = static_cast<unsigned char*>(dst);
+
+                    for (std::size_t ib = 0; ib < rows; ib += block) {
+                        const std::size_t ie = ib + block < rows ? ib + block : rows;
+                        for (std::size_t jb = 0; jb < cols; jb += block) {
+                            const std::size_t je = jb + block < cols ? jb + block : cols;
+                            for (std::size_t i = ib; i < ie; ++i) {
+                                for (std::size_t j = jb; j < je; ++j) {
+                                    std::memcpy(d + 4 * (j * rows + i), s + 4 * (i * cols + j), 4);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                template <std::size_t Size>
+                void gather(void const* src, std::uint32_t const* idx, std::size_t n, void* dst, bool prefetch) noexcept {
+                    auto s = static_cast<unsigned char const*>(src);
+                    auto d = static_cast<unsigned char*>(dst);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (prefetch && i + prefetch_distance < n) {
+                            DYN_ARRAY_PREFETCH(s + Size * idx[i + prefetch_distance]);
+                        }
+                        std::memcpy(d + Size * i, s + Size * idx[i], Size);
+                    }
+                }
+
+                template <typename T>
+                T sum(T const* p, std::size_t n) noexcept {
+                    using U = typename std::make_unsigned<T>::type; // wraps instead of overflowing
+                    U acc = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        acc += static_cast<U>(p[i]);
+                    }
+                    return static_cast<T>(acc);
+                }
+
+                // a and b sorted without duplicates; the merge advances by comparison results instead of branching
+                template <typename T>
+                std::size_t intersect(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) noexcept {
+                    std::size_t i = 0, j = 0, k = 0;
+                    while (i < na && j < nb) {
+                        const T x = a[i], y = b[j];
+                        out[k] = x;
+                        k += x == y;
+                        i += !(y < x);
+                        j += !(x < y);
+                    }
+                    return k;
+                }
+
+                template <typename T>
+                std::size_t btree_rank(T const* p, std::size_t n, T x) noexcept {
+                    std::size_t r = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        r += p[i] < x;
+                    }
+                    return r;
+                }
+
+                template <typename T>
+                void btree_lower_bound(T const* index, std::size_t const* levels, std::size_t height, T const* keys, std::size_t n,
+                                       T const* xs, std::size_t m, std::size_t* out) noexcept {
+                    constexpr std::size_t B = 64 / sizeof(T);
+                    for (std::size_t q = 0; q < m; ++q) {
+                        const T x = xs[q];
+                        std::size_t k = 0;
+                        for (std::size_t h = height - 1; h > 0; --h) {
+                            k = k * (B + 1) + btree_rank(index + levels[h] + k, B, x) * B;
+                        }
+                        out[q] = k + btree_rank(keys + k, n - k < B ? n - k : B, x);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#ifdef DYN_ARRAY_SIMD_X86
+
+DYN_ARRAY_SIMD_TARGET_BEGIN("sse4.2")
+namespace cz {
+    namespace detail {
+        namespace simd {
+            namespace sse42 {
+                struct ops {
+                    using vec = __m128i;
+                    using mask = std::uint64_t;
+                    static constexpr std::size_t width = 16;
+
+                    template <typename T>
+                    static constexpr unsigned stride() noexcept { // mask bits per element
+                        return sizeof(T);
+                    }
+
+                    static inline vec load(void const* p) noexcept {
+                        return _mm_loadu_si128(static_cast<vec const*>(p));
+                    }
+
+                    static inline void store(void* p, vec v) noexcept {
+                        _mm_storeu_si128(static_cast<vec*>(p), v);
+                    }
+
+                    template <typename T>
+                    static inline vec broadcast(T value) noexcept {
+                        vec v;
+                        if constexpr (sizeof(T) == 1) {
+                            std::uint8_t b;
+                            std::memcpy(&b, &value, 1);
+                            v = _mm_set1_epi8(static_cast<char>(b));
+                        } else if constexpr (sizeof(T) == 2) {
+                            std::uint16_t b;
+                            std::memcpy(&b, &value, 2);
+                            v = _mm_set1_epi16(static_cast<short>(b));
+                        } else if constexpr (sizeof(T) == 4) {
+                            std::uint32_t b;
+                            std::memcpy(&b, &value, 4);
+                            v = _mm_set1_epi32(static_cast<int>(b));
+                        } else {
+                            std::uint64_t b;
+                            std::memcpy(&b, &value, 8);
+                            v = _mm_set1_epi64x(static_cast<long long>(b));
+                        }
+                        return v;
+                    }
+
+                    template <typename T>
+                    static inline mask eq_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))));
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)))));
+                        } else if constexpr (sizeof(T) == 1) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+                        } else if constexpr (sizeof(T) == 2) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(a, b)));
+                        } else if constexpr (sizeof(T) == 4) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(a, b)));
+                        } else {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi64(a, b)));
+                        }
+                    }
+
+                    // a > b per element; unsigned lanes are biased by the sign bit so the signed compare applies
+                    template <typename T>
+                    static inline mask gt_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castps_si128(_mm_cmpgt_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))));
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castpd_si128(_mm_cmpgt_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)))));
+                        } else {
+                            if constexpr (std::is_unsigned<T>::value) {
+                                const vec bias = broadcast(static_cast<T>(T{1} << (sizeof(T) * 8 - 1)));
+                                a = _mm_xor_si128(a, bias);
+                                b = _mm_xor_si128(b, bias);
+                            }
+                            if constexpr (sizeof(T) == 1) {
+                                return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(a, b)));
+                            } else if constexpr (sizeof(T) == 2) {
+                                return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi16(a, b)));
+                            } else if constexpr (sizeof(T) == 4) {
+                                return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi32(a, b)));
+                            } else {
+                                return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi64(a, b)));
+                            }
+                        }
+                    }
+
+                    template <typename T>
+                    static inline vec add(vec a, vec b) noexcept {
+                        if constexpr (sizeof(T) == 1) {
+                            return _mm_add_epi8(a, b);
+                        } else if constexpr (sizeof(T) == 2) {
+                            return _mm_add_epi16(a, b);
+                        } else if constexpr (sizeof(T) == 4) {
+                            return _mm_add_epi32(a, b);
+                        } else {
+                            return _mm_add_epi64(a, b);
+                        }
+                    }
+
+                    // 4x4 block of 32-bit elements
+                    static constexpr std::size_t tile32 = 4;
+
+                    static inline void transpose_tile32(void const* src, std::size_t src_stride, void* dst, std::size_t dst_stride) noexcept {
+                        auto s = static_cast<float const*>(src);
+                        auto d = static_cast<float*>(dst);
+                        __m128 r0 = _mm_loadu_ps(s), r1 = _mm_loadu_ps(s + src_stride);
+                        __m128 r2 = _mm_loadu_ps(s + 2 * src_stride), r3 = _mm_loadu_ps(s + 3 * src_stride);
+                        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                        _mm_storeu_ps(d, r0);
+                        _mm_storeu_ps(d + dst_stride, r1);
+                        _mm_storeu_ps(d + 2 * dst_stride, r2);
+                        _mm_storeu_ps(d + 3 * dst_stride, r3);
+                    }
+
+                    static inline vec zero() noexcept {
+                        return _mm_setzero_si128();
+                    }
+
+                    // moves every 32-bit lane down by one, lane 0 wrapping to the top
+                    static inline vec rotate32(vec v) noexcept {
+                        return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 3, 2, 1));
+                    }
+
+                    // no hardware gather before AVX2
+                    template <std::size_t Size>
+                    static inline void gather(void const* base, std::uint32_t const* idx, void* dst) noexcept {
+                        for (std::size_t k = 0; k < width / Size; ++k) {
+                            std::memcpy(static_cast<unsigned char*>(dst) + Size * k, static_cast<unsigned char const*>(base) + Size * idx[k], Size);
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+#define DYN_ARRAY_SIMD_ISA sse42
+#include "dyn_array_simd_kernels.inl"
+#undef DYN_ARRAY_SIMD_ISA
+DYN_ARRAY_SIMD_TARGET_END
+
+DYN_ARRAY_SIMD_TARGET_BEGIN("avx2")
+namespace cz {
+    namespace detail {
+        namespace simd {
+            namespace avx2 {
+                struct ops {
+                    using vec = __m256i;
+                    using mask = std::uint64_t;
+                    static constexpr std::size_t width = 32;
+
+                    template <typename T>
+                    static constexpr unsigned stride() noexcept {
+                        return sizeof(T);
+                    }
+
+                    static inline vec load(void const* p) noexcept {
+                        return _mm256_loadu_si256(static_cast<vec const*>(p));
+                    }
+
+                    static inline void store(void* p, vec v) noexcept {
+                        _mm256_storeu_si256(static_cast<vec*>(p), v);
+                    }
+
+                    template <typename T>
+                    static inline vec broadcast(T value) noexcept {
+                        vec v;
+                        if constexpr (sizeof(T) == 1) {
+                            std::uint8_t b;
+                            std::memcpy(&b, &value, 1);
+                            v = _mm256_set1_epi8(static_cast<char>(b));
+                        } else if constexpr (sizeof(T) == 2) {
+                            std::uint16_t b;
+                            std::memcpy(&b, &value, 2);
+                            v = _mm256_set1_epi16(static_cast<short>(b));
+                        } else if constexpr (sizeof(T) == 4) {
+                            std::uint32_t b;
+                            std::memcpy(&b, &value, 4);
+                            v = _mm256_set1_epi32(static_cast<int>(b));
+                        } else {
+                            std::uint64_t b;
+                            std::memcpy(&b, &value, 8);
+                            v = _mm256_set1_epi64x(static_cast<long long>(b));
+                        }
+                        return v;
+                    }
+
+                    template <typename T>
+                    static inline mask eq_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))));
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ))));
+                        } else if constexpr (sizeof(T) == 1) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+                        } else if constexpr (sizeof(T) == 2) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b)));
+                        } else if constexpr (sizeof(T) == 4) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b)));
+                        } else {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(a, b)));
+                        }
+                    }
+
+                    template <typename T>
+                    static inline mask gt_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_GT_OQ))));
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_GT_OQ))));
+                        } else {
+                            if constexpr (std::is_unsigned<T>::value) {
+                                const vec bias = broadcast(static_cast<T>(T{1} << (sizeof(T) * 8 - 1)));
+                                a = _mm256_xor_si256(a, bias);
+                                b = _mm256_xor_si256(b, bias);
+                            }
+                            if constexpr (sizeof(T) == 1) {
+                                return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(a, b)));
+                            } else if constexpr (sizeof(T) == 2) {
+                                return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi16(a, b)));
+                            } else if constexpr (sizeof(T) == 4) {
+                                return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(a, b)));
+                            } else {
+                                return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi64(a, b)));
+                            }
+                        }
+                    }
+
+                    template <typename T>
+                    static inline vec add(vec a, vec b) noexcept {
+                        if constexpr (sizeof(T) == 1) {
+                            return _mm256_add_epi8(a, b);
+                        } else if constexpr (sizeof(T) == 2) {
+                            return _mm256_add_epi16(a, b);
+                        } else if constexpr (sizeof(T) == 4) {
+                            return _mm256_add_epi32(a, b);
+                        } else {
+                            return _mm256_add_epi64(a, b);
+                        }
+                    }
+
+                    // 8x8 block of 32-bit elements: unpack, shuffle, then swap 128-bit halves
+                    static constexpr std::size_t tile32 = 8;
+
+                    static inline void transpose_tile32(void const* src, std::size_t src_stride, void* dst, std::size_t dst_stride) noexcept {
+                        auto s = static_cast<float const*>(src);
+                        auto d = static_cast<float*>(dst);
+                        __m256 r[8], t[8];
+                        for (std::size_t k = 0; k < 8; ++k) {
+                            r[k] = _mm256_loadu_ps(s + k * src_stride);
+                        }
+                        for (std::size_t k = 0; k < 8; k += 2) {
+                            t[k] = _mm256_unpacklo_ps(r[k], r[k + 1]);
+                            t[k + 1] = _mm256_unpackhi_ps(r[k], r[k + 1]);
+                        }
+                        for (std::size_t k = 0; k < 8; k += 4) {
+                            r[k] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+                            r[k + 1] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+                            r[k + 2] = _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+                            r[k + 3] = _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+                        }
+                        for (std::size_t k = 0; k < 4; ++k) {
+                            _mm256_storeu_ps(d + k * dst_stride, _mm256_permute2f128_ps(r[k], r[k + 4], 0x20));
+                            _mm256_storeu_ps(d + (k + 4) * dst_stride, _mm256_permute2f128_ps(r[k], r[k + 4], 0x31));
+                        }
+                    }
+
+                    static inline vec zero() noexcept {
+                        return _mm256_setzero_si256();
+                    }
+
+                    static inline vec rotate32(vec v) noexcept {
+                        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0));
+                    }
+
+                    // width / Size elements of Size bytes from base[idx[k]]; indices are sign-extended
+                    template <std::size_t Size>
+                    static inline void gather(void const* base, std::uint32_t const* idx, void* dst) noexcept {
+                        if constexpr (Size == 4) {
+                            store(dst, _mm256_i32gather_epi32(static_cast<int const*>(base), load(idx), 4));
+                        } else {
+                            const __m128i i = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx));
+                            store(dst, _mm256_i32gather_epi64(static_cast<long long const*>(base), i, 8));
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+#define DYN_ARRAY_SIMD_ISA avx2
+#include "dyn_array_simd_kernels.inl"
+#undef DYN_ARRAY_SIMD_ISA
+DYN_ARRAY_SIMD_TARGET_END
+
+DYN_ARRAY_SIMD_TARGET_BEGIN("avx512f,avx512bw")
+namespace cz {
+    namespace detail {
+        namespace simd {
+            namespace avx512 {
+                struct ops {
+                    using vec = __m512i;
+                    using mask = std::uint64_t;
+                    static constexpr std::size_t width = 64;
+
+                    template <typename T>
+                    static constexpr unsigned stride() noexcept { // compares yield one mask bit per element
+                        return 1;
+                    }
+
+                    static inline vec load(void const* p) noexcept {
+                        return _mm512_loadu_si512(p);
+                    }
+
+                    static inline void store(void* p, vec v) noexcept {
+                        _mm512_storeu_si512(p, v);
+                    }
+
+                    template <typename T>
+                    static inline vec broadcast(T value) noexcept {
+                        vec v;
+                        if constexpr (sizeof(T) == 1) {
+                            std::uint8_t b;
+                            std::memcpy(&b, &value, 1);
+                            v = _mm512_set1_epi8(static_cast<char>(b));
+                        } else if constexpr (sizeof(T) == 2) {
+                            std::uint16_t b;
+                            std::memcpy(&b, &value, 2);
+                            v = _mm512_set1_epi16(static_cast<short>(b));
+                        } else if constexpr (sizeof(T) == 4) {
+                            std::uint32_t b;
+                            std::memcpy(&b, &value, 4);
+                            v = _mm512_set1_epi32(static_cast<int>(b));
+                        } else {
+                            std::uint64_t b;
+                            std::memcpy(&b, &value, 8);
+                            v = _mm512_set1_epi64(static_cast<long long>(b));
+                        }
+                        return v;
+                    }
+
+                    template <typename T>
+                    static inline mask eq_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_EQ_OQ);
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_EQ_OQ);
+                        } else if constexpr (sizeof(T) == 1) {
+                            return _mm512_cmpeq_epi8_mask(a, b);
+                        } else if constexpr (sizeof(T) == 2) {
+                            return _mm512_cmpeq_epi16_mask(a, b);
+                        } else if constexpr (sizeof(T) == 4) {
+                            return _mm512_cmpeq_epi32_mask(a, b);
+                        } else {
+                            return _mm512_cmpeq_epi64_mask(a, b);
+                        }
+                    }
+
+                    template <typename T>
+                    static inline mask gt_mask(vec a, vec b) noexcept {
+                        if constexpr (std::is_same<T, float>::value) {
+                            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_GT_OQ);
+                        } else if constexpr (std::is_same<T, double>::value) {
+                            return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_GT_OQ);
+                        } else if constexpr (std::is_unsigned<T>::value) {
+                            if constexpr (sizeof(T) == 1) {
+                                return _mm512_cmpgt_epu8_mask(a, b);
+                            } else if constexpr (sizeof(T) == 2) {
+                                return _mm512_cmpgt_epu16_mask(a, b);
+                            } else if constexpr (sizeof(T) == 4) {
+                                return _mm512_cmpgt_epu32_mask(a, b);
+                            } else {
+                                return _mm512_cmpgt_epu64_mask(a, b);
+                            }
+                        } else {
+                            if constexpr (sizeof(T) == 1) {
+                                return _mm512_cmpgt_epi8_mask(a, b);
+                            } else if constexpr (sizeof(T) == 2) {
+                                return _mm512_cmpgt_epi16_mask(a, b);
+                            } else if constexpr (sizeof(T) == 4) {
+                                return _mm512_cmpgt_epi32_mask(a, b);
+                            } else {
+                                return _mm512_cmpgt_epi64_mask(a, b);
+                            }
+                        }
+                    }
+
+                    template <typename T>
+                    static inline vec add(vec a, vec b) noexcept {
+                        if constexpr (sizeof(T) == 1) {
+                            return _mm512_add_epi8(a, b);
+                        } else if constexpr (sizeof(T) == 2) {
+                            return _mm512_add_epi16(a, b);
+                        } else if constexpr (sizeof(T) == 4) {
+                            return _mm512_add_epi32(a, b);
+                        } else {
+                            return _mm512_add_epi64(a, b);
+                        }
+                    }
+
+                    // 256-bit lanes already hold a whole 8-element row, so the AVX2 tile is reused as is
+                    static constexpr std::size_t tile32 = avx2::ops::tile32;
+
+                    static inline void transpose_tile32(void const* src, std::size_t src_stride, void* dst, std::size_t dst_stride) noexcept {
+                        avx2::ops::transpose_tile32(src, src_stride, dst, dst_stride);
+                    }
+
+                    static inline vec zero() noexcept {
+                        return _mm512_setzero_si512();
+                    }
+
+                    static inline vec rotate32(vec v) noexcept {
+                        return _mm512_mask_permutexvar_epi32(v, 0xffff, _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0), v);
+                    }
+
+                    template <std::size_t Size>
+                    static inline void gather(void const* base, std::uint32_t const* idx, void* dst) noexcept {
+                        if constexpr (Size == 4) {
+                            store(dst, _mm512_mask_i32gather_epi32(zero(), 0xffff, load(idx), base, 4));
+                        } else {
+                            const __m256i i = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx));
+                            store(dst, _mm512_mask_i32gather_epi64(zero(), 0xff, i, base, 8));
+                        }
+                    }
+                };
+            }
+        }
+    }
+}
+#define DYN_ARRAY_SIMD_ISA avx512
+#include "dyn_array_simd_kernels.inl"
+#undef DYN_ARRAY_SIMD_ISA
+DYN_ARRAY_SIMD_TARGET_END
+
+#   define DYN_ARRAY_SIMD_DISPATCH(fn, ...)                                 \
+        switch (::cz::detail::simd::active_level()) {                       \
+        case ::cz::simd_level::avx512:                                      \
+            return ::cz::detail::simd::avx512::fn(__VA_ARGS__);             \
+        case ::cz::simd_level::avx2:                                        \
+            return ::cz::detail::simd::avx2::fn(__VA_ARGS__);               \
+        case ::cz::simd_level::sse42:                                       \
+            return ::cz::detail::simd::sse42::fn(__VA_ARGS__);              \
+        default:                                                            \
+            return ::cz::detail::simd::scalar::fn(__VA_ARGS__);             \
+        }
+#else
+#   define DYN_ARRAY_SIMD_DISPATCH(fn, ...) return ::cz::detail::simd::scalar::fn(__VA_ARGS__);
+#endif
+
+namespace cz {
+
+    inline simd_level active_simd_level() noexcept {
+        return detail::simd::active_level();
+    }
+
+    // caps the kernels every dispatch picks at level, or at what the CPU supports if that is lower, and
+    // returns the level now in effect; for tests and benchmarks, called while no other thread uses the library
+    inline simd_level set_simd_level(simd_level level) noexcept {
+        const simd_level supported = detail::simd::detect_level();
+        detail::simd::current_level() = level < supported ? level : supported;
+        return detail::simd::current_level();
+    }
+
+    namespace detail {
+        namespace simd {
+            template <typename T>
+            std::size_t find(T const* p, std::size_t n, T value) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(find, p, n, value)
+            }
+
+            // returns std::size_t(-1) when value does not occur
+            template <typename T>
+            std::size_t find_last(T const* p, std::size_t n, T value) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(find_last, p, n, value)
+            }
+
+            template <typename T>
+            std::size_t find_first_of(T const* p, std::size_t n, T const* set, std::size_t m) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(find_first_of, p, n, set, m)
+            }
+
+            // position of the first occurrence of needle[0, k) in p[0, n), n if none
+            inline std::size_t find_bytes(std::uint8_t const* p, std::size_t n, std::uint8_t const* needle, std::size_t k) noexcept {
+                DYN_ARRAY_SIMD_DISPATCH(find_bytes, p, n, needle, k)
+            }
+
+            // first element greater than value, n if none; NaNs never compare greater
+            template <typename T>
+            std::size_t find_greater(T const* p, std::size_t n, T value) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(find_greater, p, n, value)
+            }
+
+            template <typename T>
+            std::size_t count(T const* p, std::size_t n, T value) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(count, p, n, value)
+            }
+
+            template <typename T>
+            void fill(T* p, std::size_t n, T value) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(fill, p, n, value)
+            }
+
+            // for any 4-byte trivially copyable element type
+            inline void transpose32(void const* src, void* dst, std::size_t rows, std::size_t cols) noexcept {
+                DYN_ARRAY_SIMD_DISPATCH(transpose32, src, dst, rows, cols)
+            }
+
+            // dst[k] = src[idx[k]] for Size-byte elements (4 or 8); every index must be below 2^31
+            template <std::size_t Size>
+            void gather(void const* src, std::uint32_t const* idx, std::size_t n, void* dst, bool prefetch) noexcept {
+                static_assert(Size == 4 || Size == 8);
+                DYN_ARRAY_SIMD_DISPATCH(gather<Size>, src, idx, n, dst, prefetch)
+            }
+
+            template <typename T>
+            T sum(T const* p, std::size_t n) noexcept {
+                static_assert(is_integral_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(sum, p, n)
+            }
+
+            // elements common to a and b, both sorted without duplicates; returns how many were written to out
+            template <typename T>
+            std::size_t intersect(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) noexcept {
+                static_assert(is_integral_element<T>::value && sizeof(T) == 4);
+                DYN_ARRAY_SIMD_DISPATCH(intersect, a, na, b, nb, out)
+            }
+
+            // lower bounds of xs[0, m) in the sorted keys[0, n), found by descending an S+tree index: level h
+            // (1 = just above the leaves) starts at index + levels[h] and holds nodes of 64 / sizeof(T) separators,
+            // each the first key of the subtree right of it; keys itself is the leaf level
+            template <typename T>
+            void btree_lower_bound(T const* index, std::size_t const* levels, std::size_t height, T const* keys, std::size_t n,
+                                   T const* xs, std::size_t m, std::size_t* out) noexcept {
+                static_assert(is_element<T>::value);
+                DYN_ARRAY_SIMD_DISPATCH(btree_lower_bound, index, levels, height, keys, n, xs, m, out)
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,328 @@
+// Included once per instruction set by dyn_array_simd.hpp, with DYN_ARRAY_SIMD_ISA
+// naming the namespace that holds the matching `ops` and the target pragma active.
+
+namespace cz {
+    namespace detail {
+        namespace simd {
+            namespace DYN_ARRAY_SIMD_ISA {
+                template <typename T>
+                std::size_t find(T const* p, std::size_t n, T value) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    const auto v = ops::broadcast(value);
+
+                    std::size_t i = 0;
+                    for (; i + lanes <= n; i += lanes) {
+                        const ops::mask m = ops::eq_mask<T>(ops::load(p + i), v);
+                        if (m != 0) {
+                            return i + static_cast<std::size_t>(__builtin_ctzll(m)) / ops::stride<T>();
+                        }
+                    }
+
+                    for (; i < n; ++i) {
+                        if (p[i] == value) {
+                            return i;
+                        }
+                    }
+
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t find_last(T const* p, std::size_t n, T value) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    const auto v = ops::broadcast(value);
+
+                    while (n >= lanes) {
+                        n -= lanes;
+                        const ops::mask m = ops::eq_mask<T>(ops::load(p + n), v);
+                        if (m != 0) {
+                            return n + static_cast<std::size_t>(63 - __builtin_clzll(m)) / ops::stride<T>();
+                        }
+                    }
+
+                    while (n-- > 0) {
+                        if (p[n] == value) {
+                            return n;
+                        }
+                    }
+
+                    return static_cast<std::size_t>(-1);
+                }
+
+                template <typename T>
+                std::size_t find_first_of(T const* p, std::size_t n, T const* set, std::size_t m) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    constexpr std::size_t max_set = 16; // keeps the broadcast set in registers
+
+                    std::size_t i = 0;
+                    if (m <= max_set) {
+                        typename ops::vec needles[max_set];
+                        for (std::size_t j = 0; j < m; ++j) {
+                            needles[j] = ops::broadcast(set[j]);
+                        }
+
+                        for (; i + lanes <= n; i += lanes) {
+                            const auto block = ops::load(p + i);
+                            ops::mask hit = 0;
+                            for (std::size_t j = 0; j < m; ++j) {
+                                hit |= ops::eq_mask<T>(block, needles[j]);
+                            }
+                            if (hit != 0) {
+                                return i + static_cast<std::size_t>(__builtin_ctzll(hit)) / ops::stride<T>();
+                            }
+                        }
+                    }
+
+                    for (; i < n; ++i) {
+                        for (std::size_t j = 0; j < m; ++j) {
+                            if (p[i] == set[j]) {
+                                return i;
+                            }
+                        }
+                    }
+
+                    return n;
+                }
+
+                // first/last byte filter: only positions where both ends of the needle
+                // match are verified with memcmp
+                inline std::size_t find_bytes(std::uint8_t const* p, std::size_t n, std::uint8_t const* needle, std::size_t k) noexcept {
+                    if (k == 0) {
+                        return 0;
+                    }
+                    if (k > n) {
+                        return n;
+                    }
+                    if (k == 1) {
+                        return find(p, n, needle[0]);
+                    }
+
+                    const auto first = ops::broadcast(needle[0]);
+                    const auto last = ops::broadcast(needle[k - 1]);
+
+                    std::size_t i = 0;
+                    for (; i + k - 1 + ops::width <= n; i += ops::width) {
+                        ops::mask m = ops::eq_mask<std::uint8_t>(ops::load(p + i), first)
+                                    & ops::eq_mask<std::uint8_t>(ops::load(p + i + k - 1), last);
+                        while (m != 0) {
+                            const std::size_t at = i + static_cast<std::size_t>(__builtin_ctzll(m));
+                            if (std::memcmp(p + at + 1, needle + 1, k - 2) == 0) {
+                                return at;
+                            }
+                            m &= m - 1;
+                        }
+                    }
+
+                    for (; i + k <= n; ++i) {
+                        if (p[i] == needle[0] && std::memcmp(p + i, needle, k) == 0) {
+                            return i;
+                        }
+                    }
+
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t find_greater(T const* p, std::size_t n, T value) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    const auto v = ops::broadcast(value);
+
+                    std::size_t i = 0;
+                    for (; i + lanes <= n; i += lanes) {
+                        const ops::mask m = ops::gt_mask<T>(ops::load(p + i), v);
+                        if (m != 0) {
+                            return i + static_cast<std::size_t>(__builtin_ctzll(m)) / ops::stride<T>();
+                        }
+                    }
+
+                    for (; i < n; ++i) {
+                        if (value < p[i]) {
+                            return i;
+                        }
+                    }
+
+                    return n;
+                }
+
+                template <typename T>
+                std::size_t count(T const* p, std::size_t n, T value) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    const auto v = ops::broadcast(value);
+
+                    std::size_t c = 0;
+                    std::size_t i = 0;
+                    for (; i + lanes <= n; i += lanes) {
+                        c += static_cast<std::size_t>(__builtin_popcountll(ops::eq_mask<T>(ops::load(p + i), v)));
+                    }
+                    c /= ops::stride<T>();
+
+                    for (; i < n; ++i) {
+                        c += p[i] == value;
+                    }
+
+                    return c;
+                }
+
+                template <typename T>
+                void fill(T* p, std::size_t n, T value) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    const auto v = ops::broadcast(value);
+
+                    std::size_t i = 0;
+                    for (; i + lanes <= n; i += lanes) {
+                        ops::store(p + i, v);
+                    }
+
+                    for (; i < n; ++i) {
+                        p[i] = value;
+                    }
+                }
+
+                inline void transpose32(void const* src, void* dst, std::size_t rows, std::size_t cols) noexcept {
+                    constexpr std::size_t block = 32;
+                    constexpr std::size_t tile = ops::tile32;
+                    auto s = static_cast<unsigned char const*>(src);
+                    auto d = static_cast<unsigned char*>(dst);
+
+                    for (std::size_t ib = 0; ib < rows; ib += block) {
+                        const std::size_t ie = ib + block < rows ? ib + block : rows;
+                        for (std::size_t jb = 0; jb < cols; jb += block) {
+                            const std::size_t je = jb + block < cols ? jb + block : cols;
+
+                            std::size_t i = ib;
+                            for (; i + tile <= ie; i += tile) {
+                                std::size_t j = jb;
+                                for (; j + tile <= je; j += tile) {
+                                    ops::transpose_tile32(s + 4 * (i * cols + j), cols, d + 4 * (j * rows + i), rows);
+                                }
+                                for (; j < je; ++j) {
+                                    for (std::size_t k = i; k < i + tile; ++k) {
+                                        std::memcpy(d + 4 * (j * rows + k), s + 4 * (k * cols + j), 4);
+                                    }
+                                }
+                            }
+                            for (; i < ie; ++i) {
+                                for (std::size_t j = jb; j < je; ++j) {
+                                    std::memcpy(d + 4 * (j * rows + i), s + 4 * (i * cols + j), 4);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                template <typename T>
+                T sum(T const* p, std::size_t n) noexcept {
+                    using U = typename std::make_unsigned<T>::type;
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+
+                    // four independent accumulators hide the add latency
+                    auto a0 = ops::zero(), a1 = ops::zero(), a2 = ops::zero(), a3 = ops::zero();
+                    std::size_t i = 0;
+                    for (; i + 4 * lanes <= n; i += 4 * lanes) {
+                        a0 = ops::add<T>(a0, ops::load(p + i));
+                        a1 = ops::add<T>(a1, ops::load(p + i + lanes));
+                        a2 = ops::add<T>(a2, ops::load(p + i + 2 * lanes));
+                        a3 = ops::add<T>(a3, ops::load(p + i + 3 * lanes));
+                    }
+                    for (; i + lanes <= n; i += lanes) {
+                        a0 = ops::add<T>(a0, ops::load(p + i));
+                    }
+                    a0 = ops::add<T>(ops::add<T>(a0, a1), ops::add<T>(a2, a3));
+
+                    U partial[lanes];
+                    ops::store(partial, a0);
+
+                    U acc = 0;
+                    for (std::size_t l = 0; l < lanes; ++l) {
+                        acc += partial[l];
+                    }
+                    for (; i < n; ++i) {
+                        acc += static_cast<U>(p[i]);
+                    }
+
+                    return static_cast<T>(acc);
+                }
+
+                template <std::size_t Size>
+                void gather(void const* src, std::uint32_t const* idx, std::size_t n, void* dst, bool prefetch) noexcept {
+                    constexpr std::size_t lanes = ops::width / Size;
+                    auto s = static_cast<unsigned char const*>(src);
+                    auto d = static_cast<unsigned char*>(dst);
+
+                    std::size_t i = 0;
+                    for (; i + lanes <= n; i += lanes) {
+                        if (prefetch && i + prefetch_distance + lanes <= n) {
+                            for (std::size_t k = 0; k < lanes; ++k) {
+                                DYN_ARRAY_PREFETCH(s + Size * idx[i + prefetch_distance + k]);
+                            }
+                        }
+                        ops::gather<Size>(s, idx + i, d + Size * i);
+                    }
+
+                    for (; i < n; ++i) {
+                        std::memcpy(d + Size * i, s + Size * idx[i], Size);
+                    }
+                }
+
+                // compares a block of a against a block of b in every rotation, then drops whichever block
+                // ends lower (both when the last elements tie); the tails fall back to the scalar merge
+                template <typename T>
+                std::size_t intersect(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) noexcept {
+                    constexpr std::size_t lanes = ops::width / 4;
+                    constexpr unsigned stride = ops::stride<T>();
+
+                    std::size_t i = 0, j = 0, k = 0;
+                    while (i + lanes <= na && j + lanes <= nb) {
+                        const auto va = ops::load(a + i);
+                        auto vb = ops::load(b + j);
+
+                        ops::mask m = 0;
+                        for (std::size_t r = 0; r < lanes; ++r) {
+                            m |= ops::eq_mask<T>(va, vb);
+                            vb = ops::rotate32(vb);
+                        }
+
+                        // every lane is stored, the cursor moves only past matches; k never passes the
+                        // number of elements consumed from either input, so out needs min(na, nb) slots
+                        for (std::size_t lane = 0; lane < lanes; ++lane) {
+                            out[k] = a[i + lane];
+                            k += static_cast<std::size_t>(m >> (lane * stride) & 1);
+                        }
+
+                        const T amax = a[i + lanes - 1], bmax = b[j + lanes - 1];
+                        i += !(bmax < amax) ? lanes : 0;
+                        j += !(amax < bmax) ? lanes : 0;
+                    }
+
+                    return k + scalar::intersect(a + i, na - i, b + j, nb - j, out + k);
+                }
+
+                // keys of one node below x: the node's 64 bytes take one to four compares whose mask bits are summed
+                template <typename T>
+                inline std::size_t btree_rank(T const* node, typename ops::vec x) noexcept {
+                    constexpr std::size_t lanes = ops::width / sizeof(T);
+                    std::size_t bits = 0;
+                    for (std::size_t j = 0; j < 64 / sizeof(T); j += lanes) {
+                        bits += static_cast<std::size_t>(__builtin_popcountll(ops::gt_mask<T>(x, ops::load(node + j))));
+                    }
+                    return bits / ops::stride<T>();
+                }
+
+                template <typename T>
+                void btree_lower_bound(T const* index, std::size_t const* levels, std::size_t height, T const* keys, std::size_t n,
+                                       T const* xs, std::size_t m, std::size_t* out) noexcept {
+                    constexpr std::size_t B = 64 / sizeof(T);
+                    for (std::size_t q = 0; q < m; ++q) {
+                        const auto x = ops::broadcast(xs[q]);
+                        std::size_t k = 0;
+                        for (std::size_t h = height - 1; h > 0; --h) {
+                            k = k * (B + 1) + btree_rank<T>(index + levels[h] + k, x) * B;
+                        }
+                        // a partial last leaf would read past the keys
+                        out[q] = k + (n - k >= B ? btree_rank<T>(keys + k, x) : scalar::btree_rank(keys + k, n - k, xs[q]));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,176 @@
+#ifndef DYN_ARRAY_SORT_HPP
+#define DYN_ARRAY_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#include "dyn_array_simd.hpp"
+
+namespace cz {
+    namespace detail {
+        namespace sort {
+            template <std::size_t Size>
+            struct unsigned_of;
+
+            template <> struct unsigned_of<1> { using type = std::uint8_t; };
+            template <> struct unsigned_of<2> { using type = std::uint16_t; };
+            template <> struct unsigned_of<4> { using type = std::uint32_t; };
+            template <> struct unsigned_of<8> { using type = std::uint64_t; };
+
+            // maps T to an unsigned integer with the same order: signed values get their sign bit flipped,
+            // negative floats are inverted whole; NaNs land past the infinities of their sign
+            template <typename T>
+            inline typename unsigned_of<sizeof(T)>::type radix_key(T value) noexcept {
+                using U = typename unsigned_of<sizeof(T)>::type;
+                constexpr U sign = static_cast<U>(U{1} << (sizeof(T) * 8 - 1));
+
+                U bits;
+                std::memcpy(&bits, &value, sizeof(T));
+                if constexpr (std::is_floating_point<T>::value) {
+                    return (bits & sign) != 0 ? static_cast<U>(~bits) : static_cast<U>(bits | sign);
+                } else if constexpr (std::is_signed<T>::value) {
+                    return static_cast<U>(bits ^ sign);
+                } else {
+                    return bits;
+                }
+            }
+
+            // stable LSD radix sort of the indexes 0..n-1 by p[index], one byte per pass;
+            // all histograms come from a single read of the keys, and passes whose byte is constant are skipped
+            template <typename T, typename I>
+            void radix_argsort(T const* p, std::size_t n, I* out) {
+                using U = typename unsigned_of<sizeof(T)>::type;
+                constexpr std::size_t passes = sizeof(T);
+
+                std::unique_ptr<U[]> keys(new U[2 * n]);
+                std::unique_ptr<I[]> tmp(new I[n]);
+                std::unique_ptr<std::size_t[]> hist(new std::size_t[passes * 256]());
+
+                U* ks = keys.get();
+                U* kd = keys.get() + n;
+                I* is = out;
+                I* id = tmp.get();
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    const U k = radix_key(p[i]);
+                    ks[i] = k;
+                    is[i] = static_cast<I>(i);
+                    for (std::size_t d = 0; d < passes; ++d) {
+                        ++hist[d * 256 + (k >> (8 * d) & 0xff)];
+                    }
+                }
+
+                for (std::size_t d = 0; d < passes; ++d) {
+                    std::size_t* h = hist.get() + d * 256;
+                    if (h[ks[0] >> (8 * d) & 0xff] == n) {
+                        continue;
+                    }
+
+                    std::size_t sum = 0;
+                    for (std::size_t b = 0; b < 256; ++b) {
+                        const std::size_t c = h[b];
+                        h[b] = sum;
+                        sum += c;
+                    }
+
+                    for (std::size_t i = 0; i < n; ++i) {
+                        const std::size_t pos = h[ks[i] >> (8 * d) & 0xff]++;
+                        kd[pos] = ks[i];
+                        id[pos] = is[i];
+                    }
+                    std::swap(ks, kd);
+                    std::swap(is, id);
+                }
+
+                if (is != out) {
+                    std::memcpy(out, is, n * sizeof(I));
+                }
+            }
+
+            template <typename It, typename Compare>
+            void insertion_sort(It first, It last, Compare& cmp) {
+                if (first == last) {
+                    return;
+                }
+                for (It i = first + 1; i != last; ++i) {
+                    auto v = std::move(*i);
+                    It j = i;
+                    for (; j != first && cmp(v, *(j - 1)); --j) {
+                        *j = std::move(*(j - 1));
+                    }
+                    *j = std::move(v);
+                }
+            }
+
+            // quickselect on a median-of-three pivot; once the recursion depth passes 2 log2(n) the
+            // remaining range is finished with a heap select, bounding the worst case at O(n log n)
+            template <typename It, typename Compare>
+            void introselect(It first, It nth, It last, Compare cmp) {
+                if (first == last || nth == last) {
+                    return;
+                }
+
+                std::size_t depth = 0;
+                for (auto n = last - first; n > 1; n >>= 1) {
+                    depth += 2;
+                }
+
+                while (last - first > 16) {
+                    if (depth-- == 0) {
+                        std::partial_sort(first, nth + 1, last, cmp);
+                        return;
+                    }
+
+                    It mid = first + (last - first) / 2;
+                    It back = last - 1;
+                    if (cmp(*mid, *first)) {
+                        std::iter_swap(mid, first);
+                    }
+                    if (cmp(*back, *mid)) {
+                        std::iter_swap(back, mid);
+                        if (cmp(*mid, *first)) {
+                            std::iter_swap(mid, first);
+                        }
+                    }
+                    // *first <= *mid <= *back: both ends act as sentinels for the Hoare scan
+                    std::iter_swap(mid, first + 1);
+                    auto const& pivot = *(first + 1);
+
+                    It lo = first + 1;
+                    It hi = back;
+                    for (;;) {
+                        do {
+                            ++lo;
+                        } while (cmp(*lo, pivot));
+                        do {
+                            --hi;
+                        } while (cmp(pivot, *hi));
+                        if (!(lo < hi)) {
+                            break;
+                        }
+                        std::iter_swap(lo, hi);
+                    }
+                    std::iter_swap(first + 1, hi);
+
+                    if (hi == nth) {
+                        return;
+                    }
+                    if (nth < hi) {
+                        last = hi;
+                    } else {
+                        first = hi + 1;
+                    }
+                }
+
+                insertion_sort(first, last, cmp);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,625 @@
+#ifndef DYN_MATRIX_HPP
+#define DYN_MATRIX_HPP
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "dyn_array.hpp"
+
+#if defined(__has_include)
+#   if __has_include(<mdspan>) && __cplusplus > 202002L
+#       include <mdspan>
+#   endif
+#endif
+
+namespace cz {
+
+    template <std::size_t Rank, typename SizeT = std::size_t>
+    class md_extents {
+
+        static_assert(Rank > 0);
+        static_assert(std::is_integral<SizeT>::value);
+
+    public:
+
+        using size_type = SizeT;
+
+    private:
+
+        std::array<size_type, Rank> m_ext{};
+
+    public:
+
+        constexpr md_extents() noexcept = default;
+
+        template <typename... Exts, typename = typename std::enable_if<sizeof...(Exts) == Rank>::type>
+        constexpr md_extents(Exts... exts) noexcept
+            : m_ext{static_cast<size_type>(exts)...} {
+        }
+
+        constexpr md_extents(std::array<size_type, Rank> const& exts) noexcept
+            : m_ext{exts} {
+        }
+
+        static constexpr std::size_t rank() noexcept {
+            return Rank;
+        }
+
+        dyn_array_always_inline constexpr size_type extent(std::size_t r) const noexcept {
+            return m_ext[r];
+        }
+
+        constexpr size_type size() const noexcept {
+            size_type n = 1;
+            for (auto e : m_ext) {
+                n *= e;
+            }
+            return n;
+        }
+
+        constexpr bool operator==(md_extents const& other) const noexcept {
+            return m_ext == other.m_ext;
+        }
+
+        constexpr bool operator!=(md_extents const& other) const noexcept {
+            return m_ext != other.m_ext;
+        }
+    };
+
+    namespace detail {
+        template <std::size_t Rank, typename SizeT>
+        class strided_mapping {
+        public:
+
+            using size_type = SizeT;
+            using extents_type = md_extents<Rank, SizeT>;
+
+        protected:
+
+            extents_type m_ext;
+            std::array<size_type, Rank> m_strides{};
+
+        public:
+
+            constexpr strided_mapping() noexcept = default;
+
+            constexpr strided_mapping(extents_type const& ext, std::array<size_type, Rank> const& strides) noexcept
+                : m_ext{ext}
+                , m_strides{strides} {
+            }
+
+            template <typename... Idx>
+            dyn_array_always_inline constexpr size_type operator()(Idx... idx) const noexcept {
+                static_assert(sizeof...(Idx) == Rank);
+                const size_type i[Rank] = {static_cast<size_type>(idx)...};
+                size_type off = 0;
+                for (std::size_t r = 0; r < Rank; ++r) {
+                    assert(i[r] < m_ext.extent(r));
+                    off += i[r] * m_strides[r];
+                }
+                return off;
+            }
+
+            constexpr extents_type const& extents() const noexcept {
+                return m_ext;
+            }
+
+            constexpr size_type stride(std::size_t r) const noexcept {
+                return m_strides[r];
+            }
+
+            constexpr size_type required_span_size() const noexcept {
+                if (m_ext.size() == 0) {
+                    return 0;
+                }
+                size_type last = 0;
+                for (std::size_t r = 0; r < Rank; ++r) {
+                    last += (m_ext.extent(r) - 1) * m_strides[r];
+                }
+                return last + 1;
+            }
+
+            static constexpr bool is_always_strided() noexcept {
+                return true;
+            }
+        };
+    }
+
+    // mdspan-style layout policies; layout_right is row-major, layout_left column-major
+    struct layout_right {
+        template <std::size_t Rank, typename SizeT>
+        class mapping : public detail::strided_mapping<Rank, SizeT> {
+        public:
+            using extents_type = md_extents<Rank, SizeT>;
+
+            constexpr mapping() noexcept = default;
+
+            constexpr mapping(extents_type const& ext) noexcept {
+                this->m_ext = ext;
+                SizeT s = 1;
+                for (std::size_t r = Rank; r-- > 0;) {
+                    this->m_strides[r] = s;
+                    s *= ext.extent(r);
+                }
+            }
+
+            static constexpr bool is_always_exhaustive() noexcept {
+                return true;
+            }
+        };
+    };
+
+    struct layout_left {
+        template <std::size_t Rank, typename SizeT>
+        class mapping : public detail::strided_mapping<Rank, SizeT> {
+        public:
+            using extents_type = md_extents<Rank, SizeT>;
+
+            constexpr mapping() noexcept = default;
+
+            constexpr mapping(extents_type const& ext) noexcept {
+                this->m_ext = ext;
+                SizeT s = 1;
+                for (std::size_t r = 0; r < Rank; ++r) {
+                    this->m_strides[r] = s;
+                    s *= ext.extent(r);
+                }
+            }
+
+            static constexpr bool is_always_exhaustive() noexcept {
+                return true;
+            }
+        };
+    };
+
+    struct layout_stride {
+        template <std::size_t Rank, typename SizeT>
+        class mapping : public detail::strided_mapping<Rank, SizeT> {
+        public:
+            using extents_type = md_extents<Rank, SizeT>;
+
+            constexpr mapping() noexcept = default;
+
+            constexpr mapping(extents_type const& ext, std::array<SizeT, Rank> const& strides) noexcept
+                : detail::strided_mapping<Rank, SizeT>(ext, strides) {
+            }
+
+            static constexpr bool is_always_exhaustive() noexcept {
+                return false;
+            }
+        };
+    };
+
+    // 2D only: tile_rows x tile_cols tiles stored row-major, elements row-major inside a tile;
+    // extents are padded up to whole tiles
+    template <std::size_t tile_rows = 16, std::size_t tile_cols = 16>
+    struct layout_tiled {
+        static_assert(tile_rows > 0 && tile_cols > 0);
+
+        template <std::size_t Rank, typename SizeT>
+        class mapping {
+
+            static_assert(Rank == 2, "layout_tiled is two-dimensional");
+
+        public:
+
+            using size_type = SizeT;
+            using extents_type = md_extents<Rank, SizeT>;
+
+            static constexpr size_type tile_size = static_cast<size_type>(tile_rows * tile_cols);
+
+        private:
+
+            extents_type m_ext;
+            size_type m_tiles_per_row = 0;
+
+        public:
+
+            constexpr mapping() noexcept = default;
+
+            constexpr mapping(extents_type const& ext) noexcept
+                : m_ext{ext}
+                , m_tiles_per_row{static_cast<size_type>((ext.extent(1) + tile_cols - 1) / tile_cols)} {
+            }
+
+            dyn_array_always_inline constexpr size_type operator()(size_type i, size_type j) const noexcept {
+                assert(i < m_ext.extent(0) && j < m_ext.extent(1));
+                const size_type tile = static_cast<size_type>(i / tile_rows) * m_tiles_per_row + static_cast<size_type>(j / tile_cols);
+                return tile * tile_size + static_cast<size_type>(i % tile_rows) * tile_cols + static_cast<size_type>(j % tile_cols);
+            }
+
+            constexpr extents_type const& extents() const noexcept {
+                return m_ext;
+            }
+
+            constexpr size_type required_span_size() const noexcept {
+                const size_type tile_row_count = static_cast<size_type>((m_ext.extent(0) + tile_rows - 1) / tile_rows);
+                return tile_row_count * m_tiles_per_row * tile_size;
+            }
+
+            static constexpr bool is_always_exhaustive() noexcept {
+                return false;
+            }
+
+            static constexpr bool is_always_strided() noexcept {
+                return false;
+            }
+        };
+    };
+
+    // non-owning multi-dimensional view over contiguous storage such as dyn_array::data()
+    template <typename T, std::size_t Rank, typename Layout = layout_right, typename SizeT = std::size_t>
+    class md_view {
+    public:
+
+        using element_type = T;
+        using value_type = typename std::remove_cv<T>::type;
+        using size_type = SizeT;
+        using layout_type = Layout;
+        using extents_type = md_extents<Rank, SizeT>;
+        using mapping_type = typename Layout::template mapping<Rank, SizeT>;
+        using pointer = T*;
+        using reference = T&;
+
+    private:
+
+        pointer m_data = nullptr;
+        mapping_type m_map;
+
+    public:
+
+        constexpr md_view() noexcept = default;
+
+        constexpr md_view(pointer data, mapping_type const& map) noexcept
+            : m_data{data}
+            , m_map{map} {
+        }
+
+        template <typename... Exts, typename = typename std::enable_if<
+            sizeof...(Exts) == Rank && (std::is_integral<Exts>::value && ...)
+        >::type>
+        constexpr md_view(pointer data, Exts... exts) noexcept
+            : m_data{data}
+            , m_map{extents_type(exts...)} {
+        }
+
+        template <typename... Idx>
+        dyn_array_always_inline constexpr reference operator()(Idx... idx) const noexcept {
+            return m_data[m_map(static_cast<size_type>(idx)...)];
+        }
+
+        dyn_array_always_inline constexpr pointer data_handle() const noexcept {
+            return m_data;
+        }
+
+        dyn_array_always_inline constexpr mapping_type const& mapping() const noexcept {
+            return m_map;
+        }
+
+        dyn_array_always_inline constexpr extents_type const& extents() const noexcept {
+            return m_map.extents();
+        }
+
+        dyn_array_always_inline constexpr size_type extent(std::size_t r) const noexcept {
+            return m_map.extents().extent(r);
+        }
+
+        dyn_array_always_inline constexpr size_type stride(std::size_t r) const noexcept {
+            return m_map.stride(r);
+        }
+
+        dyn_array_always_inline constexpr size_type size() const noexcept {
+            return m_map.extents().size();
+        }
+
+        static constexpr std::size_t rank() noexcept {
+            return Rank;
+        }
+
+#if defined(__cpp_lib_mdspan)
+        template <typename L = Layout, typename = typename std::enable_if<
+            std::is_same<L, layout_right>::value || std::is_same<L, layout_left>::value
+        >::type>
+        auto to_mdspan() const {
+            using std_layout = typename std::conditional<std::is_same<L, layout_right>::value, std::layout_right, std::layout_left>::type;
+            std::array<SizeT, Rank> exts;
+            for (std::size_t r = 0; r < Rank; ++r) {
+                exts[r] = extent(r);
+            }
+            return std::mdspan<T, std::dextents<SizeT, Rank>, std_layout>(m_data, exts);
+        }
+#endif
+    };
+
+    template <typename Layout = layout_right, typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier, typename... Exts>
+    md_view<T, sizeof...(Exts), Layout, SizeT> make_md_view(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& arr, Exts... exts) {
+        md_view<T, sizeof...(Exts), Layout, SizeT> v(arr.data(), exts...);
+        assert(v.mapping().required_span_size() <= arr.size());
+        return v;
+    }
+
+    template <typename Layout = layout_right, typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier, typename... Exts>
+    md_view<T const, sizeof...(Exts), Layout, SizeT> make_md_view(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& arr, Exts... exts) {
+        md_view<T const, sizeof...(Exts), Layout, SizeT> v(arr.data(), exts...);
+        assert(v.mapping().required_span_size() <= arr.size());
+        return v;
+    }
+
+    // src is rows x cols row-major, dst receives the cols x rows row-major result; must not overlap
+    template <typename T>
+    void transpose(T const* src, T* dst, std::size_t rows, std::size_t cols) {
+        if constexpr (sizeof(T) == 4 && std::is_trivially_copyable<T>::value) {
+            detail::simd::transpose32(src, dst, rows, cols);
+        } else {
+            constexpr std::size_t block = sizeof(T) >= 64 ? 4 : 64 / sizeof(T) * 4;
+            for (std::size_t ib = 0; ib < rows; ib += block) {
+                const std::size_t ie = std::min(ib + block, rows);
+                for (std::size_t jb = 0; jb < cols; jb += block) {
+                    const std::size_t je = std::min(jb + block, cols);
+                    for (std::size_t i = ib; i < ie; ++i) {
+                        for (std::size_t j = jb; j < je; ++j) {
+                            dst[j * rows + i] = src[i * cols + j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // n x n, swapping mirrored blocks so both sides stay cache-resident
+    template <typename T>
+    void transpose_square_in_place(T* p, std::size_t n) {
+        using std::swap;
+        constexpr std::size_t block = sizeof(T) >= 64 ? 4 : 64 / sizeof(T) * 2;
+
+        for (std::size_t ib = 0; ib < n; ib += block) {
+            const std::size_t ie = std::min(ib + block, n);
+            for (std::size_t i = ib; i < ie; ++i) {
+                for (std::size_t j = i + 1; j < ie; ++j) {
+                    swap(p[i * n + j], p[j * n + i]);
+                }
+            }
+            for (std::size_t jb = ib + block; jb < n; jb += block) {
+                const std::size_t je = std::min(jb + block, n);
+                for (std::size_t i = ib; i < ie; ++i) {
+                    for (std::size_t j = jb; j < je; ++j) {
+                        swap(p[i * n + j], p[j * n + i]);
+                    }
+                }
+            }
+        }
+    }
+
+    namespace detail {
+        // a * b % m for any 64-bit operands; the product is only formed in 64 bits when it cannot overflow
+        inline std::uint64_t mulmod(std::uint64_t a, std::uint64_t b, std::uint64_t m) noexcept {
+            if (((a | b) >> 32) == 0) {
+                return a * b % m;
+            }
+#if defined(__SIZEOF_INT128__)
+            __extension__ typedef unsigned __int128 u128;
+            return static_cast<std::uint64_t>(static_cast<u128>(a) * b % m);
+#else
+            a %= m;
+            std::uint64_t r = 0;
+            for (; b != 0; b >>= 1) {
+                if (b & 1) {
+                    r = r >= m - a ? r - (m - a) : r + a;
+                }
+                a = a >= m - a ? a - (m - a) : a + a;
+            }
+            return r;
+#endif
+        }
+    }
+
+    // rows x cols row-major becomes cols x rows row-major; rectangular shapes follow the permutation
+    // cycles k -> k * rows mod (n - 1), with one visited bit per element
+    template <typename T>
+    void transpose_in_place(T* p, std::size_t rows, std::size_t cols) {
+        if (rows == cols) {
+            transpose_square_in_place(p, rows);
+            return;
+        }
+
+        const std::size_t n = rows * cols;
+        if (n < 3 || rows == 1 || cols == 1) {
+            return;
+        }
+
+        const std::size_t modulus = n - 1;
+        dyn_array<std::uint64_t> visited(modulus / 64 + 1, std::uint64_t{0});
+
+        for (std::size_t start = 1; start < modulus; ++start) {
+            if (visited[start / 64] >> (start % 64) & 1) {
+                continue;
+            }
+
+            T carried = std::move(p[start]);
+            std::size_t pos = start;
+            do {
+                pos = static_cast<std::size_t>(detail::mulmod(pos, rows, modulus));
+                visited[pos / 64] |= std::uint64_t{1} << (pos % 64);
+                std::swap(carried, p[pos]);
+            } while (pos != start);
+        }
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> transposed(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& src, SizeT rows, SizeT cols) {
+        assert(src.size() == rows * cols);
+        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> dst(src.size());
+        transpose(src.data(), dst.data(), rows, cols);
+        return dst;
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void transpose_in_place(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& arr, SizeT rows, SizeT cols) {
+        assert(arr.size() == rows * cols);
+        transpose_in_place(arr.data(), rows, cols);
+    }
+
+    // AoS -> SoA: one field of every element, gathered into its own array
+    template <typename S, typename F, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    dyn_array<F> gather_field(dyn_array<S, alloc_t, SizeT, initial_cap, multiplier> const& aos, F S::* field) {
+        dyn_array<F> out;
+        out.reserve(aos.size());
+        for (auto const& e : aos) {
+            out.push_back(e.*field);
+        }
+        return out;
+    }
+
+    // SoA -> AoS: writes values[i] into aos[i].*field
+    template <typename S, typename F, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier, typename ValuesArray>
+    void scatter_field(dyn_array<S, alloc_t, SizeT, initial_cap, multiplier>& aos, F S::* field, ValuesArray const& values) {
+        assert(static_cast<std::size_t>(values.size()) == static_cast<std::size_t>(aos.size()));
+        auto v = values.begin();
+        for (auto& e : aos) {
+            e.*field = *v++;
+        }
+    }
+
+    template <typename S, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier, typename... Fs>
+    std::tuple<dyn_array<Fs>...> aos_to_soa(dyn_array<S, alloc_t, SizeT, initial_cap, multiplier> const& aos, Fs S::*... fields) {
+        return std::tuple<dyn_array<Fs>...>(gather_field(aos, fields)...);
+    }
+
+    // owning rows x cols matrix over dyn_array storage; the layout fixes where element (i, j) lives
+    template <
+        typename T,
+        typename Layout = layout_right,
+        typename alloc_t = std::allocator<T>,
+        typename SizeT = std::size_t
+    >
+    class dyn_matrix {
+    public:
+
+        using value_type = T;
+        using layout_type = Layout;
+        using size_type = SizeT;
+        using array_type = dyn_array<T, alloc_t, SizeT>;
+        using mapping_type = typename Layout::template mapping<2, SizeT>;
+        using view_type = md_view<T, 2, Layout, SizeT>;
+        using const_view_type = md_view<T const, 2, Layout, SizeT>;
+        using reference = T&;
+        using const_reference = T const&;
+
+    private:
+
+        mapping_type m_map;
+        array_type m_data;
+
+    public:
+
+        dyn_matrix() = default;
+
+        dyn_matrix(size_type rows, size_type cols, const_reference value = {})
+            : m_map{md_extents<2, SizeT>(rows, cols)}
+            , m_data(m_map.required_span_size(), value) {
+        }
+
+        // elements given in row-major order, whatever the target layout
+        dyn_matrix(size_type rows, size_type cols, array_type const& row_major)
+            : dyn_matrix(rows, cols) {
+            assert(row_major.size() == rows * cols);
+            for (size_type i = 0; i < rows; ++i) {
+                for (size_type j = 0; j < cols; ++j) {
+                    (*this)(i, j) = row_major[i * cols + j];
+                }
+            }
+        }
+
+        template <typename OtherLayout>
+        explicit dyn_matrix(dyn_matrix<T, OtherLayout, alloc_t, SizeT> const& other)
+            : dyn_matrix(other.rows(), other.cols()) {
+            if constexpr (std::is_same<OtherLayout, layout_right>::value && std::is_same<Layout, layout_left>::value) {
+                transpose(other.data(), data(), rows(), cols());
+            } else if constexpr (std::is_same<OtherLayout, layout_left>::value && std::is_same<Layout, layout_right>::value) {
+                transpose(other.data(), data(), cols(), rows());
+            } else {
+                for (size_type i = 0; i < rows(); ++i) {
+                    for (size_type j = 0; j < cols(); ++j) {
+                        (*this)(i, j) = other(i, j);
+                    }
+                }
+            }
+        }
+
+        dyn_matrix transposed() const {
+            dyn_matrix out(cols(), rows());
+            if constexpr (std::is_same<Layout, layout_right>::value) {
+                transpose(data(), out.data(), rows(), cols());
+            } else if constexpr (std::is_same<Layout, layout_left>::value) {
+                transpose(data(), out.data(), cols(), rows());
+            } else {
+                for (size_type i = 0; i < rows(); ++i) {
+                    for (size_type j = 0; j < cols(); ++j) {
+                        out(j, i) = (*this)(i, j);
+                    }
+                }
+            }
+            return out;
+        }
+
+        void transpose_in_place() {
+            static_assert(std::is_same<Layout, layout_right>::value || std::is_same<Layout, layout_left>::value,
+                "in-place transpose needs a dense row- or column-major layout");
+            if constexpr (std::is_same<Layout, layout_right>::value) {
+                cz::transpose_in_place(data(), rows(), cols());
+            } else {
+                cz::transpose_in_place(data(), cols(), rows());
+            }
+            m_map = mapping_type(md_extents<2, SizeT>(cols(), rows()));
+        }
+
+        dyn_array_always_inline reference operator()(size_type i, size_type j) noexcept {
+            return m_data[m_map(i, j)];
+        }
+
+        dyn_array_always_inline const_reference operator()(size_type i, size_type j) const noexcept {
+            return m_data[m_map(i, j)];
+        }
+
+        dyn_array_always_inline view_type view() noexcept {
+            return view_type(m_data.data(), m_map);
+        }
+
+        dyn_array_always_inline const_view_type view() const noexcept {
+            return const_view_type(m_data.data(), m_map);
+        }
+
+        dyn_array_always_inline mapping_type const& mapping() const noexcept {
+            return m_map;
+        }
+
+        dyn_array_always_inline size_type rows() const noexcept {
+            return m_map.extents().extent(0);
+        }
+
+        dyn_array_always_inline size_type cols() const noexcept {
+            return m_map.extents().extent(1);
+        }
+
+        dyn_array_always_inline T* data() noexcept {
+            return m_data.data();
+        }
+
+        dyn_array_always_inline T const* data() const noexcept {
+            return m_data.data();
+        }
+
+        // the backing storage, including any tile padding
+        dyn_array_always_inline array_type const& storage() const noexcept {
+            return m_data;
+        }
+
+        dyn_array_always_inline array_type& storage() noexcept {
+            return m_data;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,397 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "dyn_array.hpp"
+#include "npy.hpp"
+#include "set_operations.hpp"
+
+// sorts more elements than fit in memory. Input is collected into one of two buffers that share the memory
+// budget; a full buffer is sorted and written out as a .npy run on a background thread while the other
+// fills. finish() then merges the runs through a loser tree, reading each run in blocks and handing full
+// output blocks to a writer thread, so the merge never waits on its own writes. The result is a .npy file,
+// usable afterwards through load_npy or npy_mapped.
+
+namespace cz {
+
+    struct external_sort_options {
+        std::size_t memory_budget = std::size_t{256} << 20; // bytes of element storage, in every phase
+        std::string temp_dir;                              // parent of the private run directory; empty: the system one
+        std::size_t max_fan_in = 256;                      // runs merged at once; more take extra passes
+    };
+
+    template <typename T, typename Compare = std::less<T>>
+    class external_sorter {
+
+        static_assert(std::is_arithmetic<T>::value, "runs are stored as npy files");
+
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+    private:
+
+        external_sort_options m_options;
+        Compare m_cmp;
+        dyn_array<T> m_fill;    // being filled by the caller
+        dyn_array<T> m_sorting; // owned by m_worker while it runs
+        std::thread m_worker;
+        dyn_array<std::string> m_runs;
+        std::filesystem::path m_temp_parent;
+        std::string m_temp_dir; // created on the first spill, owner-only, removed with the last run
+        std::size_t m_next_run = 0;
+        std::size_t m_size = 0;
+        bool m_failed = false;
+
+        dyn_array_always_inline std::size_t _buffer_elems() const noexcept {
+            const std::size_t n = m_options.memory_budget / (2 * sizeof(T));
+            return n < 1024 ? 1024 : n;
+        }
+
+        // runs live in a directory only this sorter can have created, so their predictable names cannot be
+        // raced by links planted in a shared temporary directory. Empty if that directory cannot be made
+        std::string _run_path() {
+            if (m_temp_dir.empty() && !_make_temp_dir()) {
+                return {};
+            }
+            return (std::filesystem::path(m_temp_dir) / ("run_" + std::to_string(m_next_run++) + ".npy")).string();
+        }
+
+        bool _make_temp_dir() {
+#ifdef DYN_ARRAY_NPY_POSIX
+            std::string pattern = (m_temp_parent / "cz_external_sort_XXXXXX").string();
+            if (::mkdtemp(&pattern[0]) == nullptr) {
+                return false;
+            }
+            m_temp_dir = std::move(pattern);
+            return true;
+#else
+            // create_directory reports false for a name that already exists, so only a fresh one is taken
+            const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            for (int attempt = 0; attempt < 100; ++attempt) {
+                const auto dir = m_temp_parent / ("cz_external_sort_" + std::to_string(stamp) + "_" + std::to_string(attempt));
+                std::error_code ec;
+                if (std::filesystem::create_directory(dir, ec)) {
+                    std::filesystem::permissions(dir, std::filesystem::perms::owner_all, ec);
+                    m_temp_dir = dir.string();
+                    return true;
+                }
+            }
+            return false;
+#endif
+        }
+
+        void _remove_temp_dir() {
+            if (!m_temp_dir.empty()) {
+                std::error_code ec;
+                std::filesystem::remove_all(m_temp_dir, ec);
+                m_temp_dir.clear();
+            }
+        }
+
+        void _join() {
+            if (m_worker.joinable()) {
+                m_worker.join();
+            }
+        }
+
+        // sorts m_sorting and writes it to path; runs on m_worker, so it touches nothing else
+        void _write_run(std::string path) {
+            std::sort(m_sorting.begin(), m_sorting.end(), m_cmp);
+            if (!path.empty() && save_npy(path.c_str(), m_sorting)) {
+                m_runs.push_back(std::move(path));
+            } else {
+                if (!path.empty()) {
+                    std::remove(path.c_str());
+                }
+                m_failed = true;
+            }
+            m_sorting.clear();
+        }
+
+        // hands the full fill buffer to the worker once it is done with the previous one
+        void _spill() {
+            _join();
+            std::swap(m_fill, m_sorting);
+            m_fill.reserve(_buffer_elems());
+            m_worker = std::thread(&external_sorter::_write_run, this, _run_path());
+        }
+
+        // merges the given runs into a .npy file at out_path, at most memory_budget bytes of blocks in flight
+        bool _merge(dyn_array<std::string> const& inputs, std::string const& out_path) const {
+            const std::size_t k = inputs.size();
+            std::size_t block = m_options.memory_budget / sizeof(T) / (k + 2);
+            block = block < 1024 ? 1024 : block;
+
+            dyn_array<std::FILE*> files(k, static_cast<std::FILE*>(nullptr));
+            dyn_array<std::size_t> left(k, std::size_t{0});
+            dyn_array<dyn_array<T>> blocks(k, dyn_array<T>(block));
+            bool ok = true;
+            std::size_t total = 0;
+
+            auto read_block = [&](std::size_t i) -> std::size_t {
+                const std::size_t n = left[i] < block ? left[i] : block;
+                if (n != 0 && !detail::npy::read_all(files[i], blocks[i].data(), n * sizeof(T))) {
+                    ok = false;
+                    left[i] = 0;
+                    return 0;
+                }
+                left[i] -= n;
+                return n;
+            };
+
+            dyn_array<dyn_array_view<T const>> heads;
+            heads.reserve(k);
+            for (std::size_t i = 0; i < k; ++i) {
+                npy_header h;
+                files[i] = std::fopen(inputs[i].c_str(), "rb");
+                ok = ok && files[i] != nullptr && detail::npy::read_header(files[i], h) && h.descr == detail::npy::descr<T>();
+                if (!ok) {
+                    break;
+                }
+                left[i] = h.count();
+                total += left[i];
+                const std::size_t n = read_block(i);
+                heads.push_back(dyn_array_view<T const>(blocks[i].data(), n));
+            }
+
+            std::FILE* out = ok ? std::fopen(out_path.c_str(), "wb") : nullptr;
+            if (out != nullptr) {
+                const std::string header = detail::npy::make_header(detail::npy::descr<T>(), dyn_array<std::size_t>{total});
+                ok = std::fwrite(header.data(), 1, header.size(), out) == header.size();
+
+                detail::sets::loser_tree<T, Compare> tree(heads, m_cmp);
+                auto refill = [&](std::size_t i, T const*& cur, T const*& end) {
+                    const std::size_t n = read_block(i);
+                    cur = blocks[i].data();
+                    end = cur + n;
+                };
+
+                // two output blocks: one fills while the writer thread drains the other
+                dyn_array<T> pending[2] = {dyn_array<T>(block), dyn_array<T>(block)};
+                std::thread writer;
+                bool write_ok = true;
+                auto hand_off = [&](std::size_t b, std::size_t n) {
+                    if (writer.joinable()) {
+                        writer.join();
+                    }
+                    writer = std::thread([&write_ok, out, p = pending[b].data(), n] {
+                        write_ok = write_ok && std::fwrite(p, sizeof(T), n, out) == n;
+                    });
+                };
+
+                std::size_t b = 0, n = 0;
+                for (std::size_t i = 0; i < total && ok; ++i) {
+                    pending[b][n++] = tree.pop(refill);
+                    if (n == block) {
+                        hand_off(b, n);
+                        b ^= 1;
+                        n = 0;
+                    }
+                }
+                if (n != 0) {
+                    hand_off(b, n);
+                }
+                if (writer.joinable()) {
+                    writer.join();
+                }
+                ok = ok && write_ok;
+                ok = std::fclose(out) == 0 && ok;
+            } else {
+                ok = false;
+            }
+
+            for (auto f : files) {
+                if (f != nullptr) {
+                    std::fclose(f);
+                }
+            }
+            return ok;
+        }
+
+    public:
+
+        explicit external_sorter(external_sort_options options = {}, Compare cmp = Compare{})
+            : m_options{std::move(options)}
+            , m_cmp{cmp} {
+            std::error_code ec;
+            m_temp_parent = m_options.temp_dir.empty() ? std::filesystem::temp_directory_path(ec) : std::filesystem::path(m_options.temp_dir);
+            if (ec) {
+                m_temp_parent = ".";
+            }
+            m_fill.reserve(_buffer_elems());
+            if (m_options.max_fan_in < 2) {
+                m_options.max_fan_in = 2;
+            }
+        }
+
+        external_sorter(external_sorter const&) = delete;
+        external_sorter& operator=(external_sorter const&) = delete;
+
+        // removes any runs left behind by a finish() that was never called or failed, and their directory
+        ~external_sorter() {
+            _join();
+            for (auto const& run : m_runs) {
+                std::remove(run.c_str());
+            }
+            _remove_temp_dir();
+        }
+
+        void push(T const& value) {
+            m_fill.push_back(value);
+            ++m_size;
+            if (m_fill.size() >= _buffer_elems()) {
+                _spill();
+            }
+        }
+
+        template <typename Values>
+        void push_all(Values const& values) {
+            auto const* p = values.data();
+            std::size_t n = static_cast<std::size_t>(values.size());
+            while (n != 0) {
+                const std::size_t room = _buffer_elems() - m_fill.size();
+                const std::size_t take = n < room ? n : room;
+                const std::size_t old = m_fill.size();
+                m_fill.resize_and_overwrite(old + take, [&](T* d, std::size_t size) {
+                    std::memcpy(d + old, p, take * sizeof(T));
+                    return size;
+                });
+                m_size += take;
+                p += take;
+                n -= take;
+                if (m_fill.size() >= _buffer_elems()) {
+                    _spill();
+                }
+            }
+        }
+
+        // pulls elements from read(dst, max), which returns how many it wrote and 0 once the input is done,
+        // straight into the sort buffer
+        template <typename Read>
+        void push_from(Read read) {
+            for (;;) {
+                const std::size_t old = m_fill.size();
+                std::size_t got = 0;
+                m_fill.resize_and_overwrite(_buffer_elems(), [&](T* d, std::size_t size) {
+                    got = static_cast<std::size_t>(read(d + old, size - old));
+                    return old + got;
+                });
+                m_size += got;
+                if (got == 0) {
+                    return;
+                }
+                if (m_fill.size() >= _buffer_elems()) {
+                    _spill();
+                }
+            }
+        }
+
+        // writes every pushed element, sorted, to a .npy file at out_path and deletes the runs; false on I/O failure
+        bool finish(char const* out_path) {
+            _join();
+            if (m_runs.is_empty() && !m_failed) {
+                std::sort(m_fill.begin(), m_fill.end(), m_cmp);
+                const bool ok = save_npy(out_path, m_fill);
+                m_fill.clear();
+                return ok;
+            }
+
+            if (!m_fill.is_empty()) {
+                std::swap(m_fill, m_sorting);
+                _write_run(_run_path());
+            }
+            m_fill = dyn_array<T>{};
+            m_sorting = dyn_array<T>{};
+            if (m_failed) {
+                return false;
+            }
+
+            // intermediate passes until one merge can take every run
+            while (m_runs.size() > m_options.max_fan_in) {
+                dyn_array<std::string> next;
+                for (std::size_t first = 0; first < m_runs.size(); first += m_options.max_fan_in) {
+                    const std::size_t last = std::min(first + m_options.max_fan_in, static_cast<std::size_t>(m_runs.size()));
+                    dyn_array<std::string> group(m_runs.begin() + first, m_runs.begin() + last);
+                    std::string path = _run_path();
+                    const bool ok = _merge(group, path);
+                    for (auto const& run : group) {
+                        std::remove(run.c_str());
+                    }
+                    if (!ok) {
+                        std::remove(path.c_str());
+                        for (std::size_t rest = last; rest < m_runs.size(); ++rest) {
+                            next.push_back(m_runs[rest]);
+                        }
+                        m_runs = std::move(next);
+                        return false;
+                    }
+                    next.push_back(std::move(path));
+                }
+                m_runs = std::move(next);
+            }
+
+            const bool ok = _merge(m_runs, out_path);
+            for (auto const& run : m_runs) {
+                std::remove(run.c_str());
+            }
+            m_runs.clear();
+            _remove_temp_dir();
+            return ok;
+        }
+
+        // elements pushed so far
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_size;
+        }
+
+        // runs spilled so far; the worker may still be writing the last one
+        dyn_array_always_inline size_type spilled_runs() const noexcept {
+            return m_next_run;
+        }
+    };
+
+    // sorts the .npy file at in_path into a new .npy file at out_path, holding about options.memory_budget
+    // bytes of elements at a time; false if the input is not a .npy of T or any I/O fails
+    template <typename T, typename Compare = std::less<T>>
+    bool external_sort_npy(char const* in_path, char const* out_path, external_sort_options options = {}, Compare cmp = Compare{}) {
+        std::FILE* in = std::fopen(in_path, "rb");
+        if (in == nullptr) {
+            return false;
+        }
+
+        npy_header h;
+        bool ok = detail::npy::read_header(in, h) && h.descr == detail::npy::descr<T>()
+            && std::fseek(in, static_cast<long>(h.data_offset), SEEK_SET) == 0;
+        if (ok) {
+            external_sorter<T, Compare> sorter(std::move(options), cmp);
+            std::size_t left = h.count();
+            sorter.push_from([&](T* dst, std::size_t max) -> std::size_t {
+                const std::size_t n = left < max ? left : max;
+                if (n != 0 && !detail::npy::read_all(in, dst, n * sizeof(T))) {
+                    ok = false;
+                    left = 0;
+                    return 0;
+                }
+                left -= n;
+                return n;
+            });
+            ok = ok && sorter.finish(out_path);
+        }
+
+        std::fclose(in);
+        return ok;
+    }
+}
+
+#endif
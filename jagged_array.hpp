@@ -0,0 +1,190 @@
+#ifndef JAGGED_ARRAY_HPP
+#define JAGGED_ARRAY_HPP
+
+#include <functional>
+#include <utility>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // rows of varying length packed CSR-style: one values array, row r spans [offsets[r], offsets[r + 1])
+    template <
+        typename T,
+        typename alloc_t = std::allocator<T>,
+        typename SizeT = std::size_t
+    >
+    class jagged_array {
+    public:
+
+        using value_type = T;
+        using allocator_type = alloc_t;
+        using size_type = SizeT;
+        using values_type = dyn_array<T, alloc_t, SizeT>;
+        using offsets_type = dyn_array<SizeT>;
+        using row_view = dyn_array_view<T, SizeT>;
+        using const_row_view = dyn_array_view<T const, SizeT>;
+
+    private:
+
+        values_type m_values;
+        offsets_type m_offsets{SizeT{0}};
+
+    public:
+
+        jagged_array() = default;
+
+        jagged_array(values_type values, offsets_type offsets)
+            : m_values{std::move(values)}
+            , m_offsets{std::move(offsets)} {
+            assert(!m_offsets.is_empty() && m_offsets.front() == 0 && m_offsets.back() == m_values.size());
+        }
+
+        // counting sort of (row, value) pairs; values keep their input order within a row
+        static jagged_array from_pairs(dyn_array<SizeT> const& row_of, values_type const& values, size_type row_count) {
+            assert(row_of.size() == values.size());
+
+            offsets_type offsets(static_cast<typename offsets_type::size_type>(row_count) + 1, SizeT{0});
+            for (auto r : row_of) {
+                assert(r < row_count);
+                ++offsets[r + 1];
+            }
+            for (size_type r = 0; r < row_count; ++r) {
+                offsets[r + 1] += offsets[r];
+            }
+
+            offsets_type cursor(offsets.begin(), offsets.end() - 1);
+            values_type sorted(values.size());
+            for (size_type i = 0; i < values.size(); ++i) {
+                sorted[cursor[row_of[i]]++] = values[i];
+            }
+
+            return jagged_array(std::move(sorted), std::move(offsets));
+        }
+
+        void reserve(size_type rows, size_type values) {
+            m_offsets.reserve(rows + 1);
+            m_values.reserve(values);
+        }
+
+        dyn_array_always_inline void push_row() {
+            m_offsets.push_back(m_values.size());
+        }
+
+        template <typename InIterator>
+        void push_row(InIterator f, InIterator l) {
+            for (; f != l; ++f) {
+                m_values.push_back(*f);
+            }
+            m_offsets.push_back(m_values.size());
+        }
+
+        dyn_array_always_inline void push_row(std::initializer_list<value_type> il) {
+            push_row(il.begin(), il.end());
+        }
+
+        // row may be one of this array's own rows, whose storage an append can move, so those are copied by index
+        void push_row(const_row_view row) {
+            const std::less<T const*> before;
+            const T* values = m_values.data();
+            if (row.is_empty() || before(row.data(), values) || !before(row.data(), values + m_values.size())) {
+                push_row(row.begin(), row.end());
+                return;
+            }
+            const auto f = static_cast<size_type>(row.data() - values);
+            for (size_type i = 0; i < row.size(); ++i) {
+                T value = m_values[f + i];
+                m_values.push_back(std::move(value));
+            }
+            m_offsets.push_back(m_values.size());
+        }
+
+        // appends to the last row
+        void push_back(T const& value) {
+            assert(rows() > 0);
+            m_values.push_back(value);
+            ++m_offsets.back();
+        }
+
+        void push_back(T&& value) {
+            assert(rows() > 0);
+            m_values.push_back(std::move(value));
+            ++m_offsets.back();
+        }
+
+        template <typename... Types>
+        void emplace_back(Types&&... args) {
+            assert(rows() > 0);
+            m_values.emplace_back(std::forward<Types>(args)...);
+            ++m_offsets.back();
+        }
+
+        dyn_array_always_inline row_view operator[](size_type r) noexcept {
+            assert(r < rows());
+            return row_view(m_values.data() + m_offsets[r], m_offsets[r + 1] - m_offsets[r]);
+        }
+
+        dyn_array_always_inline const_row_view operator[](size_type r) const noexcept {
+            assert(r < rows());
+            return const_row_view(m_values.data() + m_offsets[r], m_offsets[r + 1] - m_offsets[r]);
+        }
+
+        dyn_array_always_inline size_type row_size(size_type r) const noexcept {
+            assert(r < rows());
+            return m_offsets[r + 1] - m_offsets[r];
+        }
+
+        // drops values for which pred(row, value) holds in a single forward pass
+        template <typename Pred>
+        void remove_if(Pred pred) {
+            size_type out = 0;
+            size_type f = 0;
+            for (size_type r = 0; r < rows(); ++r) {
+                const size_type l = m_offsets[r + 1];
+                for (; f < l; ++f) {
+                    if (!pred(r, static_cast<T const&>(m_values[f]))) {
+                        if (out != f) {
+                            m_values[out] = std::move(m_values[f]);
+                        }
+                        ++out;
+                    }
+                }
+                m_offsets[r + 1] = out;
+            }
+            m_values.resize(out);
+        }
+
+        void shrink_to_fit() {
+            m_values.shrink_to_fit();
+            m_offsets.shrink_to_fit();
+        }
+
+        void clear() {
+            m_values.clear();
+            m_offsets.clear();
+            m_offsets.push_back(0);
+        }
+
+        dyn_array_always_inline values_type const& values() const noexcept {
+            return m_values;
+        }
+
+        dyn_array_always_inline offsets_type const& offsets() const noexcept {
+            return m_offsets;
+        }
+
+        dyn_array_always_inline size_type rows() const noexcept {
+            return m_offsets.size() - 1;
+        }
+
+        dyn_array_always_inline size_type size() const noexcept { // total number of values
+            return m_values.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return rows() == 0;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,489 @@
+#ifndef NPY_HPP
+#define NPY_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "dyn_array.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define DYN_ARRAY_NPY_POSIX 1
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+namespace cz {
+
+    struct npy_header {
+        std::string descr;
+        bool fortran_order = false;
+        dyn_array<std::size_t> shape;
+        std::size_t data_offset = 0; // bytes from the start of the file
+
+        std::size_t count() const noexcept {
+            std::size_t n = 1;
+            for (auto e : shape) {
+                n *= e;
+            }
+            return n;
+        }
+
+        // element order matches C order: not fortran_order, or at most one dimension longer than 1
+        bool is_row_major() const noexcept {
+            std::size_t long_dims = 0;
+            for (auto e : shape) {
+                long_dims += e > 1;
+            }
+            return !fortran_order || long_dims <= 1;
+        }
+    };
+
+    namespace detail {
+        namespace npy {
+            constexpr char magic[] = "\x93NUMPY";
+            constexpr std::size_t magic_size = 6;
+            constexpr std::size_t alignment = 64;
+            constexpr std::size_t max_header_len = std::size_t{1} << 20; // numpy itself writes a few hundred bytes
+
+            inline bool host_is_little_endian() noexcept {
+                const std::uint16_t probe = 1;
+                unsigned char b;
+                std::memcpy(&b, &probe, 1);
+                return b == 1;
+            }
+
+            // numpy dtype string for T in host byte order, e.g. "<f4"; empty if T has no dtype
+            template <typename T>
+            std::string descr() {
+                char kind;
+                if constexpr (std::is_same<T, bool>::value) {
+                    kind = 'b';
+                } else if constexpr (std::is_floating_point<T>::value) {
+                    kind = 'f';
+                } else if constexpr (std::is_integral<T>::value) {
+                    kind = std::is_signed<T>::value ? 'i' : 'u';
+                } else {
+                    return {};
+                }
+                const char order = sizeof(T) == 1 ? '|' : (host_is_little_endian() ? '<' : '>');
+                return std::string{order, kind} + std::to_string(sizeof(T));
+            }
+
+            inline char const* skip_space(char const* p, char const* e) noexcept {
+                while (p != e && (*p == ' ' || *p == '\t')) {
+                    ++p;
+                }
+                return p;
+            }
+
+            inline char const* find_key(char const* p, char const* e, char const* key) noexcept {
+                const std::size_t len = std::strlen(key);
+                for (; p + len <= e; ++p) {
+                    if (std::memcmp(p, key, len) == 0) {
+                        p = skip_space(p + len, e);
+                        return p != e && *p == ':' ? skip_space(p + 1, e) : nullptr;
+                    }
+                }
+                return nullptr;
+            }
+
+            // parses the preamble and header dict at the start of a .npy image
+            inline bool parse_header(char const* data, std::size_t size, npy_header& out) {
+                if (size < magic_size + 4 || std::memcmp(data, magic, magic_size) != 0) {
+                    return false;
+                }
+
+                const unsigned char major = static_cast<unsigned char>(data[6]);
+                std::size_t header_len;
+                std::size_t preamble;
+                if (major == 1) {
+                    header_len = static_cast<unsigned char>(data[8]) | static_cast<std::size_t>(static_cast<unsigned char>(data[9])) << 8;
+                    preamble = 10;
+                } else if (major == 2 || major == 3) {
+                    if (size < 12) {
+                        return false;
+                    }
+                    header_len = 0;
+                    for (int i = 3; i >= 0; --i) {
+                        header_len = header_len << 8 | static_cast<unsigned char>(data[8 + i]);
+                    }
+                    preamble = 12;
+                } else {
+                    return false;
+                }
+
+                if (preamble + header_len > size) {
+                    return false;
+                }
+
+                char const* p = data + preamble;
+                char const* e = p + header_len;
+
+                char const* v = find_key(p, e, "'descr'");
+                if (v == nullptr || *v != '\'') {
+                    return false;
+                }
+                char const* q = static_cast<char const*>(std::memchr(v + 1, '\'', static_cast<std::size_t>(e - v - 1)));
+                if (q == nullptr) {
+                    return false;
+                }
+                out.descr.assign(v + 1, q);
+
+                v = find_key(p, e, "'fortran_order'");
+                if (v == nullptr) {
+                    return false;
+                }
+                out.fortran_order = e - v >= 4 && std::memcmp(v, "True", 4) == 0;
+
+                v = find_key(p, e, "'shape'");
+                if (v == nullptr || *v != '(') {
+                    return false;
+                }
+                out.shape.clear();
+                for (++v;;) {
+                    v = skip_space(v, e);
+                    if (v == e) {
+                        return false;
+                    }
+                    if (*v == ')') {
+                        break;
+                    }
+                    if (*v == ',') {
+                        ++v;
+                        continue;
+                    }
+                    if (*v < '0' || *v > '9') {
+                        return false;
+                    }
+                    std::size_t dim = 0;
+                    for (; v != e && *v >= '0' && *v <= '9'; ++v) {
+                        const auto digit = static_cast<std::size_t>(*v - '0');
+                        if (dim > (SIZE_MAX - digit) / 10) {
+                            return false;
+                        }
+                        dim = dim * 10 + digit;
+                    }
+                    out.shape.push_back(dim);
+                }
+
+                out.data_offset = preamble + header_len;
+                return true;
+            }
+
+            // version 1.0 preamble plus dict, space padded so the data starts on a 64-byte boundary
+            inline std::string make_header(std::string const& descr, dyn_array<std::size_t> const& shape) {
+                std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+                for (std::size_t i = 0; i < shape.size(); ++i) {
+                    dict += i == 0 ? "" : ", ";
+                    dict += std::to_string(shape[i]);
+                }
+                dict += shape.size() == 1 ? ",)" : ")"; // one-element tuples need the trailing comma
+                dict += ", }";
+
+                const std::size_t unpadded = 10 + dict.size() + 1;
+                dict.append((alignment - unpadded % alignment) % alignment, ' ');
+                dict += '\n';
+
+                std::string header(magic, magic_size);
+                header += '\x01';
+                header += '\x00';
+                header += static_cast<char>(dict.size() & 0xff);
+                header += static_cast<char>(dict.size() >> 8);
+                return header + dict;
+            }
+
+            inline bool read_all(std::FILE* f, void* dst, std::size_t n) {
+                return n == 0 || std::fread(dst, 1, n, f) == n;
+            }
+
+            // bytes of data described by h for elements of elem_size, nullopt if the shape's product overflows
+            inline std::optional<std::size_t> data_size(npy_header const& h, std::size_t elem_size) noexcept {
+                std::size_t n = elem_size;
+                for (auto e : h.shape) {
+                    if (e != 0 && n > SIZE_MAX / e) {
+                        return std::nullopt;
+                    }
+                    n *= e;
+                }
+                return n;
+            }
+
+            // reads and parses the preamble and header dict at the current position of f, leaving f at the data.
+            // The preamble is validated before the header length read from it sizes anything
+            inline bool read_header(std::FILE* f, npy_header& h) {
+                unsigned char preamble[12];
+                if (!read_all(f, preamble, sizeof(preamble)) || std::memcmp(preamble, magic, magic_size) != 0) {
+                    return false;
+                }
+                const unsigned char major = preamble[6];
+                std::size_t header_len = preamble[8] | static_cast<std::size_t>(preamble[9]) << 8;
+                if (major == 1) {
+                    header_len += 10;
+                } else if (major == 2 || major == 3) {
+                    header_len = (header_len | static_cast<std::size_t>(preamble[10]) << 16 | static_cast<std::size_t>(preamble[11]) << 24) + 12;
+                } else {
+                    return false;
+                }
+                if (header_len > max_header_len) {
+                    return false;
+                }
+
+                std::string image(reinterpret_cast<char const*>(preamble), sizeof(preamble));
+                image.resize(header_len < sizeof(preamble) ? sizeof(preamble) : header_len);
+                return read_all(f, &image[sizeof(preamble)], image.size() - sizeof(preamble))
+                    && parse_header(image.data(), image.size(), h);
+            }
+
+            // bytes from the current position of f to its end, restoring the position
+            inline std::optional<std::size_t> remaining(std::FILE* f) {
+                const long pos = std::ftell(f);
+                if (pos < 0 || std::fseek(f, 0, SEEK_END) != 0) {
+                    return std::nullopt;
+                }
+                const long end = std::ftell(f);
+                if (end < pos || std::fseek(f, pos, SEEK_SET) != 0) {
+                    return std::nullopt;
+                }
+                return static_cast<std::size_t>(end - pos);
+            }
+        }
+    }
+
+    // writes arr as a .npy file with the given shape (defaults to one dimension), header and data in one gathered write
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    bool save_npy(char const* path, dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& arr, dyn_array<std::size_t> shape = {}) {
+        static_assert(std::is_arithmetic<T>::value, "npy files hold arithmetic element types");
+
+        if (shape.is_empty()) {
+            shape.push_back(static_cast<std::size_t>(arr.size()));
+        }
+
+        npy_header check;
+        check.shape = shape;
+        if (check.count() != static_cast<std::size_t>(arr.size())) {
+            return false;
+        }
+
+        const std::string header = detail::npy::make_header(detail::npy::descr<T>(), shape);
+        const std::size_t data_bytes = sizeof(T) * static_cast<std::size_t>(arr.size());
+
+#ifdef DYN_ARRAY_NPY_POSIX
+        const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        iovec iov[2] = {
+            {const_cast<char*>(header.data()), header.size()},
+            {const_cast<T*>(arr.data()), data_bytes}
+        };
+        int first = 0;
+        bool ok = true;
+        while (first < 2) {
+            const ssize_t written = ::writev(fd, iov + first, 2 - first);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written < 0) {
+                ok = false;
+                break;
+            }
+            auto left = static_cast<std::size_t>(written);
+            while (first < 2 && left >= iov[first].iov_len) {
+                left -= iov[first].iov_len;
+                ++first;
+            }
+            if (first < 2) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                iov[first].iov_len -= left;
+            }
+        }
+        return ::close(fd) == 0 && ok;
+#else
+        std::FILE* f = std::fopen(path, "wb");
+        if (f == nullptr) {
+            return false;
+        }
+        bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+        ok = ok && (data_bytes == 0 || std::fwrite(arr.data(), 1, data_bytes, f) == data_bytes);
+        return std::fclose(f) == 0 && ok;
+#endif
+    }
+
+    // dyn_array whose storage starts on a 64-byte boundary, for loading columns that the SIMD kernels will scan
+    template <typename T>
+    using npy_array = dyn_array<T, detail::aligned_allocator<T, 64>>;
+
+    // bulk-reads a .npy file whose dtype matches T into out; the shape is reported through header. out is left
+    // untouched on failure, which includes column-major files. Its allocator decides the alignment of the data;
+    // pass an npy_array when that matters
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    bool load_npy(char const* path, dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& out, npy_header* header = nullptr) {
+        static_assert(std::is_arithmetic<T>::value, "npy files hold arithmetic element types");
+
+        std::FILE* f = std::fopen(path, "rb");
+        if (f == nullptr) {
+            return false;
+        }
+
+        // the shape is untrusted: nothing is allocated until the file is known to hold that much data
+        npy_header h;
+        bool ok = detail::npy::read_header(f, h) && h.descr == detail::npy::descr<T>() && h.is_row_major()
+            && std::fseek(f, static_cast<long>(h.data_offset), SEEK_SET) == 0;
+        const auto bytes = ok ? detail::npy::data_size(h, sizeof(T)) : std::nullopt;
+        const auto available = bytes ? detail::npy::remaining(f) : std::nullopt;
+        ok = available && *bytes <= *available && h.count() <= static_cast<std::size_t>(std::numeric_limits<SizeT>::max());
+
+        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> values(out.get_allocator());
+        if (ok) {
+            values.resize_and_overwrite(static_cast<SizeT>(h.count()), [&](T* p, SizeT n) {
+                ok = detail::npy::read_all(f, p, *bytes);
+                return ok ? n : SizeT(0);
+            });
+        }
+
+        std::fclose(f);
+        if (ok) {
+            out = std::move(values);
+            if (header != nullptr) {
+                *header = std::move(h);
+            }
+        }
+        return ok;
+    }
+
+#ifdef DYN_ARRAY_NPY_POSIX
+    // read-only, zero-copy view of a memory-mapped .npy file
+    template <typename T, typename SizeT = std::size_t>
+    class npy_mapped {
+
+        static_assert(std::is_arithmetic<T>::value, "npy files hold arithmetic element types");
+
+    public:
+
+        using view_type = dyn_array_view<T const, SizeT>;
+        using size_type = SizeT;
+
+    private:
+
+        void* m_map = nullptr;
+        std::size_t m_map_size = 0;
+        npy_header m_header;
+        view_type m_view;
+
+        npy_mapped() = default;
+
+    public:
+
+        // nullopt when the file cannot be mapped, is not a .npy, is column-major, or its dtype is not T
+        static std::optional<npy_mapped> open(char const* path) {
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return std::nullopt;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                return std::nullopt;
+            }
+
+            const auto size = static_cast<std::size_t>(st.st_size);
+            void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED) {
+                return std::nullopt;
+            }
+
+            npy_mapped m;
+            m.m_map = map;
+            m.m_map_size = size;
+            if (!detail::npy::parse_header(static_cast<char const*>(map), size, m.m_header)
+                || m.m_header.descr != detail::npy::descr<T>()
+                || !m.m_header.is_row_major()
+                || m.m_header.data_offset % alignof(T) != 0) {
+                return std::nullopt;
+            }
+            const auto bytes = detail::npy::data_size(m.m_header, sizeof(T));
+            if (!bytes || *bytes > size - m.m_header.data_offset
+                || m.m_header.count() > static_cast<std::size_t>(std::numeric_limits<SizeT>::max())) {
+                return std::nullopt;
+            }
+
+            ::madvise(map, size, MADV_SEQUENTIAL);
+            m.m_view = view_type(reinterpret_cast<T const*>(static_cast<char const*>(map) + m.m_header.data_offset), static_cast<size_type>(m.m_header.count()));
+            return std::optional<npy_mapped>(std::move(m));
+        }
+
+        npy_mapped(npy_mapped&& other) noexcept
+            : m_map{other.m_map}
+            , m_map_size{other.m_map_size}
+            , m_header{std::move(other.m_header)}
+            , m_view{other.m_view} {
+            other.m_map = nullptr;
+            other.m_view = view_type();
+        }
+
+        npy_mapped& operator=(npy_mapped&& other) noexcept {
+            assert(this != &other);
+            if (m_map != nullptr) {
+                ::munmap(m_map, m_map_size);
+            }
+            m_map = other.m_map;
+            m_map_size = other.m_map_size;
+            m_header = std::move(other.m_header);
+            m_view = other.m_view;
+            other.m_map = nullptr;
+            other.m_view = view_type();
+            return *this;
+        }
+
+        npy_mapped(npy_mapped const&) = delete;
+        npy_mapped& operator=(npy_mapped const&) = delete;
+
+        ~npy_mapped() {
+            if (m_map != nullptr) {
+                ::munmap(m_map, m_map_size);
+            }
+        }
+
+        dyn_array_always_inline T const& operator[](size_type idx) const noexcept {
+            return m_view[idx];
+        }
+
+        dyn_array_always_inline view_type view() const noexcept {
+            return m_view;
+        }
+
+        dyn_array_always_inline npy_header const& header() const noexcept {
+            return m_header;
+        }
+
+        dyn_array_always_inline T const* data() const noexcept {
+            return m_view.data();
+        }
+
+        dyn_array_always_inline T const* begin() const noexcept {
+            return m_view.begin();
+        }
+
+        dyn_array_always_inline T const* end() const noexcept {
+            return m_view.end();
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_view.size();
+        }
+    };
+#endif
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef NULLABLE_COLUMN_HPP
+#define NULLABLE_COLUMN_HPP
+
+#include <cstdint>
+#include <optional>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // values plus a validity bitmap laid out like Apache Arrow's: bit i of byte i / 8,
+    // least significant bit first, set when slot i holds a value; null slots keep a T{} placeholder
+    template <
+        typename T,
+        typename alloc_t = std::allocator<T>,
+        typename SizeT = std::size_t
+    >
+    class nullable_column {
+
+        static_assert(std::is_default_constructible<T>::value);
+
+    public:
+
+        using value_type = T;
+        using size_type = SizeT;
+        using values_type = dyn_array<T, alloc_t, SizeT>;
+        using bitmap_type = dyn_array<std::uint8_t, std::allocator<std::uint8_t>, SizeT>;
+        using selection_type = dyn_array<SizeT>;
+
+    private:
+
+        values_type m_values;
+        bitmap_type m_validity;
+        size_type m_null_count = 0;
+
+        dyn_array_always_inline void _set_bit(size_type i, bool valid) noexcept {
+            const std::uint8_t mask = static_cast<std::uint8_t>(1u << (i % 8));
+            if (valid) {
+                m_validity[i / 8] |= mask;
+            } else {
+                m_validity[i / 8] &= static_cast<std::uint8_t>(~mask);
+            }
+        }
+
+        void _grow_bitmap() {
+            if (m_values.size() % 8 == 0) {
+                m_validity.push_back(0);
+            }
+        }
+
+        // validity of slots [64 * w, 64 * w + 64), bits past size() cleared
+        dyn_array_always_inline std::uint64_t _word(size_type w) const noexcept {
+            std::uint64_t bits = 0;
+            const size_type byte = w * 8;
+            const size_type n = std::min<size_type>(8, m_validity.size() - byte);
+            std::memcpy(&bits, m_validity.data() + byte, n);
+            const size_type left = m_values.size() - w * 64;
+            if (left < 64) {
+                bits &= (std::uint64_t{1} << left) - 1;
+            }
+            return bits;
+        }
+
+        // calls f(base, count, bits) per run of up to 64 slots
+        template <typename F>
+        void _for_each_word(F f) const {
+            const size_type n = m_values.size();
+            for (size_type w = 0; w * 64 < n; ++w) {
+                const size_type base = w * 64;
+                f(base, std::min<size_type>(64, n - base), _word(w));
+            }
+        }
+
+        template <typename Pick>
+        std::optional<T> _reduce(Pick pick) const {
+            std::optional<T> out;
+            _for_each_word([&](size_type base, size_type, std::uint64_t bits) {
+                for (; bits != 0; bits &= bits - 1) {
+                    const T& v = m_values[base + detail::bits::ctz64(bits)];
+                    out = out ? pick(*out, v) : v;
+                }
+            });
+            return out;
+        }
+
+    public:
+
+        nullable_column() = default;
+
+        // all slots valid
+        explicit nullable_column(values_type values)
+            : m_values{std::move(values)}
+            , m_validity((m_values.size() + 7) / 8, std::uint8_t{0xff}) {
+        }
+
+        void reserve(size_type n) {
+            m_values.reserve(n);
+            m_validity.reserve((n + 7) / 8);
+        }
+
+        void push_back(T const& value) {
+            _grow_bitmap();
+            m_values.push_back(value);
+            _set_bit(m_values.size() - 1, true);
+        }
+
+        void push_back(std::nullopt_t) {
+            _grow_bitmap();
+            m_values.emplace_back();
+            _set_bit(m_values.size() - 1, false);
+            ++m_null_count;
+        }
+
+        void push_back(std::optional<T> const& value) {
+            if (value) {
+                push_back(*value);
+            } else {
+                push_back(std::nullopt);
+            }
+        }
+
+        void set(size_type i, T const& value) {
+            assert(i < size());
+            if (is_null(i)) {
+                --m_null_count;
+            }
+            m_values[i] = value;
+            _set_bit(i, true);
+        }
+
+        void set_null(size_type i) {
+            assert(i < size());
+            if (is_valid(i)) {
+                ++m_null_count;
+            }
+            m_values[i] = T{};
+            _set_bit(i, false);
+        }
+
+        dyn_array_always_inline bool is_valid(size_type i) const noexcept {
+            assert(i < size());
+            return (m_validity[i / 8] >> (i % 8) & 1) != 0;
+        }
+
+        dyn_array_always_inline bool is_null(size_type i) const noexcept {
+            return !is_valid(i);
+        }
+
+        dyn_array_always_inline T const& value(size_type i) const noexcept {
+            assert(is_valid(i));
+            return m_values[i];
+        }
+
+        dyn_array_always_inline std::optional<T> operator[](size_type i) const {
+            return is_valid(i) ? std::optional<T>(m_values[i]) : std::nullopt;
+        }
+
+        // null slots contribute nothing; fully valid words take a branch-free pass the compiler vectorizes
+        T sum() const {
+            T acc{};
+            _for_each_word([&](size_type base, size_type count, std::uint64_t bits) {
+                T const* p = m_values.data() + base;
+                if (bits == ~std::uint64_t{0}) {
+                    for (size_type k = 0; k < 64; ++k) {
+                        acc += p[k];
+                    }
+                } else if (bits != 0) {
+                    for (size_type k = 0; k < count; ++k) {
+                        acc += (bits >> k & 1) ? p[k] : T{};
+                    }
+                }
+            });
+            return acc;
+        }
+
+        std::optional<T> min() const {
+            return _reduce([](T const& a, T const& b) { return b < a ? b : a; });
+        }
+
+        std::optional<T> max() const {
+            return _reduce([](T const& a, T const& b) { return a < b ? b : a; });
+        }
+
+        dyn_array_always_inline size_type count_valid() const noexcept {
+            return m_values.size() - m_null_count;
+        }
+
+        // indexes of valid slots whose value satisfies pred
+        template <typename Pred>
+        selection_type filter(Pred pred) const {
+            selection_type sel;
+            sel.reserve(count_valid());
+            _for_each_word([&](size_type base, size_type, std::uint64_t bits) {
+                for (; bits != 0; bits &= bits - 1) {
+                    const size_type i = base + detail::bits::ctz64(bits);
+                    if (pred(m_values[i])) {
+                        sel.push_back(i);
+                    }
+                }
+            });
+            return sel;
+        }
+
+        selection_type valid_indexes() const {
+            selection_type sel;
+            sel.reserve(count_valid());
+            _for_each_word([&](size_type base, size_type, std::uint64_t bits) {
+                for (; bits != 0; bits &= bits - 1) {
+                    sel.push_back(base + detail::bits::ctz64(bits));
+                }
+            });
+            return sel;
+        }
+
+        selection_type null_indexes() const {
+            selection_type sel;
+            sel.reserve(m_null_count);
+            _for_each_word([&](size_type base, size_type count, std::uint64_t bits) {
+                bits = ~bits & (count == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << count) - 1);
+                for (; bits != 0; bits &= bits - 1) {
+                    sel.push_back(base + detail::bits::ctz64(bits));
+                }
+            });
+            return sel;
+        }
+
+        void clear() {
+            m_values.clear();
+            m_validity.clear();
+            m_null_count = 0;
+        }
+
+        dyn_array_always_inline values_type const& values() const noexcept {
+            return m_values;
+        }
+
+        dyn_array_always_inline bitmap_type const& validity() const noexcept {
+            return m_validity;
+        }
+
+        dyn_array_always_inline size_type null_count() const noexcept {
+            return m_null_count;
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_values.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_values.is_empty();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstdint>
+#include <new>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    namespace detail {
+        namespace pool {
+            constexpr std::size_t ceil_pow2(std::size_t n) noexcept {
+                std::size_t p = 1;
+                while (p < n) {
+                    p *= 2;
+                }
+                return p;
+            }
+        }
+    }
+
+    // fixed-size chunks of slots that are never moved, so pointers stay valid until destroy();
+    // free slots are chained through their own storage and a bitmap records which slots are live.
+    // Slot 0 of every chunk is a header holding the chunk's index, reached by masking a pointer
+    // with the chunk alignment, which makes destroy() O(1) without per-object bookkeeping
+    template <
+        typename T,
+        std::size_t ChunkSize = 256,
+        typename SizeT = std::size_t
+    >
+    class object_pool {
+
+        static_assert(ChunkSize >= 64 && ChunkSize % 64 == 0);
+
+    public:
+
+        using value_type = T;
+        using size_type = SizeT;
+
+    private:
+
+        union slot {
+            slot* next;
+            std::size_t chunk;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        // every slot address masks down to its chunk's first slot
+        static constexpr std::size_t _chunk_align = detail::pool::ceil_pow2(ChunkSize * sizeof(slot));
+
+        using chunk_type = dyn_array<slot, detail::aligned_allocator<slot, _chunk_align>, SizeT>;
+
+        dyn_array<chunk_type> m_chunks;
+        dyn_array<std::uint64_t> m_live; // bit c * ChunkSize + i for slot i of chunk c
+        slot* m_free = nullptr;
+        size_type m_size = 0;
+
+        // global slot number of p
+        dyn_array_always_inline std::size_t _locate(void const* p) const noexcept {
+            const auto addr = reinterpret_cast<std::uintptr_t>(p);
+            const auto base = addr & ~static_cast<std::uintptr_t>(_chunk_align - 1);
+            const std::size_t chunk = reinterpret_cast<slot const*>(base)->chunk;
+            assert(chunk < m_chunks.size() && reinterpret_cast<std::uintptr_t>(m_chunks[chunk].data()) == base && "pointer not from this pool");
+            return chunk * ChunkSize + (addr - base) / sizeof(slot);
+        }
+
+        void _add_chunk() {
+            const std::size_t c = m_chunks.size();
+            m_chunks.emplace_back(static_cast<SizeT>(ChunkSize));
+            m_live.resize(m_live.size() + ChunkSize / 64);
+
+            slot* s = m_chunks.back().data();
+            assert(reinterpret_cast<std::uintptr_t>(s) % _chunk_align == 0);
+            s[0].chunk = c;
+            for (std::size_t i = 1; i + 1 < ChunkSize; ++i) {
+                s[i].next = s + i + 1;
+            }
+            s[ChunkSize - 1].next = m_free;
+            m_free = s + 1;
+        }
+
+        dyn_array_always_inline T* _object(std::size_t global) noexcept {
+            return std::launder(reinterpret_cast<T*>(m_chunks[global / ChunkSize].data()[global % ChunkSize].storage));
+        }
+
+        dyn_array_always_inline T const* _object(std::size_t global) const noexcept {
+            return std::launder(reinterpret_cast<T const*>(m_chunks[global / ChunkSize].data()[global % ChunkSize].storage));
+        }
+
+        void _destroy_live() {
+            if constexpr (!std::is_trivially_destructible<T>::value) {
+                for_each([](T& obj) { obj.~T(); });
+            }
+        }
+
+    public:
+
+        object_pool() = default;
+
+        object_pool(object_pool const&) = delete;
+        object_pool& operator=(object_pool const&) = delete;
+
+        object_pool(object_pool&& other) noexcept
+            : m_chunks{std::move(other.m_chunks)}
+            , m_live{std::move(other.m_live)}
+            , m_free{other.m_free}
+            , m_size{other.m_size} {
+            other.m_free = nullptr;
+            other.m_size = 0;
+        }
+
+        object_pool& operator=(object_pool&& other) noexcept {
+            assert(this != &other);
+            _destroy_live();
+            m_chunks = std::move(other.m_chunks);
+            m_live = std::move(other.m_live);
+            m_free = other.m_free;
+            m_size = other.m_size;
+            other.m_free = nullptr;
+            other.m_size = 0;
+            return *this;
+        }
+
+        ~object_pool() {
+            _destroy_live();
+        }
+
+        // adds chunks until n objects fit without further allocation
+        void reserve(size_type n) {
+            while (capacity() < n) {
+                _add_chunk();
+            }
+        }
+
+        template <typename... Types>
+        T* create(Types&&... args) {
+            if (m_free == nullptr) {
+                _add_chunk();
+            }
+
+            slot* s = m_free;
+            slot* next = s->next; // read before the object overwrites it
+            T* obj = ::new (static_cast<void*>(s->storage)) T(std::forward<Types>(args)...);
+            m_free = next;
+
+            const std::size_t g = _locate(s);
+            m_live[g / 64] |= std::uint64_t{1} << (g % 64);
+            ++m_size;
+            return obj;
+        }
+
+        void destroy(T* obj) {
+            const std::size_t g = _locate(obj);
+            assert((m_live[g / 64] >> (g % 64) & 1) != 0 && "object already destroyed");
+            obj->~T();
+            m_live[g / 64] &= ~(std::uint64_t{1} << (g % 64));
+
+            slot* s = reinterpret_cast<slot*>(obj);
+            s->next = m_free;
+            m_free = s;
+            --m_size;
+        }
+
+        // calls f(T&) on every live object in slot order, walking the bitmap a word at a time
+        template <typename F>
+        void for_each(F f) {
+            for (std::size_t w = 0; w < m_live.size(); ++w) {
+                for (std::uint64_t bits = m_live[w]; bits != 0; bits &= bits - 1) {
+                    f(*_object(w * 64 + detail::bits::ctz64(bits)));
+                }
+            }
+        }
+
+        template <typename F>
+        void for_each(F f) const {
+            for (std::size_t w = 0; w < m_live.size(); ++w) {
+                for (std::uint64_t bits = m_live[w]; bits != 0; bits &= bits - 1) {
+                    f(*_object(w * 64 + detail::bits::ctz64(bits)));
+                }
+            }
+        }
+
+        // destroys every object; the chunks stay allocated and all their slots become free
+        void clear() {
+            _destroy_live();
+            m_live.fill(0);
+            m_free = nullptr;
+            for (std::size_t c = m_chunks.size(); c-- > 0;) {
+                slot* s = m_chunks[c].data();
+                for (std::size_t i = 1; i + 1 < ChunkSize; ++i) {
+                    s[i].next = s + i + 1;
+                }
+                s[ChunkSize - 1].next = m_free;
+                m_free = s + 1;
+            }
+            m_size = 0;
+        }
+
+        dyn_array_always_inline bool is_live(T const* obj) const noexcept {
+            const std::size_t g = _locate(obj);
+            return (m_live[g / 64] >> (g % 64) & 1) != 0;
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_size;
+        }
+
+        dyn_array_always_inline size_type capacity() const noexcept {
+            return static_cast<size_type>(m_chunks.size() * (ChunkSize - 1));
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_size == 0;
+        }
+    };
+}
+
+#endif
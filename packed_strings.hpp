@@ -0,0 +1,297 @@
+#ifndef PACKED_STRINGS_HPP
+#define PACKED_STRINGS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // variable-length strings in one byte arena; each string is stored as a LEB128 length followed by
+    // its bytes, and the offsets array holds one arena position per string, so reordering the strings
+    // only touches the offsets. While the arena is in index order (after push_back or compact, not after
+    // sort) find and find_prefix stream over the arena with the SIMD byte search instead of visiting
+    // every string
+    template <
+        typename OffsetT = std::uint32_t,
+        typename alloc_t = std::allocator<char>,
+        typename SizeT = std::size_t
+    >
+    class packed_strings {
+
+        static_assert(std::is_unsigned<OffsetT>::value);
+
+    public:
+
+        using value_type = std::string_view;
+        using size_type = SizeT;
+        using offset_type = OffsetT;
+        using arena_type = dyn_array<char, alloc_t, SizeT>;
+        using offsets_type = dyn_array<OffsetT, std::allocator<OffsetT>, SizeT>;
+
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        class const_iterator {
+            friend class packed_strings;
+
+            packed_strings const* m_owner;
+            size_type m_idx;
+
+            const_iterator(packed_strings const* owner, size_type idx) noexcept
+                : m_owner{owner}
+                , m_idx{idx} {
+            }
+
+        public:
+
+            dyn_array_always_inline std::string_view operator*() const noexcept {
+                return (*m_owner)[m_idx];
+            }
+
+            dyn_array_always_inline const_iterator& operator++() noexcept {
+                ++m_idx;
+                return *this;
+            }
+
+            dyn_array_always_inline bool operator==(const_iterator const& other) const noexcept {
+                return m_idx == other.m_idx;
+            }
+
+            dyn_array_always_inline bool operator!=(const_iterator const& other) const noexcept {
+                return m_idx != other.m_idx;
+            }
+        };
+
+    private:
+
+        arena_type m_arena;
+        offsets_type m_offsets;
+        size_type m_dead = 0;   // arena bytes no offset refers to any more
+        bool m_in_order = true; // offsets ascend and the arena holds nothing but the strings, back to back
+
+        static std::size_t _encode_length(std::size_t len, unsigned char* out) noexcept {
+            std::size_t n = 0;
+            do {
+                const unsigned char b = static_cast<unsigned char>(len & 0x7f);
+                len >>= 7;
+                out[n++] = len != 0 ? b | 0x80 : b;
+            } while (len != 0);
+            return n;
+        }
+
+        // index of the string whose encoding covers arena position pos; needs m_in_order
+        size_type _covering(std::size_t pos) const noexcept {
+            const auto it = std::upper_bound(m_offsets.begin(), m_offsets.end(), pos, [](std::size_t p, offset_type off) {
+                return p < static_cast<std::size_t>(off);
+            });
+            return static_cast<size_type>(it - m_offsets.begin()) - 1;
+        }
+
+        // walks the arena positions where needle occurs, in order, and returns the index of the first string
+        // accept(index, position) takes; needs m_in_order so arena order is index order
+        template <typename Accept>
+        size_type _scan(unsigned char const* needle, std::size_t k, Accept accept) const noexcept {
+            auto const* arena = reinterpret_cast<std::uint8_t const*>(m_arena.data());
+            const std::size_t n = static_cast<std::size_t>(m_arena.size());
+            for (std::size_t from = static_cast<std::size_t>(m_offsets[0]); from < n;) {
+                const std::size_t hit = from + detail::simd::find_bytes(arena + from, n - from, needle, k);
+                if (hit >= n) {
+                    break;
+                }
+                const size_type i = _covering(hit);
+                if (accept(i, hit)) {
+                    return i;
+                }
+                from = hit + 1;
+            }
+            return npos;
+        }
+
+        dyn_array_always_inline std::string_view _at(offset_type off) const noexcept {
+            auto p = reinterpret_cast<unsigned char const*>(m_arena.data()) + off;
+            std::size_t len = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const unsigned char b = *p++;
+                len |= static_cast<std::size_t>(b & 0x7f) << shift;
+                if ((b & 0x80) == 0) {
+                    break;
+                }
+            }
+            return std::string_view(reinterpret_cast<char const*>(p), len);
+        }
+
+    public:
+
+        packed_strings() = default;
+
+        void reserve(size_type strings, size_type bytes) {
+            m_offsets.reserve(strings);
+            m_arena.reserve(bytes + strings);
+        }
+
+        // false, leaving the container unchanged, when the string would start past what offset_type can address
+        bool push_back(std::string_view s) {
+            if (static_cast<std::uintmax_t>(m_arena.size()) > std::numeric_limits<offset_type>::max()) {
+                return false;
+            }
+            m_offsets.push_back(static_cast<offset_type>(m_arena.size()));
+
+            unsigned char len[10];
+            const std::size_t len_size = _encode_length(s.size(), len);
+            const size_type at = m_arena.size();
+            const size_type needed = at + static_cast<size_type>(len_size + s.size());
+            if (needed > m_arena.cap()) {
+                m_arena.reserve(std::max<size_type>(needed, 2 * m_arena.cap())); // resize alone would grow to exactly needed
+            }
+            m_arena.resize(needed);
+            std::memcpy(m_arena.data() + at, len, len_size);
+            if (!s.empty()) {
+                std::memcpy(m_arena.data() + at + len_size, s.data(), s.size());
+            }
+            return true;
+        }
+
+        dyn_array_always_inline std::string_view operator[](size_type idx) const noexcept {
+            assert(idx < m_offsets.size());
+            return _at(m_offsets[idx]);
+        }
+
+        // first index holding exactly s, npos if none
+        size_type find(std::string_view s) const noexcept {
+            if (m_in_order && !m_offsets.is_empty()) {
+                // short strings: the length-prefixed encoding of s occurs at an offset exactly where s is stored
+                unsigned char needle[64];
+                const std::size_t len_size = _encode_length(s.size(), needle);
+                if (len_size + s.size() <= sizeof(needle)) {
+                    if (!s.empty()) {
+                        std::memcpy(needle + len_size, s.data(), s.size());
+                    }
+                    return _scan(needle, len_size + s.size(), [this](size_type i, std::size_t hit) {
+                        return static_cast<std::size_t>(m_offsets[i]) == hit;
+                    });
+                }
+                // long ones: the bytes of s at the start of a string's data, and the lengths agree
+                return _scan(reinterpret_cast<unsigned char const*>(s.data()), s.size(), [this, &s](size_type i, std::size_t hit) {
+                    const std::string_view e = _at(m_offsets[i]);
+                    return e.data() == m_arena.data() + hit && e.size() == s.size();
+                });
+            }
+            for (size_type i = 0; i < m_offsets.size(); ++i) {
+                const std::string_view e = _at(m_offsets[i]);
+                if (e.size() == s.size() && std::memcmp(e.data(), s.data(), s.size()) == 0) {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+        // first index whose string starts with prefix, npos if none
+        size_type find_prefix(std::string_view prefix) const noexcept {
+            if (m_in_order && !m_offsets.is_empty() && !prefix.empty()) {
+                return _scan(reinterpret_cast<unsigned char const*>(prefix.data()), prefix.size(), [this, &prefix](size_type i, std::size_t hit) {
+                    const std::string_view e = _at(m_offsets[i]);
+                    return e.data() == m_arena.data() + hit && e.size() >= prefix.size();
+                });
+            }
+            for (size_type i = 0; i < m_offsets.size(); ++i) {
+                const std::string_view e = _at(m_offsets[i]);
+                if (e.size() >= prefix.size() && std::memcmp(e.data(), prefix.data(), prefix.size()) == 0) {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+        dyn_array_always_inline bool contains(std::string_view s) const noexcept {
+            return find(s) != npos;
+        }
+
+        // reorders the offsets only; the arena is left untouched
+        template <typename Compare = std::less<std::string_view>>
+        void sort(Compare cmp = {}) {
+            std::sort(m_offsets.begin(), m_offsets.end(), [this, &cmp](offset_type a, offset_type b) {
+                return cmp(_at(a), _at(b));
+            });
+            // ascending offsets over an arena without dead bytes can only be the strings back to back
+            m_in_order = m_dead == 0 && std::is_sorted(m_offsets.begin(), m_offsets.end());
+        }
+
+        // rewrites the arena in current index order, dropping bytes no longer referenced
+        void compact() {
+            arena_type arena;
+            arena.reserve(m_arena.size());
+            for (auto& off : m_offsets) {
+                const std::string_view s = _at(off);
+                const char* f = reinterpret_cast<char const*>(m_arena.data()) + off;
+                const size_type n = static_cast<size_type>(s.data() + s.size() - f);
+                const size_type at = arena.size();
+                arena.resize(at + n);
+                std::memcpy(arena.data() + at, f, n);
+                off = static_cast<offset_type>(at);
+            }
+            m_arena = std::move(arena);
+            m_dead = 0;
+            m_in_order = true;
+        }
+
+        // the arena shrinks only when the removed string was the last one written; otherwise its bytes stay
+        // behind, dead, until compact()
+        void pop_back() {
+            assert(!m_offsets.is_empty());
+            const std::string_view s = _at(m_offsets.back());
+            if (s.data() + s.size() == m_arena.data() + m_arena.size()) {
+                m_arena.resize(static_cast<size_type>(m_offsets.back()));
+            } else {
+                m_dead += static_cast<size_type>(s.data() + s.size() - (m_arena.data() + m_offsets.back()));
+                m_in_order = false;
+            }
+            m_offsets.resize(m_offsets.size() - 1);
+        }
+
+        void clear() {
+            m_arena.clear();
+            m_offsets.clear();
+            m_dead = 0;
+            m_in_order = true;
+        }
+
+        void shrink_to_fit() {
+            m_arena.shrink_to_fit();
+            m_offsets.shrink_to_fit();
+        }
+
+        dyn_array_always_inline const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+
+        dyn_array_always_inline const_iterator end() const noexcept {
+            return const_iterator(this, m_offsets.size());
+        }
+
+        dyn_array_always_inline arena_type const& arena() const noexcept {
+            return m_arena;
+        }
+
+        dyn_array_always_inline offsets_type const& offsets() const noexcept {
+            return m_offsets;
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_offsets.size();
+        }
+
+        dyn_array_always_inline size_type bytes() const noexcept {
+            return m_arena.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_offsets.is_empty();
+        }
+    };
+}
+
+#endif
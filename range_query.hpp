@@ -0,0 +1,244 @@
+#ifndef RANGE_QUERY_HPP
+#define RANGE_QUERY_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "dyn_array.hpp"
+
+// logarithmic range aggregates over a fixed-length sequence. An op is a functor with an associative
+// operator() and a static identity(); ops that can be undone also provide inverse(a, b), the c with
+// op(b, c) == a, which is what lets fenwick_tree answer arbitrary ranges rather than just prefixes.
+
+namespace cz {
+
+    namespace range_ops {
+        template <typename T>
+        struct sum {
+            dyn_array_always_inline T operator()(T const& a, T const& b) const {
+                return a + b;
+            }
+
+            dyn_array_always_inline T inverse(T const& a, T const& b) const {
+                return a - b;
+            }
+
+            static constexpr T identity() {
+                return T{};
+            }
+        };
+
+        template <typename T>
+        struct min {
+            dyn_array_always_inline T operator()(T const& a, T const& b) const {
+                return b < a ? b : a;
+            }
+
+            static constexpr T identity() {
+                if constexpr (std::numeric_limits<T>::has_infinity) {
+                    return std::numeric_limits<T>::infinity();
+                } else {
+                    return std::numeric_limits<T>::max();
+                }
+            }
+        };
+
+        template <typename T>
+        struct max {
+            dyn_array_always_inline T operator()(T const& a, T const& b) const {
+                return a < b ? b : a;
+            }
+
+            static constexpr T identity() {
+                if constexpr (std::numeric_limits<T>::has_infinity) {
+                    return -std::numeric_limits<T>::infinity();
+                } else {
+                    return std::numeric_limits<T>::lowest();
+                }
+            }
+        };
+    }
+
+    namespace detail {
+        namespace range {
+            template <typename Op, typename T, typename = void>
+            struct has_inverse : std::false_type {
+            };
+
+            template <typename Op, typename T>
+            struct has_inverse<Op, T, decltype(void(std::declval<Op const&>().inverse(std::declval<T>(), std::declval<T>())))> : std::true_type {
+            };
+        }
+    }
+
+    // binary indexed tree, 0-based: node i aggregates elements (i & (i + 1)) .. i. Ops must be commutative;
+    // range queries and set() need an invertible op such as sum
+    template <typename T, typename Op = range_ops::sum<T>>
+    class fenwick_tree {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+    private:
+
+        dyn_array<T> m_tree;
+        Op m_op;
+
+    public:
+
+        explicit fenwick_tree(size_type n = 0, Op op = Op{})
+            : m_tree(n, Op::identity())
+            , m_op{op} {
+        }
+
+        // O(n): every node pushes its aggregate into its parent once
+        explicit fenwick_tree(dyn_array_view<T const> values, Op op = Op{})
+            : m_tree(values.data(), values.data() + values.size())
+            , m_op{op} {
+            const size_type n = m_tree.size();
+            for (size_type i = 0; i < n; ++i) {
+                const size_type parent = i | (i + 1);
+                if (parent < n) {
+                    m_tree[parent] = m_op(m_tree[parent], m_tree[i]);
+                }
+            }
+        }
+
+        // element i becomes op(element i, v)
+        void update(size_type i, T const& v) {
+            assert(i < m_tree.size());
+            for (; i < m_tree.size(); i |= i + 1) {
+                m_tree[i] = m_op(m_tree[i], v);
+            }
+        }
+
+        // op over [0, r)
+        T prefix(size_type r) const {
+            assert(r <= m_tree.size());
+            T acc = Op::identity();
+            for (; r > 0; r &= r - 1) {
+                acc = m_op(acc, m_tree[r - 1]);
+            }
+            return acc;
+        }
+
+        // op over [l, r)
+        T query(size_type l, size_type r) const {
+            static_assert(detail::range::has_inverse<Op, T>::value, "range queries need an op with inverse()");
+            assert(l <= r);
+            return m_op.inverse(prefix(r), prefix(l));
+        }
+
+        T get(size_type i) const {
+            return query(i, i + 1);
+        }
+
+        void set(size_type i, T const& v) {
+            update(i, m_op.inverse(v, get(i)));
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_tree.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_tree.is_empty();
+        }
+    };
+
+    // bottom-up segment tree in one dyn_array of 2n nodes: leaves at n..2n-1, node i = op(2i, 2i + 1).
+    // Queries fold from both ends inwards and keep operand order, so the op need not be commutative
+    template <typename T, typename Op = range_ops::sum<T>>
+    class segment_tree {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+    private:
+
+        dyn_array<T> m_tree;
+        size_type m_size;
+        Op m_op;
+
+        void _build() {
+            for (size_type i = m_size; i-- > 1;) {
+                m_tree[i] = m_op(m_tree[2 * i], m_tree[2 * i + 1]);
+            }
+        }
+
+    public:
+
+        explicit segment_tree(size_type n = 0, Op op = Op{})
+            : m_tree(2 * n, Op::identity())
+            , m_size{n}
+            , m_op{op} {
+        }
+
+        // O(n)
+        explicit segment_tree(dyn_array_view<T const> values, Op op = Op{})
+            : m_tree(2 * static_cast<size_type>(values.size()), Op::identity())
+            , m_size{static_cast<size_type>(values.size())}
+            , m_op{op} {
+            for (size_type i = 0; i < m_size; ++i) {
+                m_tree[m_size + i] = values[i];
+            }
+            _build();
+        }
+
+        void set(size_type i, T const& v) {
+            assert(i < m_size);
+            i += m_size;
+            m_tree[i] = v;
+            for (i /= 2; i > 0; i /= 2) {
+                m_tree[i] = m_op(m_tree[2 * i], m_tree[2 * i + 1]);
+            }
+        }
+
+        // element i becomes op(element i, v)
+        void update(size_type i, T const& v) {
+            set(i, m_op(get(i), v));
+        }
+
+        dyn_array_always_inline T const& get(size_type i) const noexcept {
+            assert(i < m_size);
+            return m_tree[m_size + i];
+        }
+
+        // op over [l, r)
+        T query(size_type l, size_type r) const {
+            assert(l <= r && r <= m_size);
+            T left = Op::identity(), right = Op::identity();
+            for (l += m_size, r += m_size; l < r; l /= 2, r /= 2) {
+                if (l & 1) {
+                    left = m_op(left, m_tree[l++]);
+                }
+                if (r & 1) {
+                    right = m_op(m_tree[--r], right);
+                }
+            }
+            return m_op(left, right);
+        }
+
+        // overwrites elements [first, first + values.size()) and rebuilds the tree in one O(n) pass
+        void assign(size_type first, dyn_array_view<T const> values) {
+            assert(first + values.size() <= m_size);
+            for (size_type i = 0; i < values.size(); ++i) {
+                m_tree[m_size + first + i] = values[i];
+            }
+            _build();
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_size;
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_size == 0;
+        }
+    };
+}
+
+#endif
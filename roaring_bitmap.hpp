@@ -0,0 +1,865 @@
+#ifndef ROARING_BITMAP_HPP
+#define ROARING_BITMAP_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "dyn_array.hpp"
+#include "set_operations.hpp"
+
+// compressed set of 32-bit integers: values are grouped by their high 16 bits, and each group keeps its
+// low halves in whichever container is smallest - a sorted array up to 4096 members, an 8 KB bitset
+// above that, or (after run_optimize()) a list of runs. Bitset work goes through AVX2 when available;
+// array work reuses the merge and galloping kernels from set_operations.hpp.
+
+namespace cz {
+
+    namespace detail {
+        namespace roaring {
+            constexpr std::uint32_t array_max = 4096;
+            constexpr std::size_t bitset_words = 1024;
+
+            enum class kind : std::uint8_t {
+                array,
+                bitset,
+                run
+            };
+
+            enum class bit_op {
+                or_,
+                and_,
+                andnot
+            };
+
+            struct container {
+                kind type = kind::array;
+                std::uint32_t cardinality = 0;
+                dyn_array<std::uint16_t> values; // array: sorted members; run: (start, length - 1) pairs by start
+                dyn_array<std::uint64_t> bits;   // bitset: bitset_words words
+            };
+
+            namespace scalar {
+                template <bit_op Op>
+                std::size_t combine(std::uint64_t const* a, std::uint64_t const* b, std::uint64_t* out) noexcept {
+                    std::size_t c = 0;
+                    for (std::size_t i = 0; i < bitset_words; ++i) {
+                        const std::uint64_t w = Op == bit_op::or_ ? a[i] | b[i] : Op == bit_op::and_ ? a[i] & b[i] : a[i] & ~b[i];
+                        out[i] = w;
+                        c += bits::popcount64(w);
+                    }
+                    return c;
+                }
+
+                inline std::size_t count(std::uint64_t const* a) noexcept {
+                    std::size_t c = 0;
+                    for (std::size_t i = 0; i < bitset_words; ++i) {
+                        c += bits::popcount64(a[i]);
+                    }
+                    return c;
+                }
+            }
+
+#ifdef DYN_ARRAY_SIMD_X86
+DYN_ARRAY_SIMD_TARGET_BEGIN("avx2,popcnt")
+            namespace avx2 {
+                template <bit_op Op>
+                std::size_t combine(std::uint64_t const* a, std::uint64_t const* b, std::uint64_t* out) noexcept {
+                    std::size_t c = 0;
+                    for (std::size_t i = 0; i < bitset_words; i += 4) {
+                        const __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+                        const __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+                        const __m256i w = Op == bit_op::or_ ? _mm256_or_si256(x, y) : Op == bit_op::and_ ? _mm256_and_si256(x, y) : _mm256_andnot_si256(y, x);
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), w);
+                        c += static_cast<std::size_t>(__builtin_popcountll(out[i]) + __builtin_popcountll(out[i + 1])
+                                                      + __builtin_popcountll(out[i + 2]) + __builtin_popcountll(out[i + 3]));
+                    }
+                    return c;
+                }
+
+                inline std::size_t count(std::uint64_t const* a) noexcept {
+                    std::size_t c = 0;
+                    for (std::size_t i = 0; i < bitset_words; ++i) {
+                        c += static_cast<std::size_t>(__builtin_popcountll(a[i]));
+                    }
+                    return c;
+                }
+            }
+DYN_ARRAY_SIMD_TARGET_END
+#endif
+
+            // a & b, a | b or a & ~b over two bitsets into out; returns the popcount of the result
+            template <bit_op Op>
+            std::size_t combine_words(std::uint64_t const* a, std::uint64_t const* b, std::uint64_t* out) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::combine<Op>(a, b, out);
+                }
+#endif
+                return scalar::combine<Op>(a, b, out);
+            }
+
+            inline std::size_t count_words(std::uint64_t const* a) noexcept {
+#ifdef DYN_ARRAY_SIMD_X86
+                if (simd::active_level() >= simd_level::avx2) {
+                    return avx2::count(a);
+                }
+#endif
+                return scalar::count(a);
+            }
+
+            // sets bits [first, last]
+            inline void set_range(std::uint64_t* w, std::uint32_t first, std::uint32_t last) noexcept {
+                const std::uint32_t fw = first / 64, lw = last / 64;
+                const std::uint64_t fm = ~std::uint64_t{0} << (first % 64);
+                const std::uint64_t lm = ~std::uint64_t{0} >> (63 - last % 64);
+                if (fw == lw) {
+                    w[fw] |= fm & lm;
+                    return;
+                }
+                w[fw] |= fm;
+                for (std::uint32_t i = fw + 1; i < lw; ++i) {
+                    w[i] = ~std::uint64_t{0};
+                }
+                w[lw] |= lm;
+            }
+
+            // the members of c as a zero-initialized bitset
+            inline void materialize(container const& c, std::uint64_t* w) noexcept {
+                switch (c.type) {
+                case kind::bitset:
+                    std::memcpy(w, c.bits.data(), bitset_words * sizeof(std::uint64_t));
+                    return;
+                case kind::array:
+                    std::memset(w, 0, bitset_words * sizeof(std::uint64_t));
+                    for (auto v : c.values) {
+                        w[v / 64] |= std::uint64_t{1} << (v % 64);
+                    }
+                    return;
+                case kind::run:
+                    std::memset(w, 0, bitset_words * sizeof(std::uint64_t));
+                    for (std::size_t r = 0; r < c.values.size(); r += 2) {
+                        set_range(w, c.values[r], std::uint32_t{c.values[r]} + c.values[r + 1]);
+                    }
+                    return;
+                }
+            }
+
+            // c's bitset, or a materialized copy of it in scratch
+            inline std::uint64_t const* words_of(container const& c, dyn_array<std::uint64_t>& scratch) {
+                if (c.type == kind::bitset) {
+                    return c.bits.data();
+                }
+                scratch.resize_and_overwrite(bitset_words, [&](std::uint64_t* w, std::size_t n) {
+                    materialize(c, w);
+                    return n;
+                });
+                return scratch.data();
+            }
+
+            inline container from_array(dyn_array<std::uint16_t>&& values) {
+                container c;
+                c.cardinality = static_cast<std::uint32_t>(values.size());
+                if (c.cardinality <= array_max) {
+                    c.values = std::move(values);
+                    return c;
+                }
+                c.type = kind::bitset;
+                c.bits = dyn_array<std::uint64_t>(bitset_words, std::uint64_t{0});
+                for (auto v : values) {
+                    c.bits[v / 64] |= std::uint64_t{1} << (v % 64);
+                }
+                return c;
+            }
+
+            // takes a bitset holding cardinality members and picks the array form when it is small enough
+            inline container from_words(dyn_array<std::uint64_t>&& words, std::size_t cardinality) {
+                container c;
+                c.cardinality = static_cast<std::uint32_t>(cardinality);
+                if (cardinality > array_max) {
+                    c.type = kind::bitset;
+                    c.bits = std::move(words);
+                    return c;
+                }
+                c.values.resize_and_overwrite(cardinality, [&](std::uint16_t* p, std::size_t n) {
+                    std::size_t k = 0;
+                    for (std::size_t i = 0; i < bitset_words; ++i) {
+                        for (std::uint64_t w = words[i]; w != 0; w &= w - 1) {
+                            p[k++] = static_cast<std::uint16_t>(i * 64 + bits::ctz64(w));
+                        }
+                    }
+                    return n;
+                });
+                return c;
+            }
+
+            // back to array or bitset form, which add() and remove() work on
+            inline void flatten(container& c) {
+                if (c.type == kind::run) {
+                    dyn_array<std::uint64_t> w;
+                    words_of(c, w);
+                    c = from_words(std::move(w), c.cardinality);
+                }
+            }
+
+            inline bool contains(container const& c, std::uint16_t low) noexcept {
+                switch (c.type) {
+                case kind::array:
+                    return std::binary_search(c.values.begin(), c.values.end(), low);
+                case kind::bitset:
+                    return (c.bits[low / 64] >> (low % 64) & 1) != 0;
+                case kind::run: {
+                    // last run starting at or before low
+                    std::size_t lo = 0, hi = c.values.size() / 2;
+                    while (lo < hi) {
+                        const std::size_t mid = (lo + hi) / 2;
+                        if (c.values[2 * mid] <= low) {
+                            lo = mid + 1;
+                        } else {
+                            hi = mid;
+                        }
+                    }
+                    return lo > 0 && low - c.values[2 * lo - 2] <= c.values[2 * lo - 1];
+                }
+                }
+                return false;
+            }
+
+            inline bool add(container& c, std::uint16_t low) {
+                flatten(c);
+                if (c.type == kind::bitset) {
+                    std::uint64_t& w = c.bits[low / 64];
+                    const std::uint64_t m = std::uint64_t{1} << (low % 64);
+                    if ((w & m) != 0) {
+                        return false;
+                    }
+                    w |= m;
+                    ++c.cardinality;
+                    return true;
+                }
+
+                auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+                if (it != c.values.end() && *it == low) {
+                    return false;
+                }
+                const auto pos = it - c.values.begin();
+                c.values.push_back(low);
+                std::rotate(c.values.begin() + pos, c.values.end() - 1, c.values.end());
+                ++c.cardinality;
+                if (c.cardinality > array_max) {
+                    c = from_array(std::move(c.values));
+                }
+                return true;
+            }
+
+            inline bool remove(container& c, std::uint16_t low) {
+                flatten(c);
+                if (c.type == kind::bitset) {
+                    std::uint64_t& w = c.bits[low / 64];
+                    const std::uint64_t m = std::uint64_t{1} << (low % 64);
+                    if ((w & m) == 0) {
+                        return false;
+                    }
+                    w &= ~m;
+                    if (--c.cardinality <= array_max) {
+                        c = from_words(std::move(c.bits), c.cardinality);
+                    }
+                    return true;
+                }
+
+                auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+                if (it == c.values.end() || *it != low) {
+                    return false;
+                }
+                c.values.remove_at(static_cast<std::size_t>(it - c.values.begin()));
+                --c.cardinality;
+                return true;
+            }
+
+            template <bit_op Op>
+            container combine(container const& a, container const& b) {
+                if (a.type == kind::array && b.type == kind::array) {
+                    const std::size_t na = a.values.size(), nb = b.values.size();
+                    dyn_array<std::uint16_t> out;
+                    out.resize_and_overwrite(Op == bit_op::or_ ? na + nb : Op == bit_op::and_ ? std::min(na, nb) : na, [&](std::uint16_t* p, std::size_t) {
+                        if constexpr (Op == bit_op::or_) {
+                            return sets::unite(a.values.data(), na, b.values.data(), nb, p);
+                        } else if constexpr (Op == bit_op::and_) {
+                            return sets::intersect(a.values.data(), na, b.values.data(), nb, p);
+                        } else {
+                            return sets::subtract(a.values.data(), na, b.values.data(), nb, p);
+                        }
+                    });
+                    return from_array(std::move(out));
+                }
+
+                // an array side bounds the result of and/andnot, so probe the other side per member
+                if (Op != bit_op::or_ && (a.type == kind::array || (Op == bit_op::and_ && b.type == kind::array))) {
+                    container const& small = a.type == kind::array ? a : b;
+                    container const& other = a.type == kind::array ? b : a;
+                    dyn_array<std::uint16_t> out;
+                    out.resize_and_overwrite(small.values.size(), [&](std::uint16_t* p, std::size_t n) {
+                        std::size_t k = 0;
+                        for (std::size_t i = 0; i < n; ++i) {
+                            p[k] = small.values[i];
+                            k += contains(other, small.values[i]) == (Op == bit_op::and_);
+                        }
+                        return k;
+                    });
+                    return from_array(std::move(out));
+                }
+
+                dyn_array<std::uint64_t> sa, sb, out;
+                std::uint64_t const* wa = words_of(a, sa);
+                std::uint64_t const* wb = words_of(b, sb);
+                std::size_t card = 0;
+                out.resize_and_overwrite(bitset_words, [&](std::uint64_t* w, std::size_t n) {
+                    card = combine_words<Op>(wa, wb, w);
+                    return n;
+                });
+                return from_words(std::move(out), card);
+            }
+
+            inline bool equal(container const& a, container const& b) {
+                if (a.cardinality != b.cardinality) {
+                    return false;
+                }
+                // only sorted arrays compare element-wise; run lists go through the bitset so no run
+                // encoding of the same members can compare unequal
+                if (a.type == kind::array && b.type == kind::array) {
+                    return a.values.size() == b.values.size()
+                        && std::equal(a.values.begin(), a.values.end(), b.values.begin());
+                }
+                dyn_array<std::uint64_t> sa, sb;
+                return std::memcmp(words_of(a, sa), words_of(b, sb), bitset_words * sizeof(std::uint64_t)) == 0;
+            }
+
+            inline std::size_t count_runs(container const& c) {
+                switch (c.type) {
+                case kind::run:
+                    return c.values.size() / 2;
+                case kind::array: {
+                    std::size_t runs = 0;
+                    for (std::size_t i = 0; i < c.values.size(); ++i) {
+                        runs += i == 0 || c.values[i] != c.values[i - 1] + 1;
+                    }
+                    return runs;
+                }
+                case kind::bitset: {
+                    // a run starts wherever a set bit follows a clear one
+                    std::size_t runs = 0;
+                    std::uint64_t carry = 0;
+                    for (std::size_t i = 0; i < bitset_words; ++i) {
+                        const std::uint64_t w = c.bits[i];
+                        runs += bits::popcount64(w & ~(w << 1 | carry));
+                        carry = w >> 63;
+                    }
+                    return runs;
+                }
+                }
+                return 0;
+            }
+
+            // rewrites c as runs when that is its smallest encoding, and leaves run form when it no longer is
+            inline void run_optimize(container& c) {
+                const std::size_t runs = count_runs(c);
+                const std::size_t plain = c.cardinality <= array_max ? 2 * std::size_t{c.cardinality} : 8 * bitset_words;
+                if (2 + 4 * runs >= plain) {
+                    flatten(c);
+                    return;
+                }
+                if (c.type == kind::run) {
+                    return;
+                }
+
+                dyn_array<std::uint64_t> scratch;
+                std::uint64_t const* w = words_of(c, scratch);
+                dyn_array<std::uint16_t> pairs;
+                pairs.resize_and_overwrite(2 * runs, [&](std::uint16_t* p, std::size_t n) {
+                    std::size_t k = 0;
+                    std::uint32_t i = 0;
+                    while (k < n) {
+                        while ((w[i / 64] >> (i % 64) & 1) == 0) {
+                            ++i;
+                        }
+                        const std::uint32_t start = i;
+                        while (i < 65536 && (w[i / 64] >> (i % 64) & 1) != 0) {
+                            ++i;
+                        }
+                        p[k++] = static_cast<std::uint16_t>(start);
+                        p[k++] = static_cast<std::uint16_t>(i - 1 - start);
+                    }
+                    return n;
+                });
+                c.type = kind::run;
+                c.values = std::move(pairs);
+                c.bits = dyn_array<std::uint64_t>{};
+            }
+
+            // little-endian cursor over a serialized image
+            struct reader {
+                std::uint8_t const* p;
+                std::uint8_t const* end;
+
+                bool skip(std::size_t n) noexcept {
+                    if (static_cast<std::size_t>(end - p) < n) {
+                        return false;
+                    }
+                    p += n;
+                    return true;
+                }
+
+                template <typename U>
+                bool read(U& out) noexcept {
+                    if (static_cast<std::size_t>(end - p) < sizeof(U)) {
+                        return false;
+                    }
+                    std::uint64_t v = 0;
+                    for (std::size_t i = 0; i < sizeof(U); ++i) {
+                        v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+                    }
+                    out = static_cast<U>(v);
+                    p += sizeof(U);
+                    return true;
+                }
+            };
+
+            template <typename U>
+            inline std::uint8_t* write(std::uint8_t* p, U v) noexcept {
+                for (std::size_t i = 0; i < sizeof(U); ++i) {
+                    p[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(v) >> (8 * i));
+                }
+                return p + sizeof(U);
+            }
+
+            constexpr std::uint32_t cookie_no_runs = 12346;
+            constexpr std::uint32_t cookie_runs = 12347;
+        }
+    }
+
+    class roaring_bitmap {
+
+        using container = detail::roaring::container;
+        using kind = detail::roaring::kind;
+        using bit_op = detail::roaring::bit_op;
+
+        dyn_array<std::uint16_t> m_keys; // high halves, ascending
+        dyn_array<container> m_containers;
+
+        // position of key in m_keys, or where it would go
+        dyn_array_always_inline std::size_t _find(std::uint16_t key) const noexcept {
+            return static_cast<std::size_t>(std::lower_bound(m_keys.begin(), m_keys.end(), key) - m_keys.begin());
+        }
+
+        void _append(std::uint16_t key, container c) {
+            m_keys.push_back(key);
+            m_containers.push_back(std::move(c));
+        }
+
+        template <bit_op Op>
+        static roaring_bitmap _combine(roaring_bitmap const& a, roaring_bitmap const& b) {
+            roaring_bitmap r;
+            const std::size_t na = a.m_keys.size(), nb = b.m_keys.size();
+            std::size_t i = 0, j = 0;
+            while (i < na || j < nb) {
+                if (j == nb || (i < na && a.m_keys[i] < b.m_keys[j])) {
+                    if (Op != bit_op::and_) {
+                        r._append(a.m_keys[i], a.m_containers[i]);
+                    }
+                    ++i;
+                } else if (i == na || b.m_keys[j] < a.m_keys[i]) {
+                    if (Op == bit_op::or_) {
+                        r._append(b.m_keys[j], b.m_containers[j]);
+                    }
+                    ++j;
+                } else {
+                    container c = detail::roaring::combine<Op>(a.m_containers[i], b.m_containers[j]);
+                    if (c.cardinality != 0) {
+                        r._append(a.m_keys[i], std::move(c));
+                    }
+                    ++i;
+                    ++j;
+                }
+            }
+            return r;
+        }
+
+        std::size_t _container_bytes(container const& c) const noexcept {
+            switch (c.type) {
+            case kind::array:
+                return 2 * std::size_t{c.cardinality};
+            case kind::bitset:
+                return 8 * detail::roaring::bitset_words;
+            case kind::run:
+                return 2 + 2 * c.values.size();
+            }
+            return 0;
+        }
+
+        bool _has_runs() const noexcept {
+            for (auto const& c : m_containers) {
+                if (c.type == kind::run) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+
+        roaring_bitmap() = default;
+
+        // returns false if x was already present
+        bool add(std::uint32_t x) {
+            const auto key = static_cast<std::uint16_t>(x >> 16);
+            const std::size_t pos = _find(key);
+            if (pos < m_keys.size() && m_keys[pos] == key) {
+                return detail::roaring::add(m_containers[pos], static_cast<std::uint16_t>(x));
+            }
+
+            container c;
+            c.cardinality = 1;
+            c.values.push_back(static_cast<std::uint16_t>(x));
+            m_keys.push_back(key);
+            m_containers.push_back(std::move(c));
+            std::rotate(m_keys.begin() + pos, m_keys.end() - 1, m_keys.end());
+            std::rotate(m_containers.begin() + pos, m_containers.end() - 1, m_containers.end());
+            return true;
+        }
+
+        // returns false if x was not present
+        bool remove(std::uint32_t x) {
+            const auto key = static_cast<std::uint16_t>(x >> 16);
+            const std::size_t pos = _find(key);
+            if (pos == m_keys.size() || m_keys[pos] != key || !detail::roaring::remove(m_containers[pos], static_cast<std::uint16_t>(x))) {
+                return false;
+            }
+            if (m_containers[pos].cardinality == 0) {
+                m_keys.remove_at(pos);
+                m_containers.remove_at(pos);
+            }
+            return true;
+        }
+
+        bool contains(std::uint32_t x) const noexcept {
+            const auto key = static_cast<std::uint16_t>(x >> 16);
+            const std::size_t pos = _find(key);
+            return pos < m_keys.size() && m_keys[pos] == key && detail::roaring::contains(m_containers[pos], static_cast<std::uint16_t>(x));
+        }
+
+        // adds every value of a container of uint32_t, building whole containers at once rather than one add() per value
+        template <typename Values>
+        void add_all(Values const& values) {
+            dyn_array<std::uint32_t> v(values.data(), values.data() + values.size());
+            if (!std::is_sorted(v.begin(), v.end())) {
+                std::sort(v.begin(), v.end());
+            }
+            v.unique();
+
+            roaring_bitmap b;
+            for (std::size_t i = 0; i < v.size();) {
+                const auto key = static_cast<std::uint16_t>(v[i] >> 16);
+                std::size_t j = i;
+                while (j < v.size() && (v[j] >> 16) == key) {
+                    ++j;
+                }
+                dyn_array<std::uint16_t> low;
+                low.resize_and_overwrite(j - i, [&](std::uint16_t* p, std::size_t n) {
+                    for (std::size_t k = 0; k < n; ++k) {
+                        p[k] = static_cast<std::uint16_t>(v[i + k]);
+                    }
+                    return n;
+                });
+                b._append(key, detail::roaring::from_array(std::move(low)));
+                i = j;
+            }
+
+            if (is_empty()) {
+                *this = std::move(b);
+            } else {
+                *this |= b;
+            }
+        }
+
+        std::uint64_t cardinality() const noexcept {
+            std::uint64_t n = 0;
+            for (auto const& c : m_containers) {
+                n += c.cardinality;
+            }
+            return n;
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_keys.is_empty();
+        }
+
+        void clear() {
+            m_keys.clear();
+            m_containers.clear();
+        }
+
+        // calls f(uint32_t) on every member in ascending order
+        template <typename F>
+        void for_each(F f) const {
+            for (std::size_t i = 0; i < m_keys.size(); ++i) {
+                const std::uint32_t high = std::uint32_t{m_keys[i]} << 16;
+                container const& c = m_containers[i];
+                switch (c.type) {
+                case kind::array:
+                    for (auto v : c.values) {
+                        f(high | v);
+                    }
+                    break;
+                case kind::bitset:
+                    for (std::size_t w = 0; w < detail::roaring::bitset_words; ++w) {
+                        for (std::uint64_t bits = c.bits[w]; bits != 0; bits &= bits - 1) {
+                            f(high | static_cast<std::uint32_t>(w * 64 + detail::bits::ctz64(bits)));
+                        }
+                    }
+                    break;
+                case kind::run:
+                    for (std::size_t r = 0; r < c.values.size(); r += 2) {
+                        const std::uint32_t first = c.values[r], last = first + c.values[r + 1];
+                        for (std::uint32_t v = first; v <= last; ++v) {
+                            f(high | v);
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+
+        // every member, ascending
+        dyn_array<std::uint32_t> to_array() const {
+            dyn_array<std::uint32_t> out;
+            out.resize_and_overwrite(static_cast<std::size_t>(cardinality()), [&](std::uint32_t* p, std::size_t n) {
+                std::size_t k = 0;
+                for_each([&](std::uint32_t v) { p[k++] = v; });
+                return n;
+            });
+            return out;
+        }
+
+        // switches each container to run form where that is smaller, and back out of it where it is not
+        void run_optimize() {
+            for (auto& c : m_containers) {
+                detail::roaring::run_optimize(c);
+            }
+        }
+
+        roaring_bitmap& operator|=(roaring_bitmap const& other) {
+            *this = _combine<bit_op::or_>(*this, other);
+            return *this;
+        }
+
+        roaring_bitmap& operator&=(roaring_bitmap const& other) {
+            *this = _combine<bit_op::and_>(*this, other);
+            return *this;
+        }
+
+        // and-not: removes the members of other
+        roaring_bitmap& operator-=(roaring_bitmap const& other) {
+            *this = _combine<bit_op::andnot>(*this, other);
+            return *this;
+        }
+
+        friend roaring_bitmap operator|(roaring_bitmap const& a, roaring_bitmap const& b) {
+            return _combine<bit_op::or_>(a, b);
+        }
+
+        friend roaring_bitmap operator&(roaring_bitmap const& a, roaring_bitmap const& b) {
+            return _combine<bit_op::and_>(a, b);
+        }
+
+        friend roaring_bitmap operator-(roaring_bitmap const& a, roaring_bitmap const& b) {
+            return _combine<bit_op::andnot>(a, b);
+        }
+
+        // same members, whatever the container forms
+        friend bool operator==(roaring_bitmap const& a, roaring_bitmap const& b) {
+            if (a.m_keys.size() != b.m_keys.size() || !std::equal(a.m_keys.begin(), a.m_keys.end(), b.m_keys.begin())) {
+                return false;
+            }
+            for (std::size_t i = 0; i < a.m_containers.size(); ++i) {
+                if (!detail::roaring::equal(a.m_containers[i], b.m_containers[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        friend bool operator!=(roaring_bitmap const& a, roaring_bitmap const& b) {
+            return !(a == b);
+        }
+
+        std::size_t serialized_size() const noexcept {
+            const std::size_t n = m_keys.size();
+            const bool runs = _has_runs();
+            std::size_t bytes = (runs ? 4 + (n + 7) / 8 : 8) + 4 * n;
+            if (!runs || n >= 4) {
+                bytes += 4 * n;
+            }
+            for (auto const& c : m_containers) {
+                bytes += _container_bytes(c);
+            }
+            return bytes;
+        }
+
+        // the portable Roaring format shared by the Java, Go and C implementations: a cookie, the keys and
+        // cardinalities, container offsets, then the containers, all little-endian
+        dyn_array<std::uint8_t> serialize() const {
+            namespace rr = detail::roaring;
+            const std::size_t n = m_keys.size();
+            const bool runs = _has_runs();
+
+            dyn_array<std::uint8_t> out;
+            out.resize_and_overwrite(serialized_size(), [&](std::uint8_t* base, std::size_t size) {
+                std::uint8_t* p = base;
+                if (runs) {
+                    p = rr::write(p, static_cast<std::uint32_t>(rr::cookie_runs | (n - 1) << 16));
+                    std::memset(p, 0, (n + 7) / 8);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        p[i / 8] |= static_cast<std::uint8_t>((m_containers[i].type == kind::run) << (i % 8));
+                    }
+                    p += (n + 7) / 8;
+                } else {
+                    p = rr::write(p, rr::cookie_no_runs);
+                    p = rr::write(p, static_cast<std::uint32_t>(n));
+                }
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    p = rr::write(p, m_keys[i]);
+                    p = rr::write(p, static_cast<std::uint16_t>(m_containers[i].cardinality - 1));
+                }
+
+                if (!runs || n >= 4) {
+                    std::size_t offset = static_cast<std::size_t>(p - base) + 4 * n;
+                    for (auto const& c : m_containers) {
+                        p = rr::write(p, static_cast<std::uint32_t>(offset));
+                        offset += _container_bytes(c);
+                    }
+                }
+
+                for (auto const& c : m_containers) {
+                    if (c.type == kind::run) {
+                        p = rr::write(p, static_cast<std::uint16_t>(c.values.size() / 2));
+                    }
+                    if (c.type == kind::bitset) {
+                        for (auto w : c.bits) {
+                            p = rr::write(p, w);
+                        }
+                    } else {
+                        for (auto v : c.values) {
+                            p = rr::write(p, v);
+                        }
+                    }
+                }
+
+                assert(static_cast<std::size_t>(p - base) == size);
+                return size;
+            });
+            return out;
+        }
+
+        // nullopt if bytes is not a well-formed image
+        static std::optional<roaring_bitmap> deserialize(dyn_array_view<std::uint8_t const> bytes) {
+            namespace rr = detail::roaring;
+            rr::reader in{bytes.data(), bytes.data() + bytes.size()};
+
+            std::uint32_t cookie;
+            if (!in.read(cookie)) {
+                return std::nullopt;
+            }
+            std::size_t n;
+            std::uint8_t const* run_flags = nullptr;
+            if ((cookie & 0xffff) == rr::cookie_runs) {
+                n = (cookie >> 16) + 1;
+                run_flags = in.p;
+                if (!in.skip((n + 7) / 8)) {
+                    return std::nullopt;
+                }
+            } else if (cookie == rr::cookie_no_runs) {
+                std::uint32_t count;
+                if (!in.read(count) || count > 65536) {
+                    return std::nullopt;
+                }
+                n = count;
+            } else {
+                return std::nullopt;
+            }
+
+            roaring_bitmap r;
+            r.m_keys.reserve(n);
+            r.m_containers.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint16_t key, card;
+                if (!in.read(key) || !in.read(card) || (i > 0 && key <= r.m_keys[i - 1])) {
+                    return std::nullopt;
+                }
+                container c;
+                c.cardinality = std::uint32_t{card} + 1;
+                r._append(key, std::move(c));
+            }
+            if ((run_flags == nullptr || n >= 4) && !in.skip(4 * n)) {
+                return std::nullopt;
+            }
+
+            for (std::size_t i = 0; i < n; ++i) {
+                container& c = r.m_containers[i];
+                if (run_flags != nullptr && (run_flags[i / 8] >> (i % 8) & 1) != 0) {
+                    std::uint16_t nruns;
+                    if (!in.read(nruns)) {
+                        return std::nullopt;
+                    }
+                    c.type = kind::run;
+                    c.values = dyn_array<std::uint16_t>(std::size_t{2} * nruns, std::uint16_t{0});
+                    // runs that touch the previous one are merged into it, so equal sets keep equal run lists
+                    std::uint32_t total = 0, next = 0;
+                    std::size_t kept = 0;
+                    for (std::size_t k = 0; k < c.values.size(); k += 2) {
+                        std::uint16_t start, length;
+                        if (!in.read(start) || !in.read(length)
+                            || start < next || std::uint32_t{start} + length > 0xffff) {
+                            return std::nullopt;
+                        }
+                        if (kept > 0 && start == next) {
+                            c.values[kept - 1] = static_cast<std::uint16_t>(c.values[kept - 1] + length + 1);
+                        } else {
+                            c.values[kept] = start;
+                            c.values[kept + 1] = length;
+                            kept += 2;
+                        }
+                        next = std::uint32_t{start} + length + 1;
+                        total += std::uint32_t{length} + 1;
+                    }
+                    if (total != c.cardinality) {
+                        return std::nullopt;
+                    }
+                    c.values.resize(kept);
+                } else if (c.cardinality <= rr::array_max) {
+                    c.values = dyn_array<std::uint16_t>(std::size_t{c.cardinality}, std::uint16_t{0});
+                    for (std::size_t k = 0; k < c.values.size(); ++k) {
+                        if (!in.read(c.values[k]) || (k > 0 && c.values[k] <= c.values[k - 1])) {
+                            return std::nullopt;
+                        }
+                    }
+                } else {
+                    c.type = kind::bitset;
+                    c.bits = dyn_array<std::uint64_t>(rr::bitset_words, std::uint64_t{0});
+                    for (auto& w : c.bits) {
+                        if (!in.read(w)) {
+                            return std::nullopt;
+                        }
+                    }
+                    if (rr::count_words(c.bits.data()) != c.cardinality) {
+                        return std::nullopt;
+                    }
+                }
+            }
+            return r;
+        }
+    };
+}
+
+#endif
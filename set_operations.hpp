@@ -0,0 +1,289 @@
+#ifndef SET_OPERATIONS_HPP
+#define SET_OPERATIONS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "dyn_array.hpp"
+#include "dyn_array_parallel.hpp"
+
+// set algebra over sorted dyn_arrays without duplicates (posting lists and the like). Results are written
+// straight into the caller's array through resize_and_overwrite, so element types must be trivially copyable.
+// With threads > 1 large inputs are cut at values of `a` and the pieces processed concurrently.
+
+namespace cz {
+
+    namespace detail {
+        namespace sets {
+            // below this size ratio the merge-based intersection wins over galloping
+            constexpr std::size_t gallop_ratio = 32;
+
+            template <typename T>
+            std::size_t gallop_intersect(T const* small, std::size_t ns, T const* large, std::size_t nl, T* out) {
+                std::size_t k = 0, pos = 0;
+                for (std::size_t i = 0; i < ns && pos < nl; ++i) {
+                    const T x = small[i];
+                    std::size_t step = 1;
+                    while (pos + step < nl && large[pos + step] < x) {
+                        step *= 2;
+                    }
+                    const std::size_t hi = pos + step < nl ? pos + step + 1 : nl;
+                    pos = static_cast<std::size_t>(std::lower_bound(large + pos + step / 2, large + hi, x) - large);
+                    if (pos < nl && !(x < large[pos])) {
+                        out[k++] = x;
+                    }
+                }
+                return k;
+            }
+
+            template <typename T>
+            std::size_t intersect(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) {
+                if (na > nb) {
+                    std::swap(a, b);
+                    std::swap(na, nb);
+                }
+                if (na == 0) {
+                    return 0;
+                }
+                if (nb / na >= gallop_ratio) {
+                    return gallop_intersect(a, na, b, nb, out);
+                }
+                if constexpr (simd::is_integral_element<T>::value && sizeof(T) == 4) {
+                    return simd::intersect(a, na, b, nb, out);
+                } else {
+                    return simd::scalar::intersect(a, na, b, nb, out);
+                }
+            }
+
+            // the loop body emits the smaller head and advances by comparison results, no data-dependent branches
+            template <typename T>
+            std::size_t unite(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) {
+                std::size_t i = 0, j = 0, k = 0;
+                while (i < na && j < nb) {
+                    const T x = a[i], y = b[j];
+                    out[k++] = y < x ? y : x;
+                    i += !(y < x);
+                    j += !(x < y);
+                }
+                for (; i < na; ++i) {
+                    out[k++] = a[i];
+                }
+                for (; j < nb; ++j) {
+                    out[k++] = b[j];
+                }
+                return k;
+            }
+
+            template <typename T>
+            std::size_t subtract(T const* a, std::size_t na, T const* b, std::size_t nb, T* out) {
+                std::size_t i = 0, j = 0, k = 0;
+                while (i < na && j < nb) {
+                    const T x = a[i], y = b[j];
+                    out[k] = x;
+                    k += x < y;
+                    i += !(y < x);
+                    j += !(x < y);
+                }
+                for (; i < na; ++i) {
+                    out[k++] = a[i];
+                }
+                return k;
+            }
+
+            // runs op(a, na, b, nb, out) over slices of a and the matching slices of b, then concatenates the
+            // partial results into out; max_out(na, nb) bounds the output of one slice
+            template <typename T, typename Out, typename Op, typename Bound>
+            void run(T const* a, std::size_t na, T const* b, std::size_t nb, Out& out, unsigned threads, Op op, Bound max_out) {
+                using size_type = typename Out::size_type;
+
+                if (threads <= 1 || na == 0) {
+                    out.resize_and_overwrite(static_cast<size_type>(max_out(na, nb)), [&](T* p, size_type) {
+                        return op(a, na, b, nb, p);
+                    });
+                    return;
+                }
+
+                dyn_array<dyn_array<T>> parts(std::size_t{threads});
+                parallel::for_each_chunk(na, threads, [&](std::size_t c, std::size_t f, std::size_t l) {
+                    const std::size_t bf = f == 0 ? 0 : static_cast<std::size_t>(std::lower_bound(b, b + nb, a[f]) - b);
+                    const std::size_t bl = l == na ? nb : static_cast<std::size_t>(std::lower_bound(b, b + nb, a[l]) - b);
+                    parts[c].resize_and_overwrite(max_out(l - f, bl - bf), [&](T* p, std::size_t) {
+                        return op(a + f, l - f, b + bf, bl - bf, p);
+                    });
+                });
+
+                std::size_t total = 0;
+                for (auto const& part : parts) {
+                    total += part.size();
+                }
+                out.resize_and_overwrite(static_cast<size_type>(total), [&](T* p, size_type) {
+                    std::size_t k = 0;
+                    for (auto const& part : parts) {
+                        if (!part.is_empty()) {
+                            std::memcpy(p + k, part.data(), part.size() * sizeof(T));
+                        }
+                        k += part.size();
+                    }
+                    return total;
+                });
+            }
+
+            // tournament over k sorted sources: internal nodes 1..k-1 keep the loser of their match, node 0
+            // the overall winner, so advancing the winner replays a single leaf-to-root path
+            template <typename T, typename Compare = std::less<T>>
+            class loser_tree {
+
+                dyn_array<T const*> m_cur;
+                dyn_array<T const*> m_end;
+                dyn_array<std::size_t> m_tree;
+                std::size_t m_k;
+                Compare m_cmp;
+
+                // exhausted sources lose every match; ties go to the lower source index, keeping the merge stable
+                bool _beats(std::size_t i, std::size_t j) const noexcept {
+                    if (m_cur[i] == m_end[i]) {
+                        return false;
+                    }
+                    if (m_cur[j] == m_end[j]) {
+                        return true;
+                    }
+                    return m_cmp(*m_cur[i], *m_cur[j]) || (!m_cmp(*m_cur[j], *m_cur[i]) && i < j);
+                }
+
+                std::size_t _build(std::size_t node) {
+                    if (node >= m_k) {
+                        return node - m_k;
+                    }
+                    const std::size_t l = _build(2 * node);
+                    const std::size_t r = _build(2 * node + 1);
+                    if (_beats(l, r)) {
+                        m_tree[node] = r;
+                        return l;
+                    }
+                    m_tree[node] = l;
+                    return r;
+                }
+
+            public:
+
+                template <typename Lists>
+                explicit loser_tree(Lists const& lists, Compare cmp = Compare{})
+                    : m_k{static_cast<std::size_t>(lists.size())}
+                    , m_cmp{cmp} {
+                    m_cur.reserve(m_k);
+                    m_end.reserve(m_k);
+                    for (auto const& list : lists) {
+                        m_cur.push_back(list.data());
+                        m_end.push_back(list.data() + list.size());
+                    }
+                    m_tree = dyn_array<std::size_t>(m_k == 0 ? std::size_t{1} : m_k);
+                    m_tree[0] = m_k > 1 ? _build(1) : 0;
+                }
+
+                dyn_array_always_inline T pop() noexcept {
+                    return pop([](std::size_t, T const*&, T const*&) {});
+                }
+
+                // for sources streamed in blocks: when the winner's block runs out, refill(source, cur, end)
+                // may point it at the next one before the path is replayed; leaving cur == end ends the source
+                template <typename Refill>
+                dyn_array_always_inline T pop(Refill&& refill) {
+                    std::size_t w = m_tree[0];
+                    const T v = *m_cur[w]++;
+                    if (m_cur[w] == m_end[w]) {
+                        refill(w, m_cur[w], m_end[w]);
+                    }
+                    for (std::size_t node = (w + m_k) / 2; node > 0; node /= 2) {
+                        if (_beats(m_tree[node], w)) {
+                            std::swap(m_tree[node], w);
+                        }
+                    }
+                    m_tree[0] = w;
+                    return v;
+                }
+            };
+        }
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void set_intersection(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                          dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                          dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& out, unsigned threads = 1) {
+        assert(&out != &a && &out != &b);
+        // split the larger side so each slice of it still meets the smaller one
+        if (a.size() < b.size()) {
+            detail::sets::run(b.data(), static_cast<std::size_t>(b.size()), a.data(), static_cast<std::size_t>(a.size()), out, threads,
+                              detail::sets::intersect<T>, [](std::size_t na, std::size_t nb) { return na < nb ? na : nb; });
+        } else {
+            detail::sets::run(a.data(), static_cast<std::size_t>(a.size()), b.data(), static_cast<std::size_t>(b.size()), out, threads,
+                              detail::sets::intersect<T>, [](std::size_t na, std::size_t nb) { return na < nb ? na : nb; });
+        }
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void set_union(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                   dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                   dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& out, unsigned threads = 1) {
+        assert(&out != &a && &out != &b);
+        detail::sets::run(a.data(), static_cast<std::size_t>(a.size()), b.data(), static_cast<std::size_t>(b.size()), out, threads,
+                          detail::sets::unite<T>, [](std::size_t na, std::size_t nb) { return na + nb; });
+    }
+
+    // elements of a not in b
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void set_difference(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& out, unsigned threads = 1) {
+        assert(&out != &a && &out != &b);
+        detail::sets::run(a.data(), static_cast<std::size_t>(a.size()), b.data(), static_cast<std::size_t>(b.size()), out, threads,
+                          detail::sets::subtract<T>, [](std::size_t na, std::size_t) { return na; });
+    }
+
+    // merges any number of sorted lists (containers with data() and size()), duplicates kept and
+    // equal elements taken in list order
+    template <typename Lists, typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    void merge_k(Lists const& lists, dyn_array<T, alloc_t, SizeT, initial_cap, multiplier>& out) {
+        std::size_t total = 0;
+        for (auto const& list : lists) {
+            total += static_cast<std::size_t>(list.size());
+        }
+
+        detail::sets::loser_tree<T> tree(lists);
+        out.resize_and_overwrite(static_cast<SizeT>(total), [&](T* p, SizeT) {
+            for (std::size_t i = 0; i < total; ++i) {
+                p[i] = tree.pop();
+            }
+            return total;
+        });
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> set_intersection(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                                                                           dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                                                                           unsigned threads = 1) {
+        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> out;
+        set_intersection(a, b, out, threads);
+        return out;
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> set_union(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                                                                    dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                                                                    unsigned threads = 1) {
+        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> out;
+        set_union(a, b, out, threads);
+        return out;
+    }
+
+    template <typename T, typename alloc_t, typename SizeT, SizeT initial_cap, SizeT multiplier>
+    dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> set_difference(dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& a,
+                                                                         dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> const& b,
+                                                                         unsigned threads = 1) {
+        dyn_array<T, alloc_t, SizeT, initial_cap, multiplier> out;
+        set_difference(a, b, out, threads);
+        return out;
+    }
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <cstdint>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // refers to one insertion; stays valid until that value is erased, whatever else moves
+    struct slot_handle {
+        std::uint32_t index = static_cast<std::uint32_t>(-1);
+        std::uint32_t generation = 0;
+
+        dyn_array_always_inline bool operator==(slot_handle const& other) const noexcept {
+            return index == other.index && generation == other.generation;
+        }
+
+        dyn_array_always_inline bool operator!=(slot_handle const& other) const noexcept {
+            return !(*this == other);
+        }
+    };
+
+    // values live densely in a dyn_array and are erased by swapping the last one into the hole;
+    // handles go through a slot table that tracks where each value currently sits. A slot's
+    // generation is odd while it is occupied and bumped on every insert and erase, so a handle
+    // to an erased value never matches again
+    template <
+        typename T,
+        typename alloc_t = std::allocator<T>,
+        typename SizeT = std::size_t
+    >
+    class slot_map {
+    public:
+
+        using value_type = T;
+        using size_type = SizeT;
+        using handle_type = slot_handle;
+        using values_type = dyn_array<T, alloc_t, SizeT>;
+        using iterator = typename values_type::iterator;
+        using const_iterator = typename values_type::const_iterator;
+
+    private:
+
+        static constexpr std::uint32_t _no_slot = static_cast<std::uint32_t>(-1);
+
+        struct slot {
+            std::uint32_t dense_or_next; // dense position while occupied, next free slot otherwise
+            std::uint32_t generation;
+        };
+
+        values_type m_values;
+        dyn_array<std::uint32_t, std::allocator<std::uint32_t>, SizeT> m_dense_to_slot;
+        dyn_array<slot, std::allocator<slot>, SizeT> m_slots;
+        std::uint32_t m_free_head = _no_slot;
+
+        // grows a bookkeeping array geometrically ahead of need, so the push_back in _claim_slot cannot throw
+        template <typename Array>
+        static void _make_room(Array& a) {
+            if (a.size() == a.cap()) {
+                a.reserve(a.size() < 8 ? SizeT{8} : a.size() * 2);
+            }
+        }
+
+        // every allocation _claim_slot needs happens here, before the value is appended; if the append then
+        // throws, the map is left as it was
+        dyn_array_always_inline void _prepare_claim() {
+            _make_room(m_dense_to_slot);
+            if (m_free_head == _no_slot) {
+                _make_room(m_slots);
+            }
+        }
+
+        // cannot throw once _prepare_claim has run
+        handle_type _claim_slot() noexcept {
+            const std::uint32_t dense = static_cast<std::uint32_t>(m_values.size() - 1); // value already appended
+            std::uint32_t idx;
+            if (m_free_head != _no_slot) {
+                idx = m_free_head;
+                m_free_head = m_slots[idx].dense_or_next;
+            } else {
+                assert(m_slots.size() < _no_slot && "slot_map index space exhausted");
+                idx = static_cast<std::uint32_t>(m_slots.size());
+                m_slots.push_back(slot{0, 0});
+            }
+
+            slot& s = m_slots[idx];
+            s.dense_or_next = dense;
+            ++s.generation;
+            m_dense_to_slot.push_back(idx);
+            return handle_type{idx, s.generation};
+        }
+
+        dyn_array_always_inline slot const* _live(handle_type h) const noexcept {
+            if (h.index >= m_slots.size()) {
+                return nullptr;
+            }
+            slot const& s = m_slots[h.index];
+            return s.generation == h.generation && (s.generation & 1) != 0 ? &s : nullptr;
+        }
+
+    public:
+
+        slot_map() = default;
+
+        void reserve(size_type n) {
+            m_values.reserve(n);
+            m_dense_to_slot.reserve(n);
+            m_slots.reserve(n);
+        }
+
+        handle_type insert(T const& value) {
+            _prepare_claim();
+            m_values.push_back(value);
+            return _claim_slot();
+        }
+
+        handle_type insert(T&& value) {
+            _prepare_claim();
+            m_values.push_back(std::move(value));
+            return _claim_slot();
+        }
+
+        template <typename... Types>
+        handle_type emplace(Types&&... args) {
+            _prepare_claim();
+            m_values.emplace_back(std::forward<Types>(args)...);
+            return _claim_slot();
+        }
+
+        // false if the handle is stale
+        bool erase(handle_type h) {
+            if (_live(h) == nullptr) {
+                return false;
+            }
+
+            slot& s = m_slots[h.index];
+            const std::uint32_t dense = s.dense_or_next;
+            const std::uint32_t last = static_cast<std::uint32_t>(m_values.size() - 1);
+            if (dense != last) {
+                m_values[dense] = std::move(m_values[last]);
+                m_dense_to_slot[dense] = m_dense_to_slot[last];
+                m_slots[m_dense_to_slot[dense]].dense_or_next = dense;
+            }
+            m_values.pop_back();
+            m_dense_to_slot.pop_back();
+
+            ++s.generation;
+            s.dense_or_next = m_free_head;
+            m_free_head = h.index;
+            return true;
+        }
+
+        dyn_array_always_inline bool contains(handle_type h) const noexcept {
+            return _live(h) != nullptr;
+        }
+
+        // nullptr if the handle is stale
+        dyn_array_always_inline T* get(handle_type h) noexcept {
+            slot const* s = _live(h);
+            return s == nullptr ? nullptr : m_values.data() + s->dense_or_next;
+        }
+
+        dyn_array_always_inline T const* get(handle_type h) const noexcept {
+            slot const* s = _live(h);
+            return s == nullptr ? nullptr : m_values.data() + s->dense_or_next;
+        }
+
+        dyn_array_always_inline T& operator[](handle_type h) noexcept {
+            assert(contains(h));
+            return m_values[m_slots[h.index].dense_or_next];
+        }
+
+        dyn_array_always_inline T const& operator[](handle_type h) const noexcept {
+            assert(contains(h));
+            return m_values[m_slots[h.index].dense_or_next];
+        }
+
+        // handle of the value at dense position i, for walking values() alongside their handles
+        dyn_array_always_inline handle_type handle_at(size_type i) const noexcept {
+            assert(i < m_values.size());
+            const std::uint32_t idx = m_dense_to_slot[i];
+            return handle_type{idx, m_slots[idx].generation};
+        }
+
+        // every live handle becomes stale
+        void clear() {
+            for (auto idx : m_dense_to_slot) {
+                slot& s = m_slots[idx];
+                ++s.generation;
+                s.dense_or_next = m_free_head;
+                m_free_head = idx;
+            }
+            m_values.clear();
+            m_dense_to_slot.clear();
+        }
+
+        dyn_array_always_inline iterator begin() noexcept {
+            return m_values.begin();
+        }
+
+        dyn_array_always_inline iterator end() noexcept {
+            return m_values.end();
+        }
+
+        dyn_array_always_inline const_iterator begin() const noexcept {
+            return m_values.begin();
+        }
+
+        dyn_array_always_inline const_iterator end() const noexcept {
+            return m_values.end();
+        }
+
+        dyn_array_always_inline values_type const& values() const noexcept {
+            return m_values;
+        }
+
+        dyn_array_always_inline T* data() noexcept {
+            return m_values.data();
+        }
+
+        dyn_array_always_inline T const* data() const noexcept {
+            return m_values.data();
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_values.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_values.is_empty();
+        }
+    };
+}
+
+#endif
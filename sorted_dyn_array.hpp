@@ -0,0 +1,276 @@
+#ifndef SORTED_DYN_ARRAY_HPP
+#define SORTED_DYN_ARRAY_HPP
+
+#include <algorithm>
+#include <functional>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // when sorted_dyn_array sorts its insert buffer into a new level: the buffer may hold
+    // clamp(size() / ratio, min_buffer, max_buffer) elements. A larger buffer means fewer, larger levels;
+    // max_buffer caps the linear scan lookups pay for it. Inserts stay amortized O(log n) whatever the cap
+    struct merge_policy {
+        std::size_t min_buffer = 32;
+        std::size_t max_buffer = std::size_t{1} << 14;
+        std::size_t ratio = 16;
+    };
+
+    // multiset kept as log-structured sorted levels plus a small unsorted buffer of recent inserts. A full
+    // buffer is sorted on its own and pushed as the newest level; a level is merged back to front into the
+    // next older one, in a single pass, as soon as it holds at least half as many elements. Level sizes so
+    // at least double from newest to oldest: there are O(log n) of them, each element is moved O(log n)
+    // times, and an insert costs amortized O(log n). Lookups binary-search every level and scan the buffer;
+    // sorted() collapses everything into the oldest level, the one contiguous run. Equal elements keep
+    // their insertion order
+    template <typename T, typename Compare = std::less<T>>
+    class sorted_dyn_array {
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+    private:
+
+        dyn_array<T> m_sorted;
+        dyn_array<dyn_array<T>> m_levels; // newer than m_sorted, oldest first
+        dyn_array<T> m_buffer;
+        merge_policy m_policy;
+        Compare m_cmp;
+
+        dyn_array_always_inline bool _equal(T const& a, T const& b) const {
+            return !m_cmp(a, b) && !m_cmp(b, a);
+        }
+
+        dyn_array_always_inline size_type _buffer_limit() const noexcept {
+            const size_type scaled = size() / (m_policy.ratio == 0 ? 1 : m_policy.ratio);
+            return std::min(std::max(scaled, m_policy.min_buffer), std::max(m_policy.min_buffer, m_policy.max_buffer));
+        }
+
+        dyn_array_always_inline void _maybe_flush() {
+            if (m_buffer.size() >= _buffer_limit()) {
+                flush();
+            }
+        }
+
+        // grows older by newer's size, then fills from the back taking the larger head each step; on ties
+        // the element of newer goes last since it was inserted later
+        void _merge_into(dyn_array<T>& older, dyn_array<T>& newer) {
+            size_type i = older.size(), j = newer.size();
+            older.reserve(i + j);
+            for (auto const& v : newer) {
+                older.push_back(v);
+            }
+            size_type k = i + j;
+            while (j > 0 && i > 0) {
+                if (m_cmp(newer[j - 1], older[i - 1])) {
+                    older[--k] = std::move(older[--i]);
+                } else {
+                    older[--k] = std::move(newer[--j]);
+                }
+            }
+            while (j > 0) {
+                older[--k] = std::move(newer[--j]);
+            }
+            newer.clear();
+        }
+
+        dyn_array_always_inline dyn_array<T>& _older_than_newest() noexcept {
+            return m_levels.size() >= 2 ? m_levels[m_levels.size() - 2] : m_sorted;
+        }
+
+        // calls f(level) for m_sorted and then every newer level
+        template <typename F>
+        void _for_each_level(F&& f) const {
+            f(m_sorted);
+            for (auto const& level : m_levels) {
+                f(level);
+            }
+        }
+
+        // elements of the buffer equal to x
+        size_type _count_buffered(T const& x) const {
+            if constexpr (std::is_same<Compare, std::less<T>>::value && detail::simd::is_element<T>::value) {
+                return detail::simd::count(m_buffer.data(), static_cast<std::size_t>(m_buffer.size()), x);
+            } else {
+                size_type n = 0;
+                for (auto const& v : m_buffer) {
+                    n += _equal(v, x);
+                }
+                return n;
+            }
+        }
+
+        bool _in_buffer(T const& x) const {
+            if constexpr (std::is_same<Compare, std::less<T>>::value && detail::simd::is_element<T>::value) {
+                return detail::simd::find(m_buffer.data(), static_cast<std::size_t>(m_buffer.size()), x) != m_buffer.size();
+            } else {
+                for (auto const& v : m_buffer) {
+                    if (_equal(v, x)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+
+    public:
+
+        explicit sorted_dyn_array(merge_policy policy = {}, Compare cmp = Compare{})
+            : m_policy{policy}
+            , m_cmp{cmp} {
+        }
+
+        // takes values in any order; they are sorted once
+        explicit sorted_dyn_array(dyn_array<T> values, merge_policy policy = {}, Compare cmp = Compare{})
+            : m_sorted{std::move(values)}
+            , m_policy{policy}
+            , m_cmp{cmp} {
+            std::stable_sort(m_sorted.begin(), m_sorted.end(), m_cmp);
+        }
+
+        void insert(T const& value) {
+            m_buffer.push_back(value);
+            _maybe_flush();
+        }
+
+        void insert(T&& value) {
+            m_buffer.push_back(std::move(value));
+            _maybe_flush();
+        }
+
+        // bulk insert: everything goes through the buffer and is merged at most once
+        template <typename Values>
+        void insert_all(Values const& values) {
+            m_buffer.reserve(m_buffer.size() + static_cast<size_type>(values.size()));
+            for (auto const& v : values) {
+                m_buffer.push_back(v);
+            }
+            _maybe_flush();
+        }
+
+        // sorts the buffer into the newest level, then merges levels while the newest holds at least half
+        // as many elements as the one before it
+        void flush() {
+            if (m_buffer.is_empty()) {
+                return;
+            }
+            std::stable_sort(m_buffer.begin(), m_buffer.end(), m_cmp);
+            m_levels.push_back(std::move(m_buffer));
+            m_buffer = dyn_array<T>();
+
+            while (!m_levels.is_empty() && _older_than_newest().size() < 2 * m_levels.back().size()) {
+                _merge_into(_older_than_newest(), m_levels.back());
+                m_levels.remove_at(m_levels.size() - 1);
+            }
+        }
+
+        // removes one element equal to value, the most recently inserted level first; O(level size) when it
+        // sits in a level
+        bool erase(T const& value) {
+            for (size_type i = 0; i < m_buffer.size(); ++i) {
+                if (_equal(m_buffer[i], value)) {
+                    m_buffer.remove_at(i); // shifting keeps equal elements in insertion order; the buffer is small
+                    return true;
+                }
+            }
+            for (size_type l = m_levels.size() + 1; l-- > 0;) {
+                dyn_array<T>& level = l == 0 ? m_sorted : m_levels[l - 1];
+                auto it = std::lower_bound(level.begin(), level.end(), value, m_cmp);
+                if (it != level.end() && !m_cmp(value, *it)) {
+                    level.remove_at(static_cast<size_type>(it - level.begin()));
+                    if (l > 0 && level.is_empty()) {
+                        m_levels.remove_at(l - 1);
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool contains(T const& value) const {
+            bool found = false;
+            _for_each_level([&](dyn_array<T> const& level) {
+                found = found || std::binary_search(level.begin(), level.end(), value, m_cmp);
+            });
+            return found || _in_buffer(value);
+        }
+
+        size_type count(T const& value) const {
+            size_type n = _count_buffered(value);
+            _for_each_level([&](dyn_array<T> const& level) {
+                const auto r = std::equal_range(level.begin(), level.end(), value, m_cmp);
+                n += static_cast<size_type>(r.second - r.first);
+            });
+            return n;
+        }
+
+        // elements in [lo, hi)
+        size_type count_range(T const& lo, T const& hi) const {
+            size_type n = 0;
+            _for_each_level([&](dyn_array<T> const& level) {
+                const auto first = std::lower_bound(level.begin(), level.end(), lo, m_cmp);
+                const auto last = std::lower_bound(first, level.end(), hi, m_cmp);
+                n += static_cast<size_type>(last - first);
+            });
+            for (auto const& v : m_buffer) {
+                n += !m_cmp(v, lo) && m_cmp(v, hi);
+            }
+            return n;
+        }
+
+        // every element in order as one contiguous run, merging the buffer and every level first
+        dyn_array<T> const& sorted() {
+            flush();
+            while (!m_levels.is_empty()) {
+                _merge_into(_older_than_newest(), m_levels.back());
+                m_levels.remove_at(m_levels.size() - 1);
+            }
+            return m_sorted;
+        }
+
+        // the oldest level alone, without newer levels or what is still buffered
+        dyn_array_always_inline dyn_array<T> const& sorted_run() const noexcept {
+            return m_sorted;
+        }
+
+        // sorted levels, the oldest included
+        dyn_array_always_inline size_type levels() const noexcept {
+            return m_levels.size() + 1;
+        }
+
+        dyn_array_always_inline size_type buffered() const noexcept {
+            return m_buffer.size();
+        }
+
+        size_type size() const noexcept {
+            size_type n = m_sorted.size() + m_buffer.size();
+            for (auto const& level : m_levels) {
+                n += level.size();
+            }
+            return n;
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_sorted.is_empty() && m_levels.is_empty() && m_buffer.is_empty();
+        }
+
+        void clear() {
+            m_sorted.clear();
+            m_levels.clear();
+            m_buffer.clear();
+        }
+
+        dyn_array_always_inline merge_policy const& policy() const noexcept {
+            return m_policy;
+        }
+
+        void set_policy(merge_policy policy) {
+            m_policy = policy;
+            _maybe_flush();
+        }
+    };
+}
+
+#endif
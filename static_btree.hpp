@@ -0,0 +1,166 @@
+#ifndef STATIC_BTREE_HPP
+#define STATIC_BTREE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // read-only S+tree index over a sorted array it does not own: the array itself is the leaf level and
+    // the internal levels live in one cache-line-aligned dyn_array, each node one 64-byte line of
+    // separators compared against the key in one to four SIMD instructions. A lookup touches one line per
+    // level, log_(B+1)(n / B) lines in all, where binary search touches about log2(n). Results are positions
+    // in the indexed array; like dyn_array_view, the index is invalidated by anything that modifies or
+    // reallocates that array. NaN keys are not supported
+    template <typename T>
+    class static_btree {
+
+        static_assert(detail::simd::is_element<T>::value);
+
+    public:
+
+        using value_type = T;
+        using size_type = std::size_t;
+
+        // separators per node
+        static constexpr size_type node_keys = 64 / sizeof(T);
+
+    private:
+
+        static constexpr size_type B = node_keys;
+
+        dyn_array<T, detail::aligned_allocator<T, 64>> m_index;
+        dyn_array<size_type> m_levels; // m_levels[h] is where internal level h starts in m_index; [0] is unused
+        T const* m_keys = nullptr;
+        size_type m_size = 0;
+
+        // greater than or equal to every key, so padding separators never send a search right
+        static constexpr T _pad() noexcept {
+            if constexpr (std::numeric_limits<T>::has_infinity) {
+                return std::numeric_limits<T>::infinity();
+            } else {
+                return std::numeric_limits<T>::max();
+            }
+        }
+
+    public:
+
+        static_btree() = default;
+
+        // O(n): each separator is read straight from the leaves, nothing is sorted or compared
+        explicit static_btree(dyn_array_view<T const> sorted)
+            : m_keys{sorted.data()}
+            , m_size{static_cast<size_type>(sorted.size())} {
+            assert(std::is_sorted(sorted.begin(), sorted.end()));
+
+            // level h + 1 has a node for every B + 1 nodes of level h
+            m_levels.push_back(0);
+            size_type level_keys = (m_size + B - 1) / B * B;
+            size_type total = 0;
+            while (level_keys > B) {
+                level_keys = (level_keys / B + B) / (B + 1) * B;
+                m_levels.push_back(total);
+                total += level_keys;
+            }
+
+            m_index.resize_and_overwrite(total, [&](T* p, size_type n) {
+                for (size_type h = 1; h < m_levels.size(); ++h) {
+                    const size_type end = h + 1 < m_levels.size() ? m_levels[h + 1] : n;
+                    // key j of a node is the first leaf under its child j + 1, reached by always going left
+                    size_type scale = 1;
+                    for (size_type l = 1; l < h; ++l) {
+                        scale *= B + 1;
+                    }
+                    for (size_type i = m_levels[h]; i < end; ++i) {
+                        const size_type r = i - m_levels[h];
+                        const size_type leaf = ((r / B) * (B + 1) + r % B + 1) * scale * B;
+                        p[i] = leaf < m_size ? m_keys[leaf] : _pad();
+                    }
+                }
+                return n;
+            });
+        }
+
+        // first position whose key is not less than x, size() if none
+        size_type lower_bound(T x) const noexcept {
+            if (m_size == 0) {
+                return 0;
+            }
+            size_type pos;
+            detail::simd::btree_lower_bound(m_index.data(), m_levels.data(), m_levels.size(), m_keys, m_size, &x, 1, &pos);
+            return pos;
+        }
+
+        // one lower_bound per query, without a dispatch per query
+        dyn_array<size_type> lower_bound_all(dyn_array_view<T const> xs) const {
+            dyn_array<size_type> out;
+            out.resize_and_overwrite(static_cast<size_type>(xs.size()), [&](size_type* p, size_type n) {
+                if (m_size == 0) {
+                    std::fill(p, p + n, size_type{0});
+                } else {
+                    detail::simd::btree_lower_bound(m_index.data(), m_levels.data(), m_levels.size(), m_keys, m_size, xs.data(), n, p);
+                }
+                return n;
+            });
+            return out;
+        }
+
+        // first position whose key is greater than x: a second descent for the next representable key, so long
+        // runs of equal keys cost no more than any other lookup
+        size_type upper_bound(T x) const noexcept {
+            if constexpr (std::is_floating_point<T>::value) {
+                return x == std::numeric_limits<T>::infinity() ? m_size : lower_bound(std::nextafter(x, std::numeric_limits<T>::infinity()));
+            } else {
+                return x == std::numeric_limits<T>::max() ? m_size : lower_bound(static_cast<T>(x + 1));
+            }
+        }
+
+        // position of a key equal to x, size() if there is none
+        size_type find(T x) const noexcept {
+            const size_type lb = lower_bound(x);
+            return lb < m_size && m_keys[lb] == x ? lb : m_size;
+        }
+
+        dyn_array_always_inline bool contains(T x) const noexcept {
+            return find(x) != m_size;
+        }
+
+        // the run of keys equal to x, as a view into the indexed array
+        dyn_array_view<T const> equal_range(T x) const noexcept {
+            const size_type lb = lower_bound(x);
+            const size_type ub = upper_bound(x);
+            return dyn_array_view<T const>(m_keys + lb, ub - lb);
+        }
+
+        // keys in [lo, hi), as a view into the indexed array
+        dyn_array_view<T const> range(T lo, T hi) const noexcept {
+            const size_type first = lower_bound(lo);
+            const size_type last = hi < lo ? first : lower_bound(hi);
+            return dyn_array_view<T const>(m_keys + first, last - first);
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_size;
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_size == 0;
+        }
+
+        // levels including the leaves
+        dyn_array_always_inline size_type height() const noexcept {
+            return m_levels.size();
+        }
+
+        // memory taken by the internal levels, on top of the indexed array
+        dyn_array_always_inline size_type index_bytes() const noexcept {
+            return m_index.size() * sizeof(T);
+        }
+    };
+}
+
+#endif
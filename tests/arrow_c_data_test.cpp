@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "arrow_c_data.hpp"
+#include "check.hpp"
+
+// export_to_arrow / arrow_array_view::import round-trips: the values come back without a copy, the release
+// callbacks free the storage exactly once through the array's own allocator, and rejected arrays stay with
+// the caller
+
+using namespace cz;
+
+namespace {
+
+    long live_allocations = 0;
+
+    template <typename T>
+    struct counting_allocator : std::allocator<T> {
+        template <typename U>
+        struct rebind {
+            using other = counting_allocator<U>;
+        };
+
+        counting_allocator() = default;
+
+        template <typename U>
+        counting_allocator(counting_allocator<U> const&) noexcept {
+        }
+
+        T* allocate(std::size_t n) {
+            ++live_allocations;
+            return std::allocator<T>::allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            --live_allocations;
+            std::allocator<T>::deallocate(p, n);
+        }
+    };
+
+    template <typename T>
+    void test_round_trip() {
+        {
+            dyn_array<T, counting_allocator<T>> a;
+            for (int i = 0; i < 1000; ++i) {
+                a.push_back(static_cast<T>(i * 3));
+            }
+            T const* storage = a.data();
+
+            ArrowArray array;
+            ArrowSchema schema;
+            export_to_arrow(std::move(a), &array, &schema, "values");
+            CZ_CHECK(a.data() == nullptr);
+            CZ_CHECK(array.length == 1000 && array.null_count == 0 && array.buffers[1] == storage);
+            CZ_CHECK(std::strcmp(schema.name, "values") == 0);
+
+            auto view = arrow_array_view<T>::import(&array, &schema);
+            CZ_CHECK(view.has_value());
+            CZ_CHECK(array.release == nullptr); // ownership moved into the view
+            CZ_CHECK(view->data() == storage && view->view().size() == 1000);
+            for (std::size_t i = 0; i < 1000; ++i) {
+                CZ_CHECK((*view)[i] == static_cast<T>(i * 3));
+            }
+            CZ_CHECK(live_allocations == 1);
+
+            schema.release(&schema);
+            CZ_CHECK(schema.release == nullptr);
+        }
+        CZ_CHECK(live_allocations == 0);
+    }
+
+    void test_rejections() {
+        dyn_array<std::int32_t, counting_allocator<std::int32_t>> a(std::size_t{16}, 7);
+        ArrowArray array;
+        ArrowSchema schema;
+        export_to_arrow(std::move(a), &array, &schema);
+
+        // wrong element type: nothing is taken
+        CZ_CHECK(!arrow_array_view<float>::import(&array, &schema).has_value());
+        CZ_CHECK(array.release != nullptr);
+
+        // nulls, counted or behind a validity buffer, are refused
+        const std::uint8_t validity[2] = {0xff, 0xfe};
+        array.null_count = 1;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        array.null_count = -1;
+        array.buffers[0] = validity;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        CZ_CHECK(array.release != nullptr);
+
+        // dictionary-encoded columns and nested types carry indices or child arrays, not values
+        ArrowSchema dictionary_values = schema;
+        schema.dictionary = &dictionary_values;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        schema.dictionary = nullptr;
+        ArrowArray dictionary_array = array;
+        array.dictionary = &dictionary_array;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        array.dictionary = nullptr;
+        array.n_children = 1;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        array.n_children = 0;
+        schema.n_children = 1;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        schema.n_children = 0;
+
+        // values misaligned for the element type
+        const void* values = array.buffers[1];
+        array.buffers[1] = static_cast<char const*>(values) + 1;
+        CZ_CHECK(!arrow_array_view<std::int32_t>::import(&array, &schema).has_value());
+        array.buffers[1] = values;
+        CZ_CHECK(array.release != nullptr);
+
+        // an unknown null count without a validity buffer means no nulls
+        array.buffers[0] = nullptr;
+        {
+            auto view = arrow_array_view<std::int32_t>::import(&array, &schema);
+            CZ_CHECK(view.has_value() && view->view().size() == 16 && (*view)[15] == 7);
+        }
+        CZ_CHECK(live_allocations == 0);
+        schema.release(&schema);
+    }
+}
+
+int main() {
+    test_round_trip<std::int8_t>();
+    test_round_trip<std::uint16_t>();
+    test_round_trip<std::int32_t>();
+    test_round_trip<std::uint64_t>();
+    test_round_trip<float>();
+    test_round_trip<double>();
+    test_rejections();
+    return test::report("arrow_c_data");
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bloom_filter.hpp"
+#include "check.hpp"
+
+// blocked and counting Bloom filters: no false negatives under inserts, unions, removals and word round-trips,
+// batched lookups agree with single ones at every kernel level, and the measured false positive rate stays near
+// the one the filter was sized for
+
+using namespace cz;
+
+namespace {
+
+    dyn_array<std::uint64_t> distinct_keys(std::size_t n, std::uint64_t tag) {
+        dyn_array<std::uint64_t> keys;
+        auto& rng = test::rng();
+        for (std::size_t i = 0; i < n; ++i) {
+            keys.push_back((rng() << 8) | tag); // the low byte keeps sets built with different tags disjoint
+        }
+        return keys;
+    }
+
+    template <typename Filter>
+    double false_positive_rate(Filter const& f) {
+        const auto absent = distinct_keys(200000, 0xff);
+        const auto hits = f.contains_all(absent);
+        return static_cast<double>(std::count(hits.begin(), hits.end(), std::uint8_t{1})) / static_cast<double>(absent.size());
+    }
+
+    void test_blocked(simd_level) {
+        for (double rate : {0.1, 0.01, 0.001}) {
+            const auto keys = distinct_keys(20000, 1);
+            blocked_bloom_filter f(keys.size(), rate);
+            for (std::size_t i = 0; i < keys.size() / 2; ++i) {
+                f.insert(keys[i]);
+            }
+            f.insert_all(dyn_array_view<std::uint64_t const>(keys.data() + keys.size() / 2, keys.size() - keys.size() / 2));
+
+            const auto found = f.contains_all(keys);
+            CZ_CHECK(found.size() == keys.size() && std::count(found.begin(), found.end(), std::uint8_t{1}) == static_cast<std::ptrdiff_t>(keys.size()));
+            const auto probes = distinct_keys(5000, 2);
+            const auto batch = f.contains_all(probes);
+            bool agree = true;
+            for (std::size_t i = 0; i < probes.size(); ++i) {
+                agree = agree && batch[i] == (f.contains(probes[i]) ? 1 : 0);
+            }
+            CZ_CHECK(agree);
+            const double measured = false_positive_rate(f);
+            CZ_CHECK(measured < rate * 1.5);
+
+            // the raw words are the serialized form
+            auto copy = blocked_bloom_filter::from_words(f.words().view());
+            CZ_CHECK(copy.has_value() && copy->blocks() == f.blocks() && copy->contains_all(probes) == batch);
+            CZ_CHECK(!blocked_bloom_filter::from_words(dyn_array_view<std::uint64_t const>(f.words().data(), 3)).has_value());
+            CZ_CHECK(!blocked_bloom_filter::from_words(dyn_array_view<std::uint64_t const>()).has_value());
+
+            // a union holds both key sets
+            blocked_bloom_filter g(keys.size(), rate);
+            g.insert_all(probes);
+            g |= f;
+            const auto union_probes = g.contains_all(probes);
+            CZ_CHECK(g.contains_all(keys) == found && std::count(union_probes.begin(), union_probes.end(), std::uint8_t{1}) == 5000);
+
+            f.clear();
+            CZ_CHECK(std::all_of(f.words().begin(), f.words().end(), [](std::uint64_t w) { return w == 0; }));
+            CZ_CHECK(!f.contains(keys[0]));
+        }
+
+        blocked_bloom_filter strings(1000);
+        std::vector<std::string> words;
+        for (int i = 0; i < 1000; ++i) {
+            words.push_back("key-" + std::to_string(i));
+            strings.insert(words.back());
+        }
+        CZ_CHECK(std::all_of(words.begin(), words.end(), [&](std::string const& w) { return strings.contains(w); }));
+    }
+
+    void test_counting() {
+        auto& rng = test::rng();
+        const auto keys = distinct_keys(3000, 3);
+        counting_bloom_filter f(keys.size() * 4, 0.01);
+        std::map<std::uint64_t, int> ref;
+        for (int step = 0; step < 20000; ++step) {
+            const std::uint64_t k = keys[rng() % keys.size()];
+            // at most three copies of a key, so no counter comes near saturating
+            if (ref[k] == 0 || (ref[k] < 3 && rng() % 2 == 0)) {
+                f.insert(k);
+                ++ref[k];
+            } else {
+                f.remove(k);
+                --ref[k];
+            }
+            if (step % 1000 == 0) {
+                bool none_lost = true;
+                for (auto const& [key, count] : ref) {
+                    none_lost = none_lost && (count == 0 || f.contains(key));
+                }
+                CZ_CHECK(none_lost);
+            }
+        }
+
+        // batched removal of everything left brings every counter back to zero
+        dyn_array<std::uint64_t> remaining;
+        for (auto const& [key, count] : ref) {
+            for (int c = 0; c < count; ++c) {
+                remaining.push_back(key);
+            }
+        }
+        const auto present = f.contains_all(remaining);
+        CZ_CHECK(std::all_of(present.begin(), present.end(), [](std::uint8_t b) { return b == 1; }));
+        auto copy = counting_bloom_filter::from_words(f.words().view());
+        CZ_CHECK(copy.has_value() && copy->contains_all(remaining) == present);
+        f.remove_all(remaining);
+        CZ_CHECK(std::all_of(f.words().begin(), f.words().end(), [](std::uint64_t w) { return w == 0; }));
+
+        counting_bloom_filter sized(20000, 0.01);
+        sized.insert_all(distinct_keys(20000, 4));
+        CZ_CHECK(false_positive_rate(sized) < 0.015);
+
+        // counters saturate rather than wrap: a key inserted past 15 times stays present after as many removals
+        counting_bloom_filter small(10);
+        for (int i = 0; i < 40; ++i) {
+            small.insert(std::uint64_t{42});
+        }
+        for (int i = 0; i < 40; ++i) {
+            small.remove(std::uint64_t{42});
+        }
+        CZ_CHECK(small.contains(std::uint64_t{42}));
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_blocked(level);
+    });
+    test_counting();
+    return test::report("bloom_filter");
+}
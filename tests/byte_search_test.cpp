@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+#include "dyn_array_simd.hpp"
+
+// find_bytes against std::search at every level the CPU supports, on a three-letter alphabet so partial
+// matches are frequent, with needles taken from the haystack or made up; then the byte-array members
+// find(pattern), find_any_of (byte sets on both sides of the 16-byte kernel limit) and split_on
+
+using namespace cz;
+
+namespace {
+
+    void test_find_bytes(simd_level) {
+        auto& rng = test::rng();
+        for (std::size_t n : test::kernel_lengths) {
+            std::vector<std::uint8_t> hay(n);
+            for (auto& b : hay) {
+                b = static_cast<std::uint8_t>('a' + rng() % 3);
+            }
+            for (std::size_t k = 0; k <= 40 && k <= n + 1; k += (k < 6 ? 1 : 7)) {
+                std::vector<std::uint8_t> needle(k);
+                if (k <= n && rng() % 2 == 0) {
+                    const std::size_t at = rng() % (n - k + 1);
+                    std::copy(hay.begin() + static_cast<std::ptrdiff_t>(at), hay.begin() + static_cast<std::ptrdiff_t>(at + k), needle.begin());
+                } else {
+                    for (auto& b : needle) {
+                        b = static_cast<std::uint8_t>('a' + rng() % 3);
+                    }
+                }
+                std::size_t ref = k == 0 ? 0 : n;
+                if (k != 0) {
+                    const auto it = std::search(hay.begin(), hay.end(), needle.begin(), needle.end());
+                    ref = it == hay.end() ? n : static_cast<std::size_t>(it - hay.begin());
+                }
+                CZ_CHECK(detail::simd::find_bytes(hay.data(), n, needle.data(), k) == ref);
+            }
+        }
+    }
+
+    template <typename B>
+    dyn_array<B> bytes_of(std::string const& text) {
+        dyn_array<B> a;
+        for (char c : text) {
+            a.push_back(static_cast<B>(c));
+        }
+        return a;
+    }
+
+    template <typename B>
+    void test_find_pattern() {
+        auto& rng = test::rng();
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{64}, std::size_t{300}}) {
+            std::string hay(n, 'a');
+            for (auto& c : hay) {
+                c = static_cast<char>('a' + rng() % 3);
+            }
+            const auto a = bytes_of<B>(hay);
+            for (std::size_t k = 0; k <= 9; ++k) {
+                std::string needle(k, 'a');
+                for (auto& c : needle) {
+                    c = static_cast<char>('a' + rng() % 3);
+                }
+                const auto pattern = bytes_of<B>(needle);
+                // an empty pattern matches at the front, as with std::search
+                const auto at = std::search(hay.begin(), hay.end(), needle.begin(), needle.end()) - hay.begin();
+                CZ_CHECK(a.find(pattern.view()) == a.begin() + at);
+            }
+        }
+    }
+
+    template <typename B>
+    void test_find_any_of() {
+        auto& rng = test::rng();
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{31}, std::size_t{100}, std::size_t{1000}}) {
+            std::string hay(n, '\0');
+            for (auto& c : hay) {
+                c = static_cast<char>(rng() % 256);
+            }
+            const auto a = bytes_of<B>(hay);
+            dyn_array<B> const& ca = a;
+            // 17 and up go through the 256-entry table instead of the kernel
+            for (std::size_t m : {0, 1, 2, 15, 16, 17, 18, 40, 100, 200}) {
+                std::string set(m, '\0');
+                for (auto& c : set) {
+                    c = static_cast<char>(rng() % 256);
+                }
+                const auto bytes = bytes_of<B>(set);
+                const auto at = std::find_first_of(hay.begin(), hay.end(), set.begin(), set.end()) - hay.begin();
+                CZ_CHECK(a.find_any_of(bytes.view()) == a.begin() + at && ca.find_any_of(bytes.view()) == ca.begin() + at);
+            }
+        }
+
+        // a large set whose only present byte sits at the end of the haystack
+        std::string hay(500, 'x');
+        hay.back() = '#';
+        std::string set;
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            set += static_cast<char>(c);
+        }
+        const auto a = bytes_of<B>(hay);
+        CZ_CHECK(a.find_any_of(bytes_of<B>(set).view()) == a.end());
+        set += '#';
+        CZ_CHECK(a.find_any_of(bytes_of<B>(set).view()) == a.begin() + 499);
+    }
+
+    std::vector<std::string> split_reference(std::string const& text, char delim) {
+        std::vector<std::string> fields(1);
+        for (char c : text) {
+            if (c == delim) {
+                fields.emplace_back();
+            } else {
+                fields.back() += c;
+            }
+        }
+        return fields;
+    }
+
+    template <typename B>
+    void test_split_on() {
+        auto& rng = test::rng();
+        std::vector<std::string> texts = {"", ",", ",,", "a", ",a", "a,", ",a,", "a,,b", ",,a,,b,,", "abc,de,f"};
+        for (int round = 0; round < 200; ++round) {
+            std::string t(rng() % 80, 'a');
+            for (auto& c : t) {
+                c = rng() % 3 == 0 ? ',' : static_cast<char>('a' + rng() % 26);
+            }
+            texts.push_back(t);
+        }
+        for (auto const& text : texts) {
+            const auto a = bytes_of<B>(text);
+            const auto fields = a.split_on(static_cast<B>(','));
+            const auto ref = split_reference(text, ',');
+            CZ_CHECK(fields.size() == ref.size());
+            for (std::size_t i = 0; i < fields.size() && i < ref.size(); ++i) {
+                const auto expect = bytes_of<B>(ref[i]);
+                CZ_CHECK(fields[i].size() == expect.size() && std::equal(fields[i].begin(), fields[i].end(), expect.begin()));
+                // fields alias the array
+                CZ_CHECK(fields[i].data() >= a.data() && fields[i].data() + fields[i].size() <= a.data() + a.size());
+            }
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_find_bytes(level);
+        test_find_pattern<char>();
+        test_find_pattern<std::uint8_t>();
+        test_find_any_of<char>();
+        test_find_any_of<std::uint8_t>();
+        test_split_on<char>();
+        test_split_on<std::int8_t>();
+    });
+    return test::report("byte_search");
+}
@@ -0,0 +1,78 @@
+#ifndef CZ_TESTS_CHECK_HPP
+#define CZ_TESTS_CHECK_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "dyn_array_simd.hpp"
+
+// minimal harness: CZ_CHECK reports the failing expression and keeps going, main returns the failure count
+
+namespace cz {
+    namespace test {
+        inline int& failures() noexcept {
+            static int n = 0;
+            return n;
+        }
+
+        inline char const* level_name(simd_level level) noexcept {
+            switch (level) {
+            case simd_level::avx512:
+                return "avx512";
+            case simd_level::avx2:
+                return "avx2";
+            case simd_level::sse42:
+                return "sse42";
+            default:
+                return "scalar";
+            }
+        }
+
+        // runs f once with every kernel level the CPU supports forced in turn, scalar first
+        template <typename F>
+        void for_each_simd_level(F&& f) {
+            const simd_level supported = detail::simd::detect_level();
+            for (int l = 0; l <= static_cast<int>(supported); ++l) {
+                set_simd_level(static_cast<simd_level>(l));
+                f(static_cast<simd_level>(l));
+            }
+            set_simd_level(supported);
+        }
+
+        inline std::mt19937_64& rng() {
+            static std::mt19937_64 r(0x5eed);
+            return r;
+        }
+
+        // lengths covering empty input, partial vectors and the scalar tails of every kernel width
+        constexpr std::size_t kernel_lengths[] = {0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256, 300, 1000, 4099};
+
+        // values in [-range / 4, range * 3 / 4), wrapped into T, so small ranges repeat and include negatives
+        template <typename T>
+        std::vector<T> random_values(std::size_t n, int range) {
+            std::vector<T> v(n);
+            for (auto& x : v) {
+                x = static_cast<T>(static_cast<int>(rng()() % static_cast<std::uint64_t>(range)) - range / 4);
+            }
+            return v;
+        }
+
+        inline int report(char const* name) {
+            std::printf("%s: %d failure(s)\n", name, failures());
+            return failures() == 0 ? 0 : 1;
+        }
+    }
+}
+
+#define CZ_CHECK(cond)                                                                                      \
+    do {                                                                                                    \
+        if (!(cond)) {                                                                                      \
+            ++::cz::test::failures();                                                                       \
+            std::fprintf(stderr, "%s:%d: check failed: %s [%s]\n", __FILE__, __LINE__, #cond,               \
+                         ::cz::test::level_name(::cz::active_simd_level()));                               \
+        }                                                                                                   \
+    } while (0)
+
+#endif
@@ -0,0 +1,123 @@
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "check.hpp"
+#include "column_table.hpp"
+
+// column_table against plain loops over std::vector columns: filter (fresh and narrowing), gather and group_by,
+// single-threaded and split across threads, with tables small enough for one chunk and large enough for several
+
+using namespace cz;
+
+namespace {
+
+    struct reference_group {
+        std::uint64_t count = 0;
+        std::int64_t sum = 0, min = 0, max = 0;
+    };
+
+    void test_table(std::size_t rows) {
+        auto& rng = test::rng();
+        std::vector<std::int32_t> keys(rows);
+        std::vector<std::int64_t> values(rows);
+        std::vector<double> weights(rows);
+        dyn_array<std::int32_t> key_col;
+        dyn_array<std::int64_t> value_col;
+        dyn_array<double> weight_col;
+        for (std::size_t i = 0; i < rows; ++i) {
+            keys[i] = static_cast<std::int32_t>(rng() % 97) - 40;
+            values[i] = static_cast<std::int64_t>(rng() % 2001) - 1000;
+            weights[i] = static_cast<double>(rng() % 64); // small integers sum exactly in any order
+            key_col.push_back(keys[i]);
+            value_col.push_back(values[i]);
+            weight_col.push_back(weights[i]);
+        }
+
+        column_table t;
+        t.add_column("key", std::move(key_col));
+        t.add_column("value", std::move(value_col));
+        t.add_column("weight", std::move(weight_col));
+        CZ_CHECK(t.rows() == rows && t.columns() == 3 && t.has_column("value") && !t.has_column("values"));
+        CZ_CHECK(t.names() == (dyn_array<std::string>{"key", "value", "weight"}));
+
+        selection_vector positive, positive_even_key;
+        for (std::size_t i = 0; i < rows; ++i) {
+            if (values[i] > 0) {
+                positive.push_back(static_cast<std::uint32_t>(i));
+                if (keys[i] % 2 == 0) {
+                    positive_even_key.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+
+        for (unsigned threads : {0u, 1u, 2u, 3u, 8u}) {
+            const auto sel = t.filter<std::int64_t>("value", [](std::int64_t v) { return v > 0; }, threads);
+            CZ_CHECK(sel == positive);
+        }
+        const auto narrowed = t.filter<std::int32_t>("key", [](std::int32_t k) { return k % 2 == 0; }, positive);
+        CZ_CHECK(narrowed == positive_even_key);
+
+        const column_table g = t.gather(narrowed);
+        CZ_CHECK(g.rows() == narrowed.size() && g.names() == t.names());
+        bool gathered = true;
+        for (std::size_t j = 0; j < narrowed.size(); ++j) {
+            const std::size_t i = narrowed[j];
+            gathered = gathered && g.column<std::int32_t>("key")[j] == keys[i] && g.column<std::int64_t>("value")[j] == values[i]
+                && g.column<double>("weight")[j] == weights[i];
+        }
+        CZ_CHECK(gathered);
+
+        // reference aggregates, with keys in order of first appearance
+        std::vector<std::int32_t> order;
+        std::map<std::int32_t, reference_group> ref;
+        std::map<std::int32_t, double> ref_weight;
+        for (std::size_t i = 0; i < rows; ++i) {
+            auto it = ref.find(keys[i]);
+            if (it == ref.end()) {
+                order.push_back(keys[i]);
+                it = ref.emplace(keys[i], reference_group{0, 0, values[i], values[i]}).first;
+            }
+            auto& r = it->second;
+            ++r.count;
+            r.sum += values[i];
+            r.min = std::min(r.min, values[i]);
+            r.max = std::max(r.max, values[i]);
+            ref_weight[keys[i]] += weights[i];
+        }
+
+        for (unsigned threads : {1u, 2u, 5u}) {
+            const auto groups = t.group_by<std::int32_t, std::int64_t>("key", "value", threads);
+            CZ_CHECK(groups.size() == order.size());
+            for (std::size_t k = 0; k < groups.size() && k < order.size(); ++k) {
+                auto const& r = ref[order[k]];
+                CZ_CHECK(groups.keys[k] == order[k] && groups.count[k] == r.count && groups.sum[k] == r.sum);
+                CZ_CHECK(groups.min[k] == r.min && groups.max[k] == r.max);
+            }
+
+            const auto weighted = t.group_by<std::int32_t, double>("key", "weight", threads);
+            CZ_CHECK(weighted.size() == order.size());
+            for (std::size_t k = 0; k < weighted.size() && k < order.size(); ++k) {
+                CZ_CHECK(weighted.sum[k] == ref_weight[order[k]]);
+            }
+        }
+
+        // grouping only the selected rows
+        std::map<std::int32_t, std::int64_t> selected_sum;
+        for (auto i : positive) {
+            selected_sum[keys[i]] += values[i];
+        }
+        const auto selected = t.group_by<std::int32_t, std::int64_t>("key", "value", positive);
+        CZ_CHECK(selected.size() == selected_sum.size());
+        for (std::size_t k = 0; k < selected.size(); ++k) {
+            CZ_CHECK(selected.sum[k] == selected_sum[selected.keys[k]]);
+        }
+    }
+}
+
+int main() {
+    for (std::size_t rows : {std::size_t{0}, std::size_t{1}, std::size_t{100}, std::size_t{5000}, std::size_t{100000}}) {
+        test_table(rows);
+    }
+    return test::report("column_table");
+}
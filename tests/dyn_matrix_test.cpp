@@ -0,0 +1,234 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_matrix.hpp"
+
+// md_view layouts against their index arithmetic, layout_tiled padding on shapes off the tile grid, and
+// dyn_matrix element access, layout conversion and copy/move against a row-major std::vector
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    T make(std::uint64_t v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(v % 40, static_cast<char>('a' + v % 26));
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+
+    const std::size_t odd_dims[] = {1, 2, 3, 5, 7, 13, 17};
+
+    void test_dense_layouts() {
+        for (std::size_t e0 : odd_dims) {
+            for (std::size_t e1 : odd_dims) {
+                for (std::size_t e2 : {std::size_t{1}, std::size_t{3}, std::size_t{5}}) {
+                    const md_extents<3> ext(e0, e1, e2);
+                    const layout_right::mapping<3, std::size_t> right(ext);
+                    const layout_left::mapping<3, std::size_t> left(ext);
+                    CZ_CHECK(ext.size() == e0 * e1 * e2);
+                    CZ_CHECK(right.required_span_size() == ext.size());
+                    CZ_CHECK(left.required_span_size() == ext.size());
+                    CZ_CHECK(right.stride(2) == 1 && right.stride(1) == e2 && right.stride(0) == e1 * e2);
+                    CZ_CHECK(left.stride(0) == 1 && left.stride(1) == e0 && left.stride(2) == e0 * e1);
+                    for (std::size_t i = 0; i < e0; ++i) {
+                        for (std::size_t j = 0; j < e1; ++j) {
+                            for (std::size_t k = 0; k < e2; ++k) {
+                                CZ_CHECK(right(i, j, k) == (i * e1 + j) * e2 + k);
+                                CZ_CHECK(left(i, j, k) == i + e0 * (j + e1 * k));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void test_stride_layout() {
+        for (std::size_t rows : odd_dims) {
+            for (std::size_t cols : odd_dims) {
+                // every other column of a wider row-major buffer, and a row-padded column-major one
+                const std::size_t pad = 3;
+                const layout_stride::mapping<2, std::size_t> sparse(md_extents<2>(rows, cols), {2 * cols + pad, 2});
+                const layout_stride::mapping<2, std::size_t> padded(md_extents<2>(rows, cols), {1, rows + pad});
+                CZ_CHECK(sparse.required_span_size() == (rows - 1) * (2 * cols + pad) + (cols - 1) * 2 + 1);
+                CZ_CHECK(padded.required_span_size() == (rows - 1) + (cols - 1) * (rows + pad) + 1);
+                for (std::size_t i = 0; i < rows; ++i) {
+                    for (std::size_t j = 0; j < cols; ++j) {
+                        CZ_CHECK(sparse(i, j) == i * (2 * cols + pad) + j * 2);
+                        CZ_CHECK(padded(i, j) == i + j * (rows + pad));
+                    }
+                }
+            }
+        }
+        const layout_stride::mapping<2, std::size_t> empty(md_extents<2>(0, 5), {5, 1});
+        CZ_CHECK(empty.required_span_size() == 0);
+    }
+
+    template <std::size_t TR, std::size_t TC>
+    void test_tiled_shape(std::size_t rows, std::size_t cols) {
+        using mapping_t = typename layout_tiled<TR, TC>::template mapping<2, std::size_t>;
+        const mapping_t map(md_extents<2>(rows, cols));
+        const std::size_t tiles_down = (rows + TR - 1) / TR;
+        const std::size_t tiles_across = (cols + TC - 1) / TC;
+        const std::size_t span = tiles_down * tiles_across * TR * TC;
+        CZ_CHECK(map.required_span_size() == span);
+
+        // distinct offsets inside the padded span; the padding slots are exactly the ones no index reaches
+        std::vector<char> hit(span, 0);
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                const std::size_t off = map(i, j);
+                const std::size_t tile = (i / TR) * tiles_across + j / TC;
+                CZ_CHECK(off == tile * TR * TC + (i % TR) * TC + j % TC);
+                if (off < span) {
+                    CZ_CHECK(hit[off] == 0);
+                    hit[off] = 1;
+                } else {
+                    CZ_CHECK(off < span);
+                }
+            }
+        }
+        std::size_t used = 0;
+        for (char h : hit) {
+            used += static_cast<std::size_t>(h);
+        }
+        CZ_CHECK(used == rows * cols);
+    }
+
+    void test_tiled_layout() {
+        for (std::size_t rows = 1; rows <= 20; ++rows) {
+            for (std::size_t cols = 1; cols <= 20; ++cols) {
+                test_tiled_shape<4, 3>(rows, cols);
+                test_tiled_shape<1, 5>(rows, cols);
+                test_tiled_shape<16, 16>(rows, cols);
+            }
+        }
+    }
+
+    void test_view() {
+        const std::size_t rows = 7, cols = 5;
+        dyn_array<int> arr(rows * cols);
+        for (std::size_t k = 0; k < arr.size(); ++k) {
+            arr[k] = static_cast<int>(k);
+        }
+        auto right = make_md_view(arr, rows, cols);
+        auto left = make_md_view<layout_left>(arr, rows, cols);
+        dyn_array<int> const& carr = arr;
+        auto cview = make_md_view(carr, rows, cols);
+        CZ_CHECK(right.rank() == 2 && right.size() == rows * cols && right.extent(0) == rows && right.extent(1) == cols);
+        CZ_CHECK(right.data_handle() == arr.data() && cview.data_handle() == arr.data());
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                CZ_CHECK(right(i, j) == static_cast<int>(i * cols + j));
+                CZ_CHECK(left(i, j) == static_cast<int>(i + j * rows));
+                CZ_CHECK(&cview(i, j) == &right(i, j));
+            }
+        }
+        right(3, 4) = -1;
+        CZ_CHECK(arr[3 * cols + 4] == -1);
+    }
+
+    template <typename T, typename Layout>
+    bool same(dyn_matrix<T, Layout> const& m, std::vector<T> const& ref, std::size_t rows, std::size_t cols) {
+        if (m.rows() != rows || m.cols() != cols || m.storage().size() != m.mapping().required_span_size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                if (m(i, j) != ref[i * cols + j] || &m.view()(i, j) != &m(i, j)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename T, typename Layout>
+    void test_matrix_layout(std::size_t rows, std::size_t cols) {
+        std::vector<T> ref(rows * cols);
+        dyn_array<T> row_major(rows * cols);
+        for (std::size_t k = 0; k < ref.size(); ++k) {
+            ref[k] = make<T>(test::rng()());
+            row_major[k] = ref[k];
+        }
+
+        dyn_matrix<T, Layout> m(rows, cols, row_major);
+        CZ_CHECK(same(m, ref, rows, cols));
+
+        // writes through operator() land where the mapping says
+        const std::size_t wi = rows / 2, wj = cols - 1;
+        ref[wi * cols + wj] = make<T>(12345);
+        m(wi, wj) = ref[wi * cols + wj];
+        CZ_CHECK(m.storage()[m.mapping()(wi, wj)] == ref[wi * cols + wj]);
+        CZ_CHECK(same(m, ref, rows, cols));
+
+        dyn_matrix<T, Layout> copy(m);
+        CZ_CHECK(same(copy, ref, rows, cols));
+        CZ_CHECK(copy.data() != m.data());
+        copy(0, 0) = make<T>(999);
+        CZ_CHECK(same(m, ref, rows, cols));
+
+        dyn_matrix<T, Layout> assigned(1, 1);
+        assigned = m;
+        CZ_CHECK(same(assigned, ref, rows, cols));
+
+        dyn_matrix<T, Layout> moved(std::move(copy));
+        dyn_matrix<T, Layout> move_assigned;
+        move_assigned = std::move(assigned);
+        CZ_CHECK(same(move_assigned, ref, rows, cols));
+        moved(0, 0) = ref[0];
+        CZ_CHECK(same(moved, ref, rows, cols));
+
+        const dyn_matrix<T, layout_right> as_right(m);
+        const dyn_matrix<T, layout_left> as_left(m);
+        const dyn_matrix<T, layout_tiled<4, 3>> as_tiled(m);
+        CZ_CHECK(same(as_right, ref, rows, cols));
+        CZ_CHECK(same(as_left, ref, rows, cols));
+        CZ_CHECK(same(as_tiled, ref, rows, cols));
+        CZ_CHECK(same(dyn_matrix<T, Layout>(as_right), ref, rows, cols));
+        CZ_CHECK(same(dyn_matrix<T, Layout>(as_left), ref, rows, cols));
+        CZ_CHECK(same(dyn_matrix<T, Layout>(as_tiled), ref, rows, cols));
+
+        // the dense layouts keep their storage in exactly the index order
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                CZ_CHECK(as_right.data()[i * cols + j] == ref[i * cols + j]);
+                CZ_CHECK(as_left.data()[j * rows + i] == ref[i * cols + j]);
+            }
+        }
+    }
+
+    template <typename T>
+    void test_matrix() {
+        for (std::size_t rows : odd_dims) {
+            for (std::size_t cols : odd_dims) {
+                test_matrix_layout<T, layout_right>(rows, cols);
+                test_matrix_layout<T, layout_left>(rows, cols);
+                test_matrix_layout<T, layout_tiled<4, 3>>(rows, cols);
+                test_matrix_layout<T, layout_tiled<16, 16>>(rows, cols);
+            }
+        }
+
+        const dyn_matrix<T, layout_tiled<4, 3>> filled(5, 7, make<T>(7));
+        CZ_CHECK(filled.storage().size() == 2 * 3 * 12);
+        CZ_CHECK(same(filled, std::vector<T>(35, make<T>(7)), 5, 7));
+        CZ_CHECK(dyn_matrix<T>().rows() == 0 && dyn_matrix<T>().storage().size() == 0);
+    }
+}
+
+int main() {
+    test_dense_layouts();
+    test_stride_layout();
+    test_tiled_layout();
+    test_view();
+    test_matrix<std::uint32_t>();
+    test_matrix<double>();
+    test_matrix<std::string>();
+    return test::report("dyn_matrix");
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "external_sort.hpp"
+
+// external_sorter and external_sort_npy against std::sort, with a memory budget small enough for many runs and
+// a fan-in small enough for several merge passes; runs must sit in one owner-only directory of their own
+// and be gone afterwards, and a temp directory that cannot be written makes finish() fail cleanly
+
+using namespace cz;
+
+namespace {
+
+    std::mt19937_64 rng(0x5047);
+
+    std::filesystem::path scratch() {
+        const auto dir = std::filesystem::temp_directory_path() / "cz_external_sort_test";
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    bool no_runs_left(std::filesystem::path const& dir, std::string const& keep) {
+        for (auto const& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().filename() != keep) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the only entry of dir is a private directory holding the runs
+    bool runs_in_private_dir(std::filesystem::path const& dir) {
+        std::size_t entries = 0;
+        bool ok = true;
+        for (auto const& entry : std::filesystem::directory_iterator(dir)) {
+            ++entries;
+            const auto perms = std::filesystem::symlink_status(entry.path()).permissions();
+            ok = ok && entry.is_directory() && !entry.is_symlink()
+                && (perms & (std::filesystem::perms::group_all | std::filesystem::perms::others_all)) == std::filesystem::perms::none;
+        }
+        return ok && entries == 1;
+    }
+
+    template <typename T, typename Compare>
+    void test_sorter(std::size_t n, std::size_t budget_elems, std::size_t fan_in, Compare cmp) {
+        const auto dir = scratch();
+        const std::string out = (dir / "sorted.npy").string();
+
+        std::vector<T> ref(n);
+        for (auto& x : ref) {
+            x = static_cast<T>(static_cast<std::int64_t>(rng() % 100000) - 50000);
+        }
+
+        {
+            external_sort_options options;
+            options.memory_budget = budget_elems * sizeof(T);
+            options.temp_dir = dir.string();
+            options.max_fan_in = fan_in;
+            external_sorter<T, Compare> sorter(options, cmp);
+
+            // a third each through push, push_all and push_from
+            std::size_t i = 0;
+            for (; i < n / 3; ++i) {
+                sorter.push(ref[i]);
+            }
+            const std::size_t second = 2 * n / 3;
+            sorter.push_all(dyn_array_view<T const>(ref.data() + i, second - i));
+            i = second;
+            CZ_CHECK(sorter.spilled_runs() == 0 || runs_in_private_dir(dir));
+            sorter.push_from([&](T* dst, std::size_t max) {
+                const std::size_t take = std::min<std::size_t>({max, n - i, 777});
+                std::copy(ref.begin() + static_cast<std::ptrdiff_t>(i), ref.begin() + static_cast<std::ptrdiff_t>(i + take), dst);
+                i += take;
+                return take;
+            });
+            CZ_CHECK(sorter.size() == n);
+            CZ_CHECK(sorter.finish(out.c_str()));
+            CZ_CHECK(no_runs_left(dir, "sorted.npy"));
+        }
+
+        std::sort(ref.begin(), ref.end(), cmp);
+        dyn_array<T> got;
+        CZ_CHECK(load_npy(out.c_str(), got));
+        CZ_CHECK(got.size() == n && std::equal(got.begin(), got.end(), ref.begin()));
+        std::filesystem::remove_all(dir);
+    }
+
+    void test_npy_file() {
+        const auto dir = scratch();
+        const std::string in = (dir / "in.npy").string(), out = (dir / "out.npy").string();
+        dyn_array<double> values;
+        for (int i = 0; i < 50000; ++i) {
+            values.push_back(static_cast<double>(rng() % 1000000) / 7.0);
+        }
+        CZ_CHECK(save_npy(in.c_str(), values));
+
+        external_sort_options options;
+        options.memory_budget = 4096 * sizeof(double);
+        options.temp_dir = dir.string();
+        options.max_fan_in = 4;
+        CZ_CHECK(external_sort_npy<double>(in.c_str(), out.c_str(), options));
+
+        std::sort(values.begin(), values.end());
+        dyn_array<double> got;
+        CZ_CHECK(load_npy(out.c_str(), got) && got == values);
+
+        // the wrong element type or a missing file is refused
+        CZ_CHECK(!external_sort_npy<float>(in.c_str(), out.c_str(), options));
+        CZ_CHECK(!external_sort_npy<double>((dir / "missing.npy").string().c_str(), out.c_str(), options));
+        std::filesystem::remove_all(dir);
+    }
+
+    void test_unwritable_temp_dir() {
+        const auto dir = scratch();
+        external_sort_options options;
+        options.memory_budget = 2048 * sizeof(std::int32_t);
+        options.temp_dir = (dir / "does" / "not" / "exist").string();
+        {
+            external_sorter<std::int32_t> sorter(options);
+            for (std::int32_t i = 0; i < 10000; ++i) {
+                sorter.push(i);
+            }
+            CZ_CHECK(!sorter.finish((dir / "out.npy").string().c_str()));
+        }
+        CZ_CHECK(no_runs_left(dir, ""));
+        std::filesystem::remove_all(dir);
+    }
+}
+
+int main() {
+    test_sorter<std::int32_t>(0, 2048, 4, std::less<std::int32_t>());
+    test_sorter<std::int32_t>(1000, 2048, 4, std::less<std::int32_t>()); // fits in memory: no runs
+    test_sorter<std::int32_t>(100000, 2048, 256, std::less<std::int32_t>());
+    test_sorter<std::int32_t>(100000, 2048, 3, std::less<std::int32_t>()); // several merge passes
+    test_sorter<std::int64_t>(30000, 4096, 2, std::greater<std::int64_t>());
+    test_sorter<float>(30000, 2048, 5, std::less<float>());
+    test_npy_file();
+    test_unwritable_temp_dir();
+    return test::report("external_sort");
+}
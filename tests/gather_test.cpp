@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+#include "dyn_array_simd.hpp"
+
+// the gather kernel against dst[k] = src[idx[k]] at every level the CPU supports, with and without prefetching;
+// then the gather / scatter / apply_permutation_in_place members against naive copies, for element types on
+// and off the kernel path and for signed and unsigned index types of every width
+
+using namespace cz;
+
+namespace {
+
+    template <typename E>
+    void test_gather(simd_level) {
+        auto& rng = test::rng();
+        for (std::size_t n : test::kernel_lengths) {
+            std::vector<E> src(513);
+            for (auto& x : src) {
+                x = static_cast<E>(rng());
+            }
+            std::vector<std::uint32_t> idx(n);
+            for (auto& i : idx) {
+                i = static_cast<std::uint32_t>(rng() % src.size());
+            }
+            for (bool prefetch : {false, true}) {
+                std::vector<E> dst(n);
+                detail::simd::gather<sizeof(E)>(src.data(), idx.data(), n, dst.data(), prefetch);
+                for (std::size_t i = 0; i < n; ++i) {
+                    CZ_CHECK(dst[i] == src[idx[i]]);
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    T make(std::uint64_t v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(v % 40, static_cast<char>('a' + v % 26));
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+
+    template <typename T, typename I>
+    void test_members(std::size_t n) {
+        auto& rng = test::rng();
+        std::vector<T> ref(n);
+        dyn_array<T> a;
+        for (auto& x : ref) {
+            x = make<T>(rng());
+            a.push_back(x);
+        }
+
+        // gather: any indices, repeats included
+        for (std::size_t m : {std::size_t{0}, std::size_t{1}, std::size_t{17}, std::size_t{2 * n + 3}}) {
+            std::vector<I> idx(n == 0 ? 0 : m);
+            for (auto& i : idx) {
+                i = static_cast<I>(rng() % n);
+            }
+            const auto got = a.gather(idx);
+            CZ_CHECK(got.size() == idx.size());
+            bool ok = true;
+            for (std::size_t k = 0; k < idx.size(); ++k) {
+                ok = ok && got[k] == ref[static_cast<std::size_t>(idx[k])];
+            }
+            CZ_CHECK(ok);
+        }
+
+        // scatter: the last write to a repeated index wins
+        if (n != 0) {
+            std::vector<I> idx(n / 2 + 1);
+            dyn_array<T> values;
+            std::vector<T> expect = ref;
+            for (auto& i : idx) {
+                i = static_cast<I>(rng() % n);
+                values.push_back(make<T>(rng()));
+                expect[static_cast<std::size_t>(i)] = values.back();
+            }
+            dyn_array<T> b = a;
+            b.scatter(idx, values);
+            CZ_CHECK(b.size() == n && std::equal(b.begin(), b.end(), expect.begin()));
+        }
+
+        // apply_permutation_in_place: new[k] = old[perm[k]], and perm comes back unchanged
+        std::vector<I> perm(n);
+        std::iota(perm.begin(), perm.end(), I{0});
+        std::shuffle(perm.begin(), perm.end(), rng);
+        const std::vector<I> perm_before = perm;
+        dyn_array<T> c = a;
+        c.apply_permutation_in_place(perm);
+        CZ_CHECK(perm == perm_before);
+        bool ok = c.size() == n;
+        for (std::size_t k = 0; k < n && ok; ++k) {
+            ok = c[k] == ref[static_cast<std::size_t>(perm[k])];
+        }
+        CZ_CHECK(ok);
+
+        // the identity and a single long cycle
+        std::iota(perm.begin(), perm.end(), I{0});
+        c = a;
+        c.apply_permutation_in_place(perm);
+        CZ_CHECK(std::equal(c.begin(), c.end(), ref.begin()));
+        for (std::size_t k = 0; k < n; ++k) {
+            perm[k] = static_cast<I>((k + 1) % n);
+        }
+        c.apply_permutation_in_place(perm);
+        ok = true;
+        for (std::size_t k = 0; k < n; ++k) {
+            ok = ok && c[k] == ref[(k + 1) % n] && perm[k] == static_cast<I>((k + 1) % n);
+        }
+        CZ_CHECK(ok);
+    }
+
+    template <typename T>
+    void test_members_all_indices() {
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{33}, std::size_t{127}}) {
+            // 8-bit indices keep their top bit for the visited mark, so at most 128 elements
+            test_members<T, std::int8_t>(n);
+            test_members<T, std::uint8_t>(n);
+        }
+        for (std::size_t n : {std::size_t{0}, std::size_t{5}, std::size_t{1000}, std::size_t{4099}}) {
+            test_members<T, std::int16_t>(n);
+            test_members<T, std::int32_t>(n);
+            test_members<T, std::uint32_t>(n);
+            test_members<T, std::int64_t>(n);
+            test_members<T, std::uint64_t>(n);
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_gather<std::uint32_t>(level);
+        test_gather<std::uint64_t>(level);
+        test_members_all_indices<std::uint32_t>();
+        test_members_all_indices<double>();
+        test_members<std::int64_t, std::uint32_t>(std::size_t{1} << 17); // large enough to prefetch
+    });
+    test_members_all_indices<std::int16_t>();
+    test_members_all_indices<std::string>();
+    return test::report("gather");
+}
@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+
+// cz::hash and the std::hash specializations: equal contents hash equal whatever the storage, every single-bit
+// change is seen at every length across the short-input and three-lane paths, and dyn_array works as a map key
+
+using namespace cz;
+
+namespace {
+
+    void test_equal_contents() {
+        auto& rng = test::rng();
+        for (std::size_t n = 0; n < 300; ++n) {
+            dyn_array<std::uint8_t> a;
+            for (std::size_t i = 0; i < n; ++i) {
+                a.push_back(static_cast<std::uint8_t>(rng()));
+            }
+            // the same bytes at every misalignment
+            std::vector<std::uint8_t> buffer(n + 8);
+            for (std::size_t shift = 0; shift < 8; ++shift) {
+                if (n != 0) {
+                    std::memcpy(buffer.data() + shift, a.data(), n);
+                }
+                CZ_CHECK(hash(dyn_array_view<std::uint8_t const>(buffer.data() + shift, n)) == hash(a));
+            }
+            const dyn_array<std::uint8_t> copy = a;
+            CZ_CHECK(hash(copy) == hash(a) && hash(a.view()) == hash(a));
+            CZ_CHECK(std::hash<dyn_array<std::uint8_t>>{}(copy) == std::hash<dyn_array_view<std::uint8_t>>{}(a.view()));
+            CZ_CHECK(hash(a, 1) != hash(a, 2));
+        }
+    }
+
+    void test_bit_flips() {
+        auto& rng = test::rng();
+        for (std::size_t n = 1; n < 200; ++n) {
+            dyn_array<std::uint8_t> a;
+            for (std::size_t i = 0; i < n; ++i) {
+                a.push_back(static_cast<std::uint8_t>(rng()));
+            }
+            const std::uint64_t h = hash(a);
+            std::set<std::uint64_t> seen{h};
+            for (std::size_t i = 0; i < n; ++i) {
+                for (int bit = 0; bit < 8; ++bit) {
+                    a[i] ^= static_cast<std::uint8_t>(1u << bit);
+                    seen.insert(hash(a));
+                    a[i] ^= static_cast<std::uint8_t>(1u << bit);
+                }
+            }
+            CZ_CHECK(seen.size() == 8 * n + 1);
+            CZ_CHECK(hash(a) == h);
+        }
+
+        // a trailing zero byte is not the same content
+        dyn_array<std::uint8_t> z;
+        std::set<std::uint64_t> lengths;
+        for (std::size_t n = 0; n < 100; ++n) {
+            lengths.insert(hash(z));
+            z.push_back(0);
+        }
+        CZ_CHECK(lengths.size() == 100);
+    }
+
+    void test_non_bitwise_types() {
+        // 0.0 == -0.0, so the two must hash alike
+        const dyn_array<double> pos{0.0, 1.5}, neg{-0.0, 1.5};
+        CZ_CHECK(pos == neg && hash(pos) == hash(neg));
+        CZ_CHECK(hash(pos) != hash(dyn_array<double>{1.5, 0.0}));
+    }
+
+    void test_map_keys() {
+        auto& rng = test::rng();
+        std::unordered_map<dyn_array<std::int32_t>, int> map;
+        std::set<std::vector<std::int32_t>> ref;
+        for (int i = 0; i < 20000; ++i) {
+            dyn_array<std::int32_t> key;
+            std::vector<std::int32_t> ref_key;
+            for (std::size_t k = rng() % 6; k > 0; --k) {
+                const auto v = static_cast<std::int32_t>(rng() % 4);
+                key.push_back(v);
+                ref_key.push_back(v);
+            }
+            ++map[key];
+            ref.insert(ref_key);
+        }
+        CZ_CHECK(map.size() == ref.size());
+
+        std::unordered_set<std::uint64_t> hashes;
+        for (std::uint32_t i = 0; i < 100000; ++i) {
+            hashes.insert(hash(dyn_array<std::uint32_t>{i, i * 7}));
+        }
+        CZ_CHECK(hashes.size() == 100000);
+    }
+}
+
+int main() {
+    test_equal_contents();
+    test_bit_flips();
+    test_non_bitwise_types();
+    test_map_keys();
+    return test::report("hash");
+}
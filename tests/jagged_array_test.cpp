@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "jagged_array.hpp"
+
+// jagged_array against a std::vector of rows: building row by row or from (row, value) pairs, appending to the
+// last row, and remove_if, for a trivial and a non-trivial element type
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    T make(std::uint64_t v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(v % 40, static_cast<char>('a' + v % 26));
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+
+    template <typename T, typename SizeT>
+    bool same(jagged_array<T, std::allocator<T>, SizeT> const& j, std::vector<std::vector<T>> const& ref) {
+        if (j.rows() != ref.size() || j.is_empty() != ref.empty() || j.offsets().front() != 0) {
+            return false;
+        }
+        std::size_t total = 0;
+        for (std::size_t r = 0; r < ref.size(); ++r) {
+            auto row = j[r];
+            if (j.row_size(r) != ref[r].size() || row.size() != ref[r].size() || j.offsets()[r] != total) {
+                return false;
+            }
+            for (std::size_t i = 0; i < row.size(); ++i) {
+                if (row[i] != ref[r][i]) {
+                    return false;
+                }
+            }
+            total += ref[r].size();
+        }
+        return j.size() == total && j.values().size() == total && j.offsets().back() == total;
+    }
+
+    template <typename T, typename SizeT = std::size_t>
+    void test_random() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 200; ++round) {
+            jagged_array<T, std::allocator<T>, SizeT> j;
+            std::vector<std::vector<T>> ref;
+            for (int step = 0; step < 100; ++step) {
+                switch (rng() % 6) {
+                case 0:
+                    j.push_row();
+                    ref.emplace_back();
+                    break;
+                case 1: {
+                    std::vector<T> row;
+                    for (std::size_t k = rng() % 10; k > 0; --k) {
+                        row.push_back(make<T>(rng()));
+                    }
+                    j.push_row(row.begin(), row.end());
+                    ref.push_back(row);
+                    break;
+                }
+                case 2:
+                    if (!ref.empty()) {
+                        const std::size_t r = rng() % ref.size();
+                        std::vector<T> copy = ref[r];
+                        j.push_row(static_cast<jagged_array<T, std::allocator<T>, SizeT> const&>(j)[r]);
+                        ref.push_back(copy);
+                    }
+                    break;
+                case 3:
+                    if (!ref.empty()) {
+                        const T v = make<T>(rng());
+                        if (rng() % 2 == 0) {
+                            j.push_back(v);
+                        } else {
+                            j.emplace_back(v);
+                        }
+                        ref.back().push_back(v);
+                    }
+                    break;
+                case 4: {
+                    const std::uint64_t mod = 2 + rng() % 5;
+                    std::size_t calls = 0;
+                    j.remove_if([&](std::size_t r, T const& v) {
+                        ++calls;
+                        return (r + std::hash<T>{}(v)) % mod == 0;
+                    });
+                    std::size_t total = 0;
+                    for (std::size_t r = 0; r < ref.size(); ++r) {
+                        total += ref[r].size();
+                        std::vector<T> kept;
+                        for (auto& v : ref[r]) {
+                            if ((r + std::hash<T>{}(v)) % mod != 0) {
+                                kept.push_back(v);
+                            }
+                        }
+                        ref[r] = kept;
+                    }
+                    CZ_CHECK(calls == total);
+                    break;
+                }
+                default:
+                    if (rng() % 10 == 0) {
+                        j.clear();
+                        ref.clear();
+                    } else if (!ref.empty() && ref.back().size() > 0) {
+                        // rows are writable views into the shared values
+                        const T v = make<T>(rng());
+                        j[ref.size() - 1][0] = v;
+                        ref.back()[0] = v;
+                    }
+                }
+                CZ_CHECK(same(j, ref));
+            }
+            j.shrink_to_fit();
+            CZ_CHECK(same(j, ref));
+        }
+    }
+
+    // SizeT also types the offsets and the row indices, as in CSR with 32-bit offsets
+    template <typename SizeT>
+    void test_from_pairs() {
+        using jagged = jagged_array<std::int32_t, std::allocator<std::int32_t>, SizeT>;
+        auto& rng = test::rng();
+        for (int round = 0; round < 100; ++round) {
+            const SizeT rows = static_cast<SizeT>(rng() % 20);
+            std::vector<std::vector<std::int32_t>> ref(rows);
+            dyn_array<SizeT> row_of;
+            typename jagged::values_type values;
+            if (rows != 0) {
+                for (std::size_t k = rng() % 300; k > 0; --k) {
+                    const SizeT r = static_cast<SizeT>(rng() % rows);
+                    const auto v = static_cast<std::int32_t>(rng());
+                    row_of.push_back(r);
+                    values.push_back(v);
+                    ref[r].push_back(v);
+                }
+            }
+            CZ_CHECK(same(jagged::from_pairs(row_of, values, rows), ref));
+        }
+    }
+}
+
+int main() {
+    test_random<std::int32_t>();
+    test_random<std::string>();
+    test_random<std::int32_t, std::uint32_t>();
+    test_from_pairs<std::size_t>();
+    test_from_pairs<std::uint32_t>();
+    return test::report("jagged_array");
+}
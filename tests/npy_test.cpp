@@ -0,0 +1,151 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "check.hpp"
+#include "npy.hpp"
+
+// save_npy / load_npy / npy_mapped round-trips for every dtype, and rejection of malformed and column-major
+// files without allocating what their headers claim
+
+using namespace cz;
+
+namespace {
+
+    std::mt19937_64 rng(0x9e7);
+
+    std::string temp_path(char const* name) {
+        return std::string(P_tmpdir) + "/cz_npy_test_" + name + ".npy";
+    }
+
+    void write_file(std::string const& path, std::string const& bytes) {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, bytes.size(), f);
+        std::fclose(f);
+    }
+
+    template <typename T>
+    void test_round_trip(char const* name) {
+        const std::string path = temp_path(name);
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{1000}, std::size_t{4096}}) {
+            dyn_array<T> a;
+            for (std::size_t i = 0; i < n; ++i) {
+                a.push_back(static_cast<T>(rng()));
+            }
+            CZ_CHECK(save_npy(path.c_str(), a));
+
+            dyn_array<T> b;
+            npy_header h;
+            CZ_CHECK(load_npy(path.c_str(), b, &h));
+            CZ_CHECK(b == a);
+            CZ_CHECK(h.shape.size() == 1 && h.count() == n && h.data_offset % 64 == 0);
+
+#ifdef DYN_ARRAY_NPY_POSIX
+            if (n != 0) {
+                auto m = npy_mapped<T>::open(path.c_str());
+                CZ_CHECK(m.has_value() && m->view() == a.view());
+            }
+#endif
+        }
+
+        // a wrong dtype is refused
+        dyn_array<T> a(std::size_t{8}, T(1));
+        CZ_CHECK(save_npy(path.c_str(), a));
+        dyn_array<char> wrong;
+        CZ_CHECK(sizeof(T) == 1 || !load_npy(path.c_str(), wrong));
+        std::remove(path.c_str());
+    }
+
+    void test_shapes() {
+        const std::string path = temp_path("shape");
+        dyn_array<float> a(std::size_t{24}, 1.5f);
+        CZ_CHECK(save_npy(path.c_str(), a, dyn_array<std::size_t>{2, 3, 4}));
+        CZ_CHECK(!save_npy(path.c_str(), a, dyn_array<std::size_t>{5, 5}));
+
+        dyn_array<float> b;
+        npy_header h;
+        CZ_CHECK(load_npy(path.c_str(), b, &h));
+        CZ_CHECK(b == a && h.shape == (dyn_array<std::size_t>{2, 3, 4}));
+
+        npy_array<float> aligned;
+        CZ_CHECK(load_npy(path.c_str(), aligned));
+        CZ_CHECK(aligned.view() == a.view() && reinterpret_cast<std::uintptr_t>(aligned.data()) % 64 == 0);
+        std::remove(path.c_str());
+    }
+
+    // column-major files with two or more dimensions longer than 1 would load transposed, so they are refused
+    void test_fortran_order() {
+        const std::string path = temp_path("fortran");
+        const std::string data(6 * sizeof(float), '\0');
+        const struct {
+            dyn_array<std::size_t> shape;
+            bool loads;
+        } cases[] = {{{2, 3}, false}, {{3, 1, 2}, false}, {{6}, true}, {{1, 6}, true}, {{6, 1, 1}, true}};
+        for (auto const& c : cases) {
+            std::string header = detail::npy::make_header(detail::npy::descr<float>(), c.shape);
+            const std::size_t at = header.find("False");
+            header.replace(at, 5, "True ");
+            write_file(path, header + data);
+
+            dyn_array<float> out;
+            npy_header h;
+            CZ_CHECK(load_npy(path.c_str(), out, &h) == c.loads);
+            CZ_CHECK(!c.loads || (h.fortran_order && out.size() == 6));
+#ifdef DYN_ARRAY_NPY_POSIX
+            CZ_CHECK(npy_mapped<float>::open(path.c_str()).has_value() == c.loads);
+#endif
+        }
+        std::remove(path.c_str());
+    }
+
+    void test_malformed() {
+        const std::string path = temp_path("bad");
+        dyn_array<float> out;
+
+        const std::string huge_len("xxxxxx\x02\x00\xff\xff\xff\xff", 12);
+        write_file(path, huge_len);
+        CZ_CHECK(!load_npy(path.c_str(), out));
+
+        write_file(path, std::string("\x93NUMPY\x02\x00\xff\xff\xff\xff", 12));
+        CZ_CHECK(!load_npy(path.c_str(), out));
+
+        write_file(path, std::string("\x93NUMPY\x07\x00\x10\x00", 10));
+        CZ_CHECK(!load_npy(path.c_str(), out));
+
+        // shapes promising more data than the file holds, or more than size_t can count
+        const std::size_t big = std::size_t{1} << 40;
+        for (auto const& shape : {dyn_array<std::size_t>{big}, dyn_array<std::size_t>{big, big}, dyn_array<std::size_t>{SIZE_MAX / 2}}) {
+            write_file(path, detail::npy::make_header(detail::npy::descr<float>(), shape) + "abcdabcd");
+            CZ_CHECK(!load_npy(path.c_str(), out));
+#ifdef DYN_ARRAY_NPY_POSIX
+            CZ_CHECK(!npy_mapped<float>::open(path.c_str()).has_value());
+#endif
+        }
+
+        write_file(path, detail::npy::make_header(detail::npy::descr<float>(), dyn_array<std::size_t>{3}) + "abcdabcd");
+        CZ_CHECK(!load_npy(path.c_str(), out));
+
+        // a failed load leaves the destination as it was
+        dyn_array<float> kept{1.0f, 2.0f};
+        CZ_CHECK(!load_npy(path.c_str(), kept) && kept == (dyn_array<float>{1.0f, 2.0f}));
+        std::remove(path.c_str());
+    }
+}
+
+int main() {
+    test_round_trip<std::int8_t>("i1");
+    test_round_trip<std::uint8_t>("u1");
+    test_round_trip<std::int16_t>("i2");
+    test_round_trip<std::uint16_t>("u2");
+    test_round_trip<std::int32_t>("i4");
+    test_round_trip<std::uint32_t>("u4");
+    test_round_trip<std::int64_t>("i8");
+    test_round_trip<std::uint64_t>("u8");
+    test_round_trip<float>("f4");
+    test_round_trip<double>("f8");
+    test_shapes();
+    test_fortran_order();
+    test_malformed();
+    return test::report("npy");
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "check.hpp"
+#include "nullable_column.hpp"
+
+// nullable_column against a std::vector<std::optional<T>>: appends, overwrites and nulling, then the
+// word-at-a-time aggregates and selections across runs that are all valid, all null and mixed
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    void check_state(nullable_column<T> const& c, std::vector<std::optional<T>> const& ref) {
+        CZ_CHECK(c.size() == ref.size() && c.is_empty() == ref.empty());
+        CZ_CHECK(c.validity().size() == (ref.size() + 7) / 8);
+
+        T sum{};
+        std::optional<T> lo, hi;
+        dyn_array<std::size_t> valid, nulls, odd;
+        for (std::size_t i = 0; i < ref.size(); ++i) {
+            CZ_CHECK(c.is_valid(i) == ref[i].has_value() && c[i] == ref[i]);
+            if (ref[i]) {
+                const T v = *ref[i];
+                CZ_CHECK(c.value(i) == v);
+                sum += v;
+                lo = lo ? std::min(*lo, v) : v;
+                hi = hi ? std::max(*hi, v) : v;
+                valid.push_back(i);
+                if (static_cast<std::int64_t>(v) % 2 != 0) {
+                    odd.push_back(i);
+                }
+            } else {
+                nulls.push_back(i);
+            }
+        }
+        CZ_CHECK(c.null_count() == nulls.size() && c.count_valid() == valid.size());
+        CZ_CHECK(c.sum() == sum && c.min() == lo && c.max() == hi);
+        CZ_CHECK(c.valid_indexes() == valid && c.null_indexes() == nulls);
+        CZ_CHECK(c.filter([](T v) { return static_cast<std::int64_t>(v) % 2 != 0; }) == odd);
+    }
+
+    template <typename T>
+    void test_random() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 100; ++round) {
+            // long stretches of one kind exercise the all-valid and all-null word paths
+            const unsigned null_percent = std::vector<unsigned>{0, 2, 50, 98, 100}[rng() % 5];
+            auto next = [&]() -> std::optional<T> {
+                if (rng() % 100 < null_percent) {
+                    return std::nullopt;
+                }
+                return static_cast<T>(static_cast<std::int64_t>(rng() % 2001) - 1000);
+            };
+
+            std::vector<std::optional<T>> ref;
+            nullable_column<T> c;
+            if (rng() % 3 == 0) {
+                dyn_array<T> init;
+                for (std::size_t k = rng() % 200; k > 0; --k) {
+                    const T v = static_cast<T>(rng() % 100);
+                    init.push_back(v);
+                    ref.push_back(v);
+                }
+                c = nullable_column<T>(std::move(init));
+            }
+            check_state(c, ref);
+
+            for (int step = 0; step < 50; ++step) {
+                switch (rng() % 4) {
+                case 0:
+                    if (!ref.empty()) {
+                        const std::size_t i = rng() % ref.size();
+                        const auto v = next();
+                        if (v) {
+                            c.set(i, *v);
+                        } else {
+                            c.set_null(i);
+                        }
+                        ref[i] = v;
+                    }
+                    break;
+                case 1:
+                    if (rng() % 20 == 0) {
+                        c.clear();
+                        ref.clear();
+                    }
+                    break;
+                default:
+                    for (std::size_t k = rng() % 70; k > 0; --k) {
+                        const auto v = next();
+                        if (rng() % 2 == 0) {
+                            c.push_back(v);
+                        } else if (v) {
+                            c.push_back(*v);
+                        } else {
+                            c.push_back(std::nullopt);
+                        }
+                        ref.push_back(v);
+                    }
+                }
+                check_state(c, ref);
+            }
+        }
+    }
+}
+
+int main() {
+    test_random<std::int32_t>();
+    test_random<std::int64_t>();
+    test_random<double>();
+    return test::report("nullable_column");
+}
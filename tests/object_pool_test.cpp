@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "object_pool.hpp"
+
+// object_pool against a std::map from pointer to expected value under random create / destroy / clear: objects
+// never move, for_each visits exactly the live ones, and every constructed object is destroyed exactly once,
+// including those left in a pool that is moved from or goes out of scope
+
+using namespace cz;
+
+namespace {
+
+    long live = 0;
+
+    struct alignas(32) tracked {
+        std::string name;
+        std::uint64_t value;
+
+        tracked(std::string n, std::uint64_t v) : name{std::move(n)}, value{v} {
+            ++live;
+        }
+
+        ~tracked() {
+            --live;
+        }
+    };
+
+    using pool = object_pool<tracked, 64>;
+
+    void check_state(pool const& p, std::map<tracked*, std::uint64_t> const& ref) {
+        CZ_CHECK(p.size() == ref.size() && p.is_empty() == ref.empty() && p.capacity() >= p.size());
+        CZ_CHECK(live == static_cast<long>(ref.size()));
+        for (auto const& [obj, v] : ref) {
+            CZ_CHECK(p.is_live(obj) && obj->value == v && obj->name == std::to_string(v));
+            CZ_CHECK(reinterpret_cast<std::uintptr_t>(obj) % alignof(tracked) == 0);
+        }
+        std::vector<tracked const*> visited;
+        p.for_each([&](tracked const& obj) { visited.push_back(&obj); });
+        std::sort(visited.begin(), visited.end());
+        std::vector<tracked const*> expect;
+        for (auto const& kv : ref) {
+            expect.push_back(kv.first);
+        }
+        CZ_CHECK(visited == expect);
+    }
+
+    void test_random() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 50; ++round) {
+            {
+                pool p;
+                std::map<tracked*, std::uint64_t> ref;
+                for (int step = 0; step < 400; ++step) {
+                    switch (rng() % 5) {
+                    case 0:
+                    case 1: {
+                        const std::uint64_t v = rng() % 100000;
+                        tracked* obj = p.create(std::to_string(v), v);
+                        CZ_CHECK(ref.count(obj) == 0);
+                        ref.emplace(obj, v);
+                        break;
+                    }
+                    case 2:
+                    case 3:
+                        if (!ref.empty()) {
+                            auto it = ref.begin();
+                            std::advance(it, static_cast<std::ptrdiff_t>(rng() % ref.size()));
+                            p.destroy(it->first);
+                            CZ_CHECK(!p.is_live(it->first));
+                            ref.erase(it);
+                        }
+                        break;
+                    default:
+                        if (rng() % 20 == 0) {
+                            const auto cap = p.capacity();
+                            p.clear();
+                            ref.clear();
+                            CZ_CHECK(p.capacity() == cap);
+                        } else {
+                            // mutations through the pointer stick
+                            p.for_each([](tracked& obj) {
+                                obj.value += 1;
+                                obj.name = std::to_string(obj.value);
+                            });
+                            for (auto& kv : ref) {
+                                ++kv.second;
+                            }
+                        }
+                    }
+                    check_state(p, ref);
+                }
+
+                pool moved(std::move(p));
+                CZ_CHECK(p.size() == 0);
+                check_state(moved, ref);
+                pool assigned;
+                assigned.create("x", 0);
+                assigned = std::move(moved);
+                check_state(assigned, ref);
+            }
+            CZ_CHECK(live == 0);
+        }
+    }
+
+    void test_reserve() {
+        pool p;
+        p.reserve(1000);
+        const auto cap = p.capacity();
+        CZ_CHECK(cap >= 1000);
+        for (std::uint64_t i = 0; i < 1000; ++i) {
+            p.create(std::to_string(i), i);
+        }
+        CZ_CHECK(p.capacity() == cap && p.size() == 1000);
+    }
+}
+
+int main() {
+    test_random();
+    test_reserve();
+    CZ_CHECK(live == 0);
+    return test::report("object_pool");
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+
+// argsort, top_k, nth_element and partial_sort against std::stable_sort / std::sort on random, sorted, reversed,
+// constant and organ-pipe inputs; top_k runs at every kernel level since it scans with find_greater
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    std::vector<std::vector<T>> inputs(std::size_t n, int range) {
+        std::vector<std::vector<T>> out;
+        out.push_back(test::random_values<T>(n, range));
+        auto sorted = out.back();
+        std::sort(sorted.begin(), sorted.end());
+        out.push_back(sorted);
+        out.emplace_back(sorted.rbegin(), sorted.rend());
+        out.emplace_back(n, T(3));
+        std::vector<T> pipe(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            pipe[i] = static_cast<T>(i < n / 2 ? i % 100 : (n - i) % 100);
+        }
+        out.push_back(pipe);
+        return out;
+    }
+
+    template <typename T>
+    dyn_array<T> to_dyn(std::vector<T> const& v) {
+        return dyn_array<T>(v.begin(), v.end());
+    }
+
+    template <typename T>
+    void test_argsort() {
+        for (std::size_t n : {0, 1, 2, 17, 63, 64, 65, 1000, 20000}) {
+            for (int range : {4, 1000, 1 << 30}) {
+                for (auto const& v : inputs<T>(n, range)) {
+                    std::vector<std::size_t> ref(n);
+                    std::iota(ref.begin(), ref.end(), std::size_t{0});
+                    std::stable_sort(ref.begin(), ref.end(), [&v](std::size_t a, std::size_t b) { return v[a] < v[b]; });
+                    const auto idx = to_dyn(v).argsort();
+                    CZ_CHECK(idx.size() == n && std::equal(idx.begin(), idx.end(), ref.begin()));
+                }
+            }
+        }
+    }
+
+    // NaNs sort by sign past the infinities and -0.0 before 0.0, on the radix path and the short-array path alike
+    template <typename T>
+    void test_argsort_special() {
+        const T inf = std::numeric_limits<T>::infinity();
+        const T nan = std::numeric_limits<T>::quiet_NaN();
+        const std::vector<T> pattern = {nan, T(1), -inf, -nan, T(-0.0), T(0.0), inf, T(-2)};
+        for (std::size_t n : {std::size_t{8}, std::size_t{200}}) {
+            std::vector<T> v;
+            for (std::size_t i = 0; i < n; ++i) {
+                v.push_back(pattern[(i * 5) % pattern.size()]);
+            }
+            const auto idx = to_dyn(v).argsort();
+            const auto rank = [](T x) {
+                if (std::isnan(x)) {
+                    return std::signbit(x) ? 0 : 7;
+                }
+                if (x == 0) {
+                    return std::signbit(x) ? 3 : 4;
+                }
+                return x == -std::numeric_limits<T>::infinity() ? 1 : x < 0 ? 2 : x < std::numeric_limits<T>::infinity() ? 5 : 6;
+            };
+            bool ordered = true;
+            for (std::size_t k = 1; k < idx.size(); ++k) {
+                const int a = rank(v[idx[k - 1]]), b = rank(v[idx[k]]);
+                ordered = ordered && (a < b || (a == b && idx[k - 1] < idx[k]));
+            }
+            CZ_CHECK(ordered);
+        }
+    }
+
+    template <typename T>
+    void test_top_k(simd_level) {
+        for (std::size_t n : {0, 1, 7, 64, 1000, 5000}) {
+            for (auto v : inputs<T>(n, 500)) {
+                if constexpr (std::is_floating_point<T>::value) {
+                    for (std::size_t i = 0; i < n; i += 7) {
+                        v[i] = std::numeric_limits<T>::quiet_NaN();
+                    }
+                }
+                std::vector<std::size_t> ref;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (v[i] == v[i]) {
+                        ref.push_back(i);
+                    }
+                }
+                std::stable_sort(ref.begin(), ref.end(), [&v](std::size_t a, std::size_t b) { return v[b] < v[a]; });
+                const auto a = to_dyn(v);
+                for (std::size_t k : {std::size_t{0}, std::size_t{1}, std::size_t{5}, std::size_t{100}, n + 3}) {
+                    const auto top = a.top_k(k);
+                    const std::size_t expect = std::min(k, ref.size());
+                    CZ_CHECK(top.size() == expect && std::equal(top.begin(), top.end(), ref.begin()));
+                }
+            }
+        }
+    }
+
+    template <typename T, typename Compare>
+    void test_selection(Compare cmp) {
+        for (std::size_t n : {1, 2, 16, 17, 100, 5000}) {
+            for (int range : {3, 100000}) {
+                for (auto const& v : inputs<T>(n, range)) {
+                    auto sorted = v;
+                    std::sort(sorted.begin(), sorted.end(), cmp);
+                    for (std::size_t nth : {std::size_t{0}, n / 3, n / 2, n - 1}) {
+                        auto a = to_dyn(v);
+                        a.nth_element(nth, cmp);
+                        bool placed = a[nth] == sorted[nth];
+                        for (std::size_t i = 0; i < n; ++i) {
+                            placed = placed && !(i < nth && cmp(a[nth], a[i])) && !(i > nth && cmp(a[i], a[nth]));
+                        }
+                        CZ_CHECK(placed);
+                        std::sort(a.begin(), a.end(), cmp);
+                        CZ_CHECK(std::equal(a.begin(), a.end(), sorted.begin())); // a permutation of the input
+                    }
+                    for (std::size_t k : {std::size_t{0}, std::size_t{1}, n / 2, n}) {
+                        auto a = to_dyn(v);
+                        a.partial_sort(k, cmp);
+                        CZ_CHECK(std::equal(a.begin(), a.begin() + static_cast<std::ptrdiff_t>(k), sorted.begin()));
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    test_argsort<std::int8_t>();
+    test_argsort<std::uint16_t>();
+    test_argsort<std::int32_t>();
+    test_argsort<std::uint64_t>();
+    test_argsort<float>();
+    test_argsort<double>();
+    test_argsort_special<float>();
+    test_argsort_special<double>();
+    test::for_each_simd_level([](simd_level level) {
+        test_top_k<std::int16_t>(level);
+        test_top_k<std::int32_t>(level);
+        test_top_k<std::uint64_t>(level);
+        test_top_k<float>(level);
+        test_top_k<double>(level);
+    });
+    test_selection<std::int32_t>(std::less<std::int32_t>());
+    test_selection<std::int32_t>(std::greater<std::int32_t>());
+    test_selection<double>(std::less<double>());
+    return test::report("ordering");
+}
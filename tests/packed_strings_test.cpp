@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "packed_strings.hpp"
+
+// packed_strings against a std::vector<std::string> under random push_back / pop_back / sort / compact / clear
+// sequences, so find and find_prefix run both on the SIMD arena scan and on the per-string fallback
+
+using namespace cz;
+
+namespace {
+
+    using strings = packed_strings<>;
+
+    std::string random_string() {
+        auto& rng = test::rng();
+        // mostly short strings over a tiny alphabet so lookups collide, a few past the 128-byte LEB128 boundary
+        const std::size_t len = rng() % 8 == 0 ? 60 + rng() % 200 : rng() % 5;
+        std::string s;
+        for (std::size_t i = 0; i < len; ++i) {
+            s += static_cast<char>("ab\x01\x00"[rng() % 4]);
+        }
+        return s;
+    }
+
+    bool same(strings const& ps, std::vector<std::string> const& ref) {
+        if (ps.size() != ref.size()) {
+            return false;
+        }
+        std::size_t i = 0;
+        for (auto s : ps) {
+            if (s != ref[i] || ps[i] != ref[i]) {
+                return false;
+            }
+            ++i;
+        }
+        return true;
+    }
+
+    void check_lookups(strings const& ps, std::vector<std::string> const& ref) {
+        std::vector<std::string> queries = {"", "a", "b", "ab", std::string(1, '\0')};
+        for (int q = 0; q < 30; ++q) {
+            queries.push_back(q % 2 == 0 && !ref.empty() ? ref[test::rng()() % ref.size()] : random_string());
+        }
+        for (auto const& q : queries) {
+            std::size_t exact = strings::npos, prefix = strings::npos;
+            for (std::size_t i = ref.size(); i-- > 0;) {
+                if (ref[i] == q) {
+                    exact = i;
+                }
+                if (ref[i].compare(0, q.size(), q) == 0) {
+                    prefix = i;
+                }
+            }
+            CZ_CHECK(ps.find(q) == exact);
+            CZ_CHECK(ps.contains(q) == (exact != strings::npos));
+            CZ_CHECK(ps.find_prefix(q) == prefix);
+            if (q.size() > 1) {
+                const std::string head = q.substr(0, q.size() / 2);
+                std::size_t ref_prefix = strings::npos;
+                for (std::size_t i = ref.size(); i-- > 0;) {
+                    if (ref[i].compare(0, head.size(), head) == 0) {
+                        ref_prefix = i;
+                    }
+                }
+                CZ_CHECK(ps.find_prefix(head) == ref_prefix);
+            }
+        }
+    }
+
+    void test_random_sequences() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 300; ++round) {
+            strings ps;
+            std::vector<std::string> ref;
+            for (int step = 0; step < 60; ++step) {
+                switch (rng() % 10) {
+                case 0:
+                    ps.sort();
+                    std::stable_sort(ref.begin(), ref.end());
+                    break;
+                case 1:
+                    ps.sort(std::greater<std::string_view>());
+                    std::stable_sort(ref.begin(), ref.end(), std::greater<std::string>());
+                    break;
+                case 2:
+                    ps.compact();
+                    break;
+                case 3:
+                case 4:
+                    if (!ref.empty()) {
+                        ps.pop_back();
+                        ref.pop_back();
+                    }
+                    break;
+                case 5:
+                    if (rng() % 8 == 0) {
+                        ps.clear();
+                        ref.clear();
+                    }
+                    break;
+                default: {
+                    const std::string s = random_string();
+                    CZ_CHECK(ps.push_back(s));
+                    ref.push_back(s);
+                }
+                }
+                CZ_CHECK(same(ps, ref));
+                check_lookups(ps, ref);
+            }
+        }
+    }
+
+    // a pop_back that leaves dead bytes at the front of the arena, then a sort that puts the offsets back in order
+    void test_dead_prefix() {
+        strings ps;
+        ps.push_back("a");
+        ps.push_back("b");
+        ps.sort(std::greater<std::string_view>());
+        ps.pop_back();
+        ps.sort();
+        CZ_CHECK(ps.size() == 1 && ps[0] == "b");
+        CZ_CHECK(ps.find("a") == strings::npos);
+        CZ_CHECK(ps.find_prefix("a") == strings::npos);
+        CZ_CHECK(ps.find("b") == 0);
+        ps.compact();
+        CZ_CHECK(ps.bytes() == 2 && ps.find("b") == 0);
+    }
+
+    void test_offset_limit() {
+        packed_strings<std::uint8_t> small;
+        std::size_t pushed = 0;
+        while (small.push_back("abcdefg")) {
+            ++pushed;
+        }
+        // 8 bytes per string: starts at 0, 8, ..., 248 fit in a uint8_t, 256 does not
+        CZ_CHECK(pushed == 32 && small.size() == 32 && small[31] == "abcdefg");
+    }
+
+    // appends grow the arena geometrically; an exact-fit resize per string would make this quadratic
+    void test_bulk_append() {
+        strings ps;
+        const std::string s(100, 'x');
+        for (int i = 0; i < 200000; ++i) {
+            ps.push_back(s);
+        }
+        CZ_CHECK(ps.size() == 200000 && ps.bytes() == 200000u * 101);
+        CZ_CHECK(ps.find(std::string(100, 'x')) == 0 && ps.find(std::string(99, 'x')) == strings::npos);
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level) {
+        test_random_sequences();
+        test_dead_prefix();
+    });
+    test_offset_limit();
+    test_bulk_append();
+    return test::report("packed_strings");
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "range_query.hpp"
+
+// fenwick_tree and segment_tree against direct folds over a std::vector under random point updates, overwrites
+// and range assignments, including a non-commutative op to check that the segment tree keeps operand order
+
+using namespace cz;
+
+namespace {
+
+    struct concat {
+        std::string operator()(std::string const& a, std::string const& b) const {
+            return a + b;
+        }
+
+        static std::string identity() {
+            return {};
+        }
+    };
+
+    template <typename T, typename Op>
+    T fold(std::vector<T> const& v, std::size_t l, std::size_t r, Op op) {
+        T acc = Op::identity();
+        for (std::size_t i = l; i < r; ++i) {
+            acc = op(acc, v[i]);
+        }
+        return acc;
+    }
+
+    void test_fenwick() {
+        auto& rng = test::rng();
+        for (std::size_t n : {0, 1, 2, 7, 64, 1000}) {
+            std::vector<std::int64_t> ref(n);
+            dyn_array<std::int64_t> init;
+            for (auto& x : ref) {
+                x = static_cast<std::int64_t>(rng() % 2001) - 1000;
+                init.push_back(x);
+            }
+            fenwick_tree<std::int64_t> t(init.view());
+            fenwick_tree<std::int64_t> empty_start(n);
+            CZ_CHECK(t.size() == n && t.is_empty() == (n == 0));
+            for (std::size_t i = 0; i < n; ++i) {
+                empty_start.update(i, ref[i]);
+            }
+
+            const range_ops::sum<std::int64_t> op;
+            for (int step = 0; step < 2000 && n != 0; ++step) {
+                const std::size_t i = rng() % n;
+                const auto v = static_cast<std::int64_t>(rng() % 2001) - 1000;
+                if (rng() % 2 == 0) {
+                    t.update(i, v);
+                    empty_start.update(i, v);
+                    ref[i] += v;
+                } else {
+                    t.set(i, v);
+                    empty_start.set(i, v);
+                    ref[i] = v;
+                }
+                std::size_t l = rng() % (n + 1), r = rng() % (n + 1);
+                if (l > r) {
+                    std::swap(l, r);
+                }
+                CZ_CHECK(t.query(l, r) == fold(ref, l, r, op) && empty_start.query(l, r) == t.query(l, r));
+                CZ_CHECK(t.prefix(r) == fold(ref, 0, r, op) && t.get(i) == ref[i]);
+            }
+        }
+
+        // a running maximum only needs prefix queries
+        std::vector<int> ref(300, range_ops::max<int>::identity());
+        fenwick_tree<int, range_ops::max<int>> best(ref.size());
+        for (int step = 0; step < 3000; ++step) {
+            const std::size_t i = rng() % ref.size();
+            const int v = static_cast<int>(rng() % 100000);
+            best.update(i, v);
+            ref[i] = std::max(ref[i], v);
+            const std::size_t r = rng() % (ref.size() + 1);
+            CZ_CHECK(best.prefix(r) == fold(ref, 0, r, range_ops::max<int>()));
+        }
+    }
+
+    template <typename T, typename Op, typename Make>
+    void test_segment(Make make) {
+        auto& rng = test::rng();
+        const Op op;
+        for (std::size_t n : {0, 1, 2, 3, 17, 64, 500}) {
+            std::vector<T> ref(n);
+            dyn_array<T> init;
+            for (auto& x : ref) {
+                x = make();
+                init.push_back(x);
+            }
+            segment_tree<T, Op> t(init.view());
+            CZ_CHECK(t.size() == n && t.is_empty() == (n == 0));
+            for (int step = 0; step < 1000 && n != 0; ++step) {
+                const std::size_t i = rng() % n;
+                switch (rng() % 3) {
+                case 0: {
+                    const T v = make();
+                    t.set(i, v);
+                    ref[i] = v;
+                    break;
+                }
+                case 1: {
+                    const T v = make();
+                    t.update(i, v);
+                    ref[i] = op(ref[i], v);
+                    break;
+                }
+                default: {
+                    dyn_array<T> values;
+                    for (std::size_t k = rng() % (n - i + 1); k > 0; --k) {
+                        values.push_back(make());
+                        ref[i + values.size() - 1] = values.back();
+                    }
+                    t.assign(i, values.view());
+                }
+                }
+                std::size_t l = rng() % (n + 1), r = rng() % (n + 1);
+                if (l > r) {
+                    std::swap(l, r);
+                }
+                CZ_CHECK(t.query(l, r) == fold(ref, l, r, op) && t.get(i) == ref[i]);
+                CZ_CHECK(t.query(0, n) == fold(ref, 0, n, op));
+            }
+        }
+    }
+}
+
+int main() {
+    test_fenwick();
+    auto& rng = test::rng();
+    const auto small_int = [&rng] { return static_cast<std::int64_t>(rng() % 2001) - 1000; };
+    test_segment<std::int64_t, range_ops::sum<std::int64_t>>(small_int);
+    test_segment<std::int64_t, range_ops::min<std::int64_t>>(small_int);
+    test_segment<std::int64_t, range_ops::max<std::int64_t>>(small_int);
+    test_segment<double, range_ops::min<double>>([&rng] { return static_cast<double>(rng() % 1000) / 8.0; });
+    // short strings keep the folded results small; the update case makes them grow
+    test_segment<std::string, concat>([&rng] { return std::string(1, static_cast<char>('a' + rng() % 26)); });
+    return test::report("range_query");
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "check.hpp"
+#include "roaring_bitmap.hpp"
+
+// roaring_bitmap against std::set over value mixes that produce array, bitset and run containers, at every
+// kernel level; set algebra, run_optimize, and serialize / deserialize round-trips including damaged input
+// and images that split one run into adjacent ones
+
+using namespace cz;
+
+namespace {
+
+    std::mt19937_64 rng(0x20a2);
+
+    // sparse values, dense clusters and long ranges spread over a few 2^16 chunks
+    std::set<std::uint32_t> random_set() {
+        std::set<std::uint32_t> s;
+        const int parts = 1 + static_cast<int>(rng() % 4);
+        for (int p = 0; p < parts; ++p) {
+            const std::uint32_t base = static_cast<std::uint32_t>(rng() % 6) << 16;
+            switch (rng() % 3) {
+            case 0:
+                for (int i = 0; i < 200; ++i) {
+                    s.insert(base | static_cast<std::uint32_t>(rng() % 65536));
+                }
+                break;
+            case 1:
+                for (int i = 0; i < 9000; ++i) {
+                    s.insert(base | static_cast<std::uint32_t>(rng() % 20000));
+                }
+                break;
+            default: {
+                const std::uint32_t first = static_cast<std::uint32_t>(rng() % 60000);
+                const std::uint32_t len = static_cast<std::uint32_t>(rng() % 30000);
+                for (std::uint32_t v = first; v <= first + len; ++v) {
+                    s.insert(base + v);
+                }
+            }
+            }
+        }
+        if (rng() % 4 == 0) {
+            s.insert(0xffffffffu);
+        }
+        return s;
+    }
+
+    roaring_bitmap build(std::set<std::uint32_t> const& s, bool bulk) {
+        roaring_bitmap b;
+        if (bulk) {
+            std::vector<std::uint32_t> v(s.begin(), s.end());
+            std::shuffle(v.begin(), v.end(), rng);
+            b.add_all(v);
+        } else {
+            for (auto v : s) {
+                b.add(v);
+            }
+        }
+        return b;
+    }
+
+    bool same(roaring_bitmap const& b, std::set<std::uint32_t> const& s) {
+        const auto a = b.to_array();
+        return b.cardinality() == s.size() && a.size() == s.size() && std::equal(a.begin(), a.end(), s.begin());
+    }
+
+    void test_round(simd_level) {
+        const auto sa = random_set();
+        const auto sb = random_set();
+        auto a = build(sa, true);
+        auto b = build(sb, false);
+        CZ_CHECK(same(a, sa));
+        CZ_CHECK(same(b, sb));
+
+        for (int i = 0; i < 100; ++i) {
+            const auto v = static_cast<std::uint32_t>(rng() % (6u << 16));
+            CZ_CHECK(a.contains(v) == (sa.count(v) != 0));
+        }
+
+        std::set<std::uint32_t> ref;
+        std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(ref, ref.end()));
+        CZ_CHECK(same(a | b, ref));
+        ref.clear();
+        std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(ref, ref.end()));
+        CZ_CHECK(same(a & b, ref));
+        ref.clear();
+        std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(ref, ref.end()));
+        CZ_CHECK(same(a - b, ref));
+
+        // removing values moves containers between kinds
+        auto sc = sa;
+        auto c = a;
+        std::vector<std::uint32_t> members(sa.begin(), sa.end());
+        std::shuffle(members.begin(), members.end(), rng);
+        for (std::size_t i = 0; i < members.size() && i < 3000; ++i) {
+            CZ_CHECK(c.remove(members[i]));
+            CZ_CHECK(!c.remove(members[i]));
+            sc.erase(members[i]);
+        }
+        CZ_CHECK(same(c, sc));
+
+        for (bool optimize : {false, true}) {
+            if (optimize) {
+                a.run_optimize();
+                CZ_CHECK(same(a, sa));
+            }
+            const auto bytes = a.serialize();
+            CZ_CHECK(bytes.size() == a.serialized_size());
+
+            const auto back = roaring_bitmap::deserialize(bytes.view());
+            CZ_CHECK(back.has_value() && *back == a && same(*back, sa));
+
+            // every truncation is rejected rather than read past the end
+            for (std::size_t cut = 0; cut < bytes.size(); cut += 1 + bytes.size() / 50) {
+                CZ_CHECK(!roaring_bitmap::deserialize(dyn_array_view<std::uint8_t const>(bytes.data(), cut)).has_value());
+            }
+        }
+    }
+
+    // one run container in chunk 0, written as the given (start, length - 1) pairs
+    dyn_array<std::uint8_t> run_image(std::vector<std::uint16_t> const& pairs) {
+        std::uint32_t card = 0;
+        for (std::size_t k = 1; k < pairs.size(); k += 2) {
+            card += std::uint32_t{pairs[k]} + 1;
+        }
+        dyn_array<std::uint8_t> bytes;
+        auto put16 = [&](std::uint16_t v) {
+            bytes.push_back(static_cast<std::uint8_t>(v & 0xff));
+            bytes.push_back(static_cast<std::uint8_t>(v >> 8));
+        };
+        put16(12347);
+        put16(0);
+        bytes.push_back(1);
+        put16(0);
+        put16(static_cast<std::uint16_t>(card - 1));
+        put16(static_cast<std::uint16_t>(pairs.size() / 2));
+        for (auto v : pairs) {
+            put16(v);
+        }
+        return bytes;
+    }
+
+    // adjacent runs in a foreign image describe the same members as one merged run
+    void test_split_runs() {
+        roaring_bitmap ref;
+        for (std::uint32_t v = 0; v < 10; ++v) {
+            ref.add(v);
+        }
+        roaring_bitmap ref_runs = ref;
+        ref_runs.run_optimize();
+
+        for (auto const& pairs : {std::vector<std::uint16_t>{0, 4, 5, 4}, std::vector<std::uint16_t>{0, 0, 1, 2, 4, 5}}) {
+            const auto back = roaring_bitmap::deserialize(run_image(pairs).view());
+            CZ_CHECK(back.has_value());
+            if (!back) {
+                continue;
+            }
+            CZ_CHECK(back->cardinality() == 10);
+            CZ_CHECK(*back == ref_runs && ref_runs == *back);
+            CZ_CHECK(*back == ref && ref == *back);
+            CZ_CHECK(back->serialized_size() == ref_runs.serialized_size());
+        }
+
+        // a gap of one keeps the runs apart, and overlapping runs are still refused
+        const auto gapped = roaring_bitmap::deserialize(run_image({0, 4, 6, 3}).view());
+        CZ_CHECK(gapped.has_value() && gapped->cardinality() == 9 && !gapped->contains(5) && *gapped != ref_runs);
+        CZ_CHECK(!roaring_bitmap::deserialize(run_image({0, 4, 4, 4}).view()).has_value());
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        for (int round = 0; round < 10; ++round) {
+            test_round(level);
+        }
+    });
+    test_split_runs();
+    return test::report("roaring_bitmap");
+}
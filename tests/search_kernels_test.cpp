@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+#include "dyn_array_simd.hpp"
+
+// find_last and find_first_of kernels against plain loops at every level the CPU supports; then the
+// find / rfind / index_of / contains / count / find_first_of members against std algorithms, including
+// element types that take the scalar path
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    void test_type(simd_level) {
+        for (std::size_t n : test::kernel_lengths) {
+            for (std::size_t off = 0; off < 4; ++off) {
+                const auto buf = test::random_values<T>(n + off, 40);
+                T const* p = buf.data() + off;
+
+                for (int q = -12; q < 32; q += 3) {
+                    const T v = static_cast<T>(q);
+                    std::size_t ref = static_cast<std::size_t>(-1);
+                    for (std::size_t i = n; i-- > 0;) {
+                        if (p[i] == v) {
+                            ref = i;
+                            break;
+                        }
+                    }
+                    CZ_CHECK(detail::simd::find_last(p, n, v) == ref);
+                }
+
+                for (std::size_t m = 0; m < 10; ++m) {
+                    const auto set = test::random_values<T>(m, 60);
+                    const std::size_t ref = static_cast<std::size_t>(std::find_first_of(p, p + n, set.begin(), set.end()) - p);
+                    CZ_CHECK(detail::simd::find_first_of(p, n, set.data(), m) == ref);
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    T make(int v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(static_cast<std::size_t>(v < 0 ? -v : v) % 5, static_cast<char>('a' + (v + 40) % 7));
+        } else if constexpr (std::is_same<T, bool>::value) {
+            return v % 3 == 0;
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+
+    // values drawn from a range of 12, so most probes match several times and a few never do
+    template <typename T>
+    void test_members() {
+        auto& rng = test::rng();
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{5}, std::size_t{16}, std::size_t{33}, std::size_t{129}, std::size_t{1000}}) {
+            std::vector<T> ref;
+            dyn_array<T> a;
+            for (std::size_t i = 0; i < n; ++i) {
+                ref.push_back(make<T>(static_cast<int>(rng() % 12) - 3));
+                a.push_back(ref.back());
+            }
+            dyn_array<T> const& ca = a;
+
+            for (int q = -6; q < 12; ++q) {
+                const T v = make<T>(q);
+                const auto first = static_cast<std::size_t>(std::find(ref.begin(), ref.end(), v) - ref.begin());
+                const auto matches = static_cast<std::size_t>(std::count(ref.begin(), ref.end(), v));
+                const auto last_it = std::find(ref.rbegin(), ref.rend(), v);
+                const std::size_t last = last_it == ref.rend() ? n : static_cast<std::size_t>(ref.rend() - last_it) - 1;
+
+                CZ_CHECK(a.find(v) == a.begin() + first && ca.find(v) == ca.begin() + first);
+                CZ_CHECK(a.rfind(v) == a.begin() + last && ca.rfind(v) == ca.begin() + last);
+                CZ_CHECK(a.index_of(v) == (first == n ? dyn_array<T>::npos : first));
+                CZ_CHECK(a.contains(v) == (first != n) && a.count(v) == matches);
+                if (matches > 1) {
+                    CZ_CHECK(a.rfind(v) != a.find(v));
+                }
+            }
+
+            for (std::size_t m = 0; m < 6; ++m) {
+                std::vector<T> set_ref;
+                dyn_array<T> set;
+                for (std::size_t k = 0; k < m; ++k) {
+                    set_ref.push_back(make<T>(static_cast<int>(rng() % 20) - 5));
+                    set.push_back(set_ref.back());
+                }
+                const auto at = std::find_first_of(ref.begin(), ref.end(), set_ref.begin(), set_ref.end()) - ref.begin();
+                CZ_CHECK(a.find_first_of(set) == a.begin() + at && ca.find_first_of(set) == ca.begin() + at);
+            }
+            const T pair[] = {make<T>(20), make<T>(-3)};
+            const auto at_pair = std::find_first_of(ref.begin(), ref.end(), pair, pair + 2) - ref.begin();
+            const auto at_one = std::find_first_of(ref.begin(), ref.end(), pair + 1, pair + 2) - ref.begin();
+            CZ_CHECK(a.find_first_of({pair[0], pair[1]}) == a.begin() + at_pair && ca.find_first_of({pair[1]}) == ca.begin() + at_one);
+            CZ_CHECK(a.find_first_of({}) == a.end());
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_type<std::int8_t>(level);
+        test_type<std::uint8_t>(level);
+        test_type<std::int16_t>(level);
+        test_type<std::uint16_t>(level);
+        test_type<std::int32_t>(level);
+        test_type<std::uint32_t>(level);
+        test_type<std::int64_t>(level);
+        test_type<std::uint64_t>(level);
+        test_type<float>(level);
+        test_type<double>(level);
+        test_members<std::int8_t>();
+        test_members<std::uint16_t>();
+        test_members<std::int32_t>();
+        test_members<std::uint64_t>();
+        test_members<double>();
+    });
+    test_members<bool>();
+    test_members<std::string>();
+    return test::report("search_kernels");
+}
@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array_simd.hpp"
+
+// the find_greater kernel against std::find_if at every level the CPU supports
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    void test_find_greater(simd_level) {
+        for (std::size_t n : test::kernel_lengths) {
+            for (std::size_t off = 0; off < 4; ++off) {
+                const auto buf = test::random_values<T>(n + off, 40);
+                T const* p = buf.data() + off;
+                for (int q = -12; q < 32; q += 3) {
+                    const T v = static_cast<T>(q);
+                    const auto ref = static_cast<std::size_t>(std::find_if(p, p + n, [v](T x) { return v < x; }) - p);
+                    CZ_CHECK(detail::simd::find_greater(p, n, v) == ref);
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_find_greater<std::int8_t>(level);
+        test_find_greater<std::uint8_t>(level);
+        test_find_greater<std::int16_t>(level);
+        test_find_greater<std::uint16_t>(level);
+        test_find_greater<std::int32_t>(level);
+        test_find_greater<std::uint32_t>(level);
+        test_find_greater<std::int64_t>(level);
+        test_find_greater<std::uint64_t>(level);
+        test_find_greater<float>(level);
+        test_find_greater<double>(level);
+    });
+    return test::report("select");
+}
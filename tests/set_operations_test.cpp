@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array_simd.hpp"
+#include "set_operations.hpp"
+
+// the intersect kernel against std::set_intersection at every level the CPU supports; set_intersection,
+// set_union and set_difference against std::set_* over skewed size ratios (the galloping branch), empty
+// inputs and several threads; merge_k and loser_tree against a stable sort, duplicates and streamed blocks
+// included
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    std::vector<T> sorted_unique(std::size_t n, std::uint64_t range) {
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            x = static_cast<T>(static_cast<std::int64_t>(test::rng()() % range) - static_cast<std::int64_t>(range / 2));
+        }
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        return v;
+    }
+
+    template <typename T>
+    void test_intersect_kernel(simd_level) {
+        for (std::size_t na : test::kernel_lengths) {
+            for (std::size_t nb : {std::size_t{0}, std::size_t{5}, std::size_t{64}, std::size_t{700}}) {
+                for (std::uint64_t range : {std::uint64_t{50}, std::uint64_t{3000}}) {
+                    const auto a = sorted_unique<T>(na, range);
+                    const auto b = sorted_unique<T>(nb, range);
+                    std::vector<T> ref;
+                    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(ref));
+                    std::vector<T> out(std::min(a.size(), b.size()) + 1);
+                    const std::size_t k = detail::simd::intersect(a.data(), a.size(), b.data(), b.size(), out.data());
+                    CZ_CHECK(k == ref.size());
+                    CZ_CHECK(std::equal(ref.begin(), ref.end(), out.begin()));
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    dyn_array<T> to_dyn(std::vector<T> const& v) {
+        return dyn_array<T>(v.begin(), v.end());
+    }
+
+    template <typename T>
+    bool same(dyn_array<T> const& got, std::vector<T> const& ref) {
+        return got.size() == ref.size() && std::equal(ref.begin(), ref.end(), got.begin());
+    }
+
+    template <typename T>
+    void check_wrappers(std::vector<T> const& va, std::vector<T> const& vb) {
+        const auto a = to_dyn(va), b = to_dyn(vb);
+        std::vector<T> inter, uni, diff;
+        std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(inter));
+        std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(uni));
+        std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(diff));
+
+        // 1 thread takes the single-pass path; the others cut `a` by value once inputs are large enough
+        for (unsigned threads : {1u, 2u, 5u}) {
+            dyn_array<T> out{T(7)};
+            set_intersection(a, b, out, threads);
+            CZ_CHECK(same(out, inter));
+            set_union(a, b, out, threads);
+            CZ_CHECK(same(out, uni));
+            set_difference(a, b, out, threads);
+            CZ_CHECK(same(out, diff));
+
+            CZ_CHECK(same(set_intersection(b, a, threads), inter));
+            CZ_CHECK(same(set_union(b, a, threads), uni));
+            CZ_CHECK(same(set_difference(a, b, threads), diff));
+        }
+    }
+
+    template <typename T>
+    void test_wrappers() {
+        const std::size_t sizes[] = {0, 1, 3, 100, 3199, 3200, 5000, 100000};
+        for (std::size_t na : sizes) {
+            for (std::size_t nb : sizes) {
+                if (na * nb > 100000 * 5000) {
+                    continue;
+                }
+                // a range near the sizes makes overlaps common, a wide one makes them rare
+                for (std::uint64_t range : {std::uint64_t{2} * (na + nb) + 10, std::uint64_t{1} << 30}) {
+                    check_wrappers(sorted_unique<T>(na, range), sorted_unique<T>(nb, range));
+                }
+            }
+        }
+
+        // one side inside the other, and disjoint sides, at ratios past gallop_ratio
+        std::vector<T> big;
+        for (std::size_t i = 0; i < 70000; ++i) {
+            big.push_back(static_cast<T>(3 * i));
+        }
+        std::vector<T> every_100th, between;
+        for (std::size_t i = 0; i < big.size(); i += 100) {
+            every_100th.push_back(big[i]);
+            between.push_back(static_cast<T>(big[i] + 1));
+        }
+        check_wrappers(big, every_100th);
+        check_wrappers(every_100th, big);
+        check_wrappers(big, between);
+        check_wrappers(big, big);
+    }
+
+    // the galloping kernel on its own, at the ratios that select it and below
+    void test_gallop() {
+        for (std::size_t ns : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{31}, std::size_t{200}}) {
+            for (std::size_t nl : {std::size_t{0}, std::size_t{1}, std::size_t{40}, std::size_t{6400}, std::size_t{50000}}) {
+                for (std::uint64_t range : {std::uint64_t{100}, std::uint64_t{100000}}) {
+                    const auto small = sorted_unique<std::int64_t>(ns, range);
+                    const auto large = sorted_unique<std::int64_t>(nl, range);
+                    std::vector<std::int64_t> ref, out(small.size() + 1);
+                    std::set_intersection(small.begin(), small.end(), large.begin(), large.end(), std::back_inserter(ref));
+                    const std::size_t k = detail::sets::gallop_intersect(small.data(), small.size(), large.data(), large.size(), out.data());
+                    CZ_CHECK(k == ref.size() && std::equal(ref.begin(), ref.end(), out.begin()));
+                }
+            }
+        }
+    }
+
+    // sorted lists with repeats inside and across them, some empty
+    std::vector<std::vector<std::int32_t>> random_lists(std::size_t k) {
+        std::vector<std::vector<std::int32_t>> lists(k);
+        for (auto& list : lists) {
+            const std::size_t n = test::rng()() % 4 == 0 ? 0 : test::rng()() % 300;
+            for (std::size_t i = 0; i < n; ++i) {
+                list.push_back(static_cast<std::int32_t>(test::rng()() % 50) - 10);
+            }
+            std::sort(list.begin(), list.end());
+        }
+        return lists;
+    }
+
+    void test_merge_k() {
+        for (std::size_t k : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{3}, std::size_t{7}, std::size_t{64}, std::size_t{65}}) {
+            const auto lists = random_lists(k);
+            std::vector<std::int32_t> ref;
+            dyn_array<dyn_array<std::int32_t>> dyn_lists;
+            for (auto const& list : lists) {
+                ref.insert(ref.end(), list.begin(), list.end());
+                dyn_lists.push_back(to_dyn(list));
+            }
+            std::sort(ref.begin(), ref.end());
+
+            dyn_array<std::int32_t> out{1, 2, 3};
+            merge_k(lists, out);
+            CZ_CHECK(same(out, ref));
+            merge_k(dyn_lists, out);
+            CZ_CHECK(same(out, ref));
+        }
+    }
+
+    struct by_key {
+        bool operator()(std::pair<std::int32_t, std::uint32_t> const& a, std::pair<std::int32_t, std::uint32_t> const& b) const {
+            return a.first < b.first;
+        }
+    };
+
+    // equal keys come out in source order, also when every source is streamed in blocks of three
+    void test_loser_tree() {
+        using item = std::pair<std::int32_t, std::uint32_t>;
+        for (std::size_t k : {std::size_t{1}, std::size_t{2}, std::size_t{5}, std::size_t{16}, std::size_t{33}}) {
+            const auto keys = random_lists(k);
+            std::vector<std::vector<item>> lists(k);
+            std::vector<item> ref;
+            for (std::size_t s = 0; s < k; ++s) {
+                for (std::size_t i = 0; i < keys[s].size(); ++i) {
+                    lists[s].push_back(item(keys[s][i], static_cast<std::uint32_t>(s << 16 | i)));
+                    ref.push_back(lists[s].back());
+                }
+            }
+            std::stable_sort(ref.begin(), ref.end(), by_key());
+
+            detail::sets::loser_tree<item, by_key> whole(lists);
+            bool ok = true;
+            for (auto const& want : ref) {
+                ok = ok && whole.pop() == want;
+            }
+            CZ_CHECK(ok);
+
+            constexpr std::size_t block = 3;
+            std::vector<std::size_t> next(k);
+            std::vector<dyn_array_view<item const>> heads;
+            for (std::size_t s = 0; s < k; ++s) {
+                next[s] = std::min(block, lists[s].size());
+                heads.push_back(dyn_array_view<item const>(lists[s].data(), next[s]));
+            }
+            detail::sets::loser_tree<item, by_key> streamed(heads);
+            auto refill = [&](std::size_t s, item const*& cur, item const*& end) {
+                const std::size_t n = std::min(block, lists[s].size() - next[s]);
+                cur = lists[s].data() + next[s];
+                end = cur + n;
+                next[s] += n;
+            };
+            for (auto const& want : ref) {
+                ok = ok && streamed.pop(refill) == want;
+            }
+            CZ_CHECK(ok);
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_intersect_kernel<std::int32_t>(level);
+        test_intersect_kernel<std::uint32_t>(level);
+        test_wrappers<std::int32_t>();
+    });
+    test_wrappers<std::uint64_t>();
+    test_wrappers<double>();
+    test_gallop();
+    test_merge_k();
+    test_loser_tree();
+    return test::report("set_operations");
+}
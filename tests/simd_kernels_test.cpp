@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array_simd.hpp"
+
+// the bulk kernels (find, count, fill, sum) against plain loops at every level the CPU supports, over
+// lengths that cover empty input, partial vectors and the scalar tails, at starts off the allocation's alignment
+
+using namespace cz;
+
+namespace {
+
+    template <typename T>
+    void test_find_count(simd_level) {
+        for (std::size_t n : test::kernel_lengths) {
+            for (std::size_t off = 0; off < 4; ++off) {
+                const auto buf = test::random_values<T>(n + off, 40);
+                T const* p = buf.data() + off;
+
+                for (int q = -12; q < 32; q += 3) {
+                    const T v = static_cast<T>(q);
+                    CZ_CHECK(detail::simd::find(p, n, v) == static_cast<std::size_t>(std::find(p, p + n, v) - p));
+                    CZ_CHECK(detail::simd::count(p, n, v) == static_cast<std::size_t>(std::count(p, p + n, v)));
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void test_fill(simd_level) {
+        for (std::size_t n : test::kernel_lengths) {
+            for (std::size_t off = 0; off < 4; ++off) {
+                std::vector<T> buf(n + off + 4, T(1));
+                const T v = static_cast<T>(test::rng()() % 100);
+                detail::simd::fill(buf.data() + off, n, v);
+                for (std::size_t i = 0; i < buf.size(); ++i) {
+                    const bool inside = i >= off && i < off + n;
+                    CZ_CHECK(buf[i] == (inside ? v : T(1)));
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void test_sum(simd_level) {
+        using U = typename std::make_unsigned<T>::type;
+        for (std::size_t n : test::kernel_lengths) {
+            std::vector<T> v(n);
+            U ref = 0;
+            for (auto& x : v) {
+                x = static_cast<T>(test::rng()());
+                ref += static_cast<U>(x);
+            }
+            CZ_CHECK(detail::simd::sum(v.data(), n) == static_cast<T>(ref));
+        }
+    }
+
+    template <typename T>
+    void test_element_kernels(simd_level level) {
+        test_find_count<T>(level);
+        test_fill<T>(level);
+    }
+
+    template <typename T>
+    void test_integral_kernels(simd_level level) {
+        test_element_kernels<T>(level);
+        test_sum<T>(level);
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_integral_kernels<std::int8_t>(level);
+        test_integral_kernels<std::uint8_t>(level);
+        test_integral_kernels<std::int16_t>(level);
+        test_integral_kernels<std::uint16_t>(level);
+        test_integral_kernels<std::int32_t>(level);
+        test_integral_kernels<std::uint32_t>(level);
+        test_integral_kernels<std::int64_t>(level);
+        test_integral_kernels<std::uint64_t>(level);
+        test_element_kernels<float>(level);
+        test_element_kernels<double>(level);
+    });
+    return test::report("simd_kernels");
+}
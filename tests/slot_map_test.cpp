@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "slot_map.hpp"
+
+// slot_map against a std::map from handle to value under random insert / emplace / erase / clear: live handles
+// find their values wherever the swap-erase moved them, stale handles never match again, and the dense values
+// walk in step with handle_at
+
+using namespace cz;
+
+namespace {
+
+    using key = std::pair<std::uint32_t, std::uint32_t>;
+
+    key key_of(slot_handle h) {
+        return key(h.index, h.generation);
+    }
+
+    void check_state(slot_map<std::string> const& m, std::map<key, std::string> const& ref, std::vector<slot_handle> const& stale) {
+        CZ_CHECK(m.size() == ref.size() && m.is_empty() == ref.empty());
+        for (auto const& [k, v] : ref) {
+            const slot_handle h{k.first, k.second};
+            CZ_CHECK(m.contains(h) && m.get(h) != nullptr && *m.get(h) == v && m[h] == v);
+        }
+        for (auto h : stale) {
+            CZ_CHECK(!m.contains(h) && m.get(h) == nullptr);
+        }
+
+        std::map<key, std::string> walked;
+        for (std::size_t i = 0; i < m.size(); ++i) {
+            walked.emplace(key_of(m.handle_at(i)), m.values()[i]);
+        }
+        CZ_CHECK(walked == ref);
+        CZ_CHECK(static_cast<std::size_t>(m.end() - m.begin()) == ref.size() && m.data() == m.values().data());
+    }
+
+    void test_random() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 100; ++round) {
+            slot_map<std::string> m;
+            std::map<key, std::string> ref;
+            std::vector<slot_handle> stale{slot_handle{}, slot_handle{0, 0}, slot_handle{1000, 1}};
+            for (int step = 0; step < 300; ++step) {
+                const std::string v = std::to_string(rng() % 1000) + std::string(rng() % 30, 'x');
+                switch (rng() % 7) {
+                case 0:
+                case 1: {
+                    const slot_handle h = m.insert(v);
+                    CZ_CHECK(ref.count(key_of(h)) == 0 && (h.generation & 1) == 1);
+                    ref.emplace(key_of(h), v);
+                    break;
+                }
+                case 2: {
+                    const slot_handle h = m.emplace(v.size(), 'e');
+                    ref.emplace(key_of(h), std::string(v.size(), 'e'));
+                    break;
+                }
+                case 3:
+                case 4:
+                    if (!ref.empty()) {
+                        auto it = ref.begin();
+                        std::advance(it, static_cast<std::ptrdiff_t>(rng() % ref.size()));
+                        const slot_handle h{it->first.first, it->first.second};
+                        CZ_CHECK(m.erase(h));
+                        CZ_CHECK(!m.erase(h));
+                        stale.push_back(h);
+                        ref.erase(it);
+                    }
+                    break;
+                case 5:
+                    if (!ref.empty()) {
+                        // values are writable in place through any live handle
+                        const auto& k = ref.begin()->first;
+                        m[slot_handle{k.first, k.second}] = v;
+                        ref.begin()->second = v;
+                    }
+                    break;
+                default:
+                    if (rng() % 10 == 0) {
+                        for (auto const& kv : ref) {
+                            stale.push_back(slot_handle{kv.first.first, kv.first.second});
+                        }
+                        m.clear();
+                        ref.clear();
+                    }
+                }
+                check_state(m, ref, stale);
+            }
+        }
+    }
+
+    struct flaky {
+        std::string value;
+
+        explicit flaky(int v)
+            : value(std::to_string(v)) {
+            if (v < 0) {
+                throw v;
+            }
+        }
+    };
+
+    // a constructor that throws mid-insert leaves size, handles and the free list as they were
+    void test_throwing_insert() {
+        slot_map<flaky> m;
+        std::vector<slot_handle> live;
+        for (int i = 0; i < 100; ++i) {
+            if (i % 3 == 0 && !live.empty()) {
+                CZ_CHECK(m.erase(live.front()));
+                live.erase(live.begin());
+            }
+            bool thrown = false;
+            try {
+                m.emplace(-i - 1);
+            } catch (int) {
+                thrown = true;
+            }
+            CZ_CHECK(thrown && m.size() == live.size());
+            live.push_back(m.emplace(i));
+            CZ_CHECK(m.size() == live.size());
+            for (std::size_t k = 0; k < m.size(); ++k) {
+                CZ_CHECK(m.get(m.handle_at(k)) == m.data() + k);
+            }
+        }
+        for (auto h : live) {
+            CZ_CHECK(m.contains(h) && m.erase(h) && !m.contains(h));
+        }
+        CZ_CHECK(m.is_empty());
+    }
+}
+
+int main() {
+    test_random();
+    test_throwing_insert();
+    return test::report("slot_map");
+}
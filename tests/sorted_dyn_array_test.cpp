@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "check.hpp"
+#include "sorted_dyn_array.hpp"
+
+// sorted_dyn_array against std::multiset under random insert / insert_all / erase / flush with several merge
+// policies, so lookups see elements in the run, in newer levels, in the buffer and in all of them; plus
+// stability of equal elements and the logarithmic level count
+
+using namespace cz;
+
+namespace {
+
+    template <typename Compare>
+    void test_random(merge_policy policy) {
+        auto& rng = test::rng();
+        for (int round = 0; round < 15; ++round) {
+            std::multiset<std::int32_t, Compare> ref;
+            dyn_array<std::int32_t> init;
+            for (std::size_t k = rng() % 100; k > 0; --k) {
+                init.push_back(static_cast<std::int32_t>(rng() % 200));
+                ref.insert(init.back());
+            }
+            sorted_dyn_array<std::int32_t, Compare> s(init, policy);
+
+            for (int step = 0; step < 1500; ++step) {
+                const auto v = static_cast<std::int32_t>(rng() % 200);
+                switch (rng() % 8) {
+                case 0:
+                case 1:
+                case 2:
+                    s.insert(v);
+                    ref.insert(v);
+                    break;
+                case 3: {
+                    std::vector<std::int32_t> batch;
+                    for (std::size_t k = rng() % 50; k > 0; --k) {
+                        batch.push_back(static_cast<std::int32_t>(rng() % 200));
+                    }
+                    s.insert_all(batch);
+                    ref.insert(batch.begin(), batch.end());
+                    break;
+                }
+                case 4:
+                case 5: {
+                    const auto it = ref.find(v);
+                    CZ_CHECK(s.erase(v) == (it != ref.end()));
+                    if (it != ref.end()) {
+                        ref.erase(it);
+                    }
+                    break;
+                }
+                case 6:
+                    if (rng() % 4 == 0) {
+                        s.flush();
+                        CZ_CHECK(s.buffered() == 0);
+                    }
+                    break;
+                default:
+                    if (rng() % 50 == 0) {
+                        s.clear();
+                        ref.clear();
+                    }
+                }
+
+                CZ_CHECK(s.size() == ref.size() && s.is_empty() == ref.empty());
+                CZ_CHECK(s.buffered() <= std::max(policy.min_buffer, policy.max_buffer));
+                CZ_CHECK(std::is_sorted(s.sorted_run().begin(), s.sorted_run().end(), Compare()));
+                CZ_CHECK(s.contains(v) == (ref.count(v) != 0) && s.count(v) == ref.count(v));
+                std::int32_t lo = static_cast<std::int32_t>(rng() % 200), hi = static_cast<std::int32_t>(rng() % 200);
+                if (Compare()(hi, lo)) {
+                    std::swap(lo, hi);
+                }
+                CZ_CHECK(s.count_range(lo, hi) == static_cast<std::size_t>(std::distance(ref.lower_bound(lo), ref.lower_bound(hi))));
+            }
+
+            auto const& all = s.sorted();
+            CZ_CHECK(s.buffered() == 0 && all.size() == ref.size() && std::equal(all.begin(), all.end(), ref.begin()));
+        }
+    }
+
+    // a fixed buffer far smaller than the array: levels must stay logarithmic rather than grow per flush
+    void test_levels() {
+        auto& rng = test::rng();
+        const merge_policy policy{16, 16, 1};
+        sorted_dyn_array<std::uint32_t> s(policy);
+        std::multiset<std::uint32_t> ref;
+        const std::size_t n = std::size_t{1} << 17;
+        std::size_t max_levels = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto v = static_cast<std::uint32_t>(rng() % 50000);
+            s.insert(v);
+            ref.insert(v);
+            max_levels = std::max(max_levels, static_cast<std::size_t>(s.levels()));
+        }
+        // sizes at least double from newest to oldest level, so at most log2(n / 16) + 1 of them
+        CZ_CHECK(max_levels <= 14);
+        CZ_CHECK(s.size() == n);
+        for (int k = 0; k < 200; ++k) {
+            const auto v = static_cast<std::uint32_t>(rng() % 50000);
+            CZ_CHECK(s.count(v) == ref.count(v));
+        }
+        auto const& all = s.sorted();
+        CZ_CHECK(s.levels() == 1 && std::equal(all.begin(), all.end(), ref.begin()) && all.size() == ref.size());
+    }
+
+    struct by_key {
+        bool operator()(std::pair<int, int> const& a, std::pair<int, int> const& b) const {
+            return a.first < b.first;
+        }
+    };
+
+    // elements that compare equal come out in insertion order, across the initial sort and every merge
+    void test_stability() {
+        auto& rng = test::rng();
+        std::vector<std::pair<int, int>> ref;
+        dyn_array<std::pair<int, int>> init;
+        int order = 0;
+        for (int i = 0; i < 100; ++i) {
+            init.push_back({static_cast<int>(rng() % 10), order});
+            ref.push_back({init.back().first, order++});
+        }
+        sorted_dyn_array<std::pair<int, int>, by_key> s(init, merge_policy{4, 64, 4});
+        for (int i = 0; i < 5000; ++i) {
+            const std::pair<int, int> v{static_cast<int>(rng() % 10), order++};
+            s.insert(v);
+            ref.push_back(v);
+        }
+        std::stable_sort(ref.begin(), ref.end(), by_key());
+        auto const& all = s.sorted();
+        CZ_CHECK(all.size() == ref.size() && std::equal(all.begin(), all.end(), ref.begin()));
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level) {
+        test_random<std::less<std::int32_t>>(merge_policy{});
+        test_random<std::less<std::int32_t>>(merge_policy{1, 8, 2});
+        test_random<std::less<std::int32_t>>(merge_policy{0, 0, 0});
+    });
+    test_random<std::greater<std::int32_t>>(merge_policy{4, 100, 8});
+    test_stability();
+    test_levels();
+    return test::report("sorted_dyn_array");
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "check.hpp"
+#include "static_btree.hpp"
+
+// lower_bound throughput: std::lower_bound over the sorted keys against static_btree, one query at a time
+// and batched, at every kernel level. Usage: static_btree_bench [keys] [queries]
+
+using namespace cz;
+
+namespace {
+
+    template <typename F>
+    double milliseconds(F&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{1} << 24;
+    const std::size_t m = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::size_t{1} << 22;
+
+    std::mt19937 rng(42);
+    dyn_array<std::int32_t> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys.push_back(static_cast<std::int32_t>(rng() >> 1));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    dyn_array<std::int32_t> queries;
+    queries.reserve(m);
+    for (std::size_t i = 0; i < m; ++i) {
+        queries.push_back(static_cast<std::int32_t>(rng() >> 1));
+    }
+
+    std::printf("%zu int32 keys, %zu random queries\n", n, m);
+
+    std::size_t check = 0;
+    const double base = milliseconds([&] {
+        for (auto x : queries) {
+            check += static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), x) - keys.begin());
+        }
+    });
+    std::printf("%-8s %-22s %9.1f ms\n", "", "std::lower_bound", base);
+
+    const static_btree<std::int32_t> bt(keys.view());
+    test::for_each_simd_level([&](simd_level level) {
+        std::size_t sum = 0;
+        const double one = milliseconds([&] {
+            for (auto x : queries) {
+                sum += bt.lower_bound(x);
+            }
+        });
+        dyn_array<std::size_t> all;
+        const double batch = milliseconds([&] {
+            all = bt.lower_bound_all(queries.view());
+        });
+        for (auto r : all) {
+            sum -= r;
+        }
+        std::printf("%-8s %-22s %9.1f ms  (%.1fx)\n", test::level_name(level), "static_btree", one, base / one);
+        std::printf("%-8s %-22s %9.1f ms  (%.1fx)%s\n", test::level_name(level), "static_btree, batched", batch, base / batch,
+                    sum == 0 ? "" : "  MISMATCH");
+    });
+
+    std::printf("index: %zu bytes over %zu bytes of keys, height %zu (checksum %zu)\n",
+                static_cast<std::size_t>(bt.index_bytes()), n * sizeof(std::int32_t), static_cast<std::size_t>(bt.height()), check);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "static_btree.hpp"
+
+// static_btree lookups against std::lower_bound / upper_bound on the same keys, at every kernel level,
+// for sizes that give trees of one to four levels and key ranges from all-duplicates to mostly distinct
+
+using namespace cz;
+
+namespace {
+
+    std::mt19937_64 rng(0xb7ee);
+
+    template <typename T>
+    void test_type(simd_level) {
+        const std::size_t sizes[] = {0, 1, 2, 15, 16, 17, 100, 1000, 5000, 70000};
+        const std::uint64_t ranges[] = {1, 20, 1000, 1u << 30};
+
+        for (std::size_t n : sizes) {
+            for (std::uint64_t range : ranges) {
+                dyn_array<T> keys;
+                for (std::size_t i = 0; i < n; ++i) {
+                    keys.push_back(static_cast<T>(rng() % range));
+                }
+                if (n > 4) {
+                    keys[0] = std::numeric_limits<T>::lowest();
+                    keys[1] = std::numeric_limits<T>::max();
+                }
+                std::sort(keys.begin(), keys.end());
+
+                static_btree<T> bt(keys.view());
+                CZ_CHECK(bt.size() == n);
+
+                std::vector<T> queries = {std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max(), T(0), T(1)};
+                if constexpr (std::numeric_limits<T>::has_infinity) {
+                    queries.push_back(std::numeric_limits<T>::infinity());
+                    queries.push_back(-std::numeric_limits<T>::infinity());
+                    queries.push_back(T(0.5));
+                }
+                for (int q = 0; q < 200; ++q) {
+                    queries.push_back(n != 0 && q % 2 == 0 ? keys[rng() % n] : static_cast<T>(rng() % (range + 2)));
+                }
+
+                dyn_array<T> xs(queries.data(), queries.data() + queries.size());
+                const auto all = bt.lower_bound_all(xs.view());
+                CZ_CHECK(all.size() == xs.size());
+
+                for (std::size_t i = 0; i < queries.size(); ++i) {
+                    const T x = queries[i];
+                    const auto lb = static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), x) - keys.begin());
+                    const auto ub = static_cast<std::size_t>(std::upper_bound(keys.begin(), keys.end(), x) - keys.begin());
+
+                    CZ_CHECK(bt.lower_bound(x) == lb);
+                    CZ_CHECK(all[i] == lb);
+                    CZ_CHECK(bt.upper_bound(x) == ub);
+                    CZ_CHECK(bt.contains(x) == (lb != ub));
+                    CZ_CHECK(bt.find(x) == (lb != ub ? lb : n));
+
+                    const auto eq = bt.equal_range(x);
+                    CZ_CHECK(eq.size() == ub - lb);
+                    CZ_CHECK(eq.size() == 0 || eq.data() == keys.data() + lb);
+
+                    const T y = queries[(i * 7 + 3) % queries.size()];
+                    const auto r = bt.range(x, y);
+                    const auto hi = static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), y) - keys.begin());
+                    CZ_CHECK(r.size() == (y < x ? 0 : hi - lb));
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_type<std::int8_t>(level);
+        test_type<std::uint8_t>(level);
+        test_type<std::int16_t>(level);
+        test_type<std::uint16_t>(level);
+        test_type<std::int32_t>(level);
+        test_type<std::uint32_t>(level);
+        test_type<std::int64_t>(level);
+        test_type<std::uint64_t>(level);
+        test_type<float>(level);
+        test_type<double>(level);
+    });
+    return test::report("static_btree");
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "check.hpp"
+#include "tracked_dyn_array.hpp"
+
+// tracked_dyn_array against a std::vector plus the set of blocks each mutation should dirty: contents,
+// dirty_ranges() and the per-block checksums after random writes, appends, removals and resizes
+
+using namespace cz;
+
+namespace {
+
+    using tracked = tracked_dyn_array<std::int32_t, std::allocator<std::int32_t>, std::size_t, 64>;
+    constexpr std::size_t bs = tracked::block_size; // 16 elements
+
+    std::uint64_t block_hash(std::vector<std::int32_t> const& v, std::size_t b) {
+        const std::size_t f = b * bs, l = std::min(f + bs, v.size());
+        return hash(dyn_array_view<std::int32_t const>(v.data() + f, l - f));
+    }
+
+    void check_state(tracked& t, std::vector<std::int32_t> const& ref, std::set<std::size_t> const& dirty) {
+        CZ_CHECK(t.size() == ref.size() && std::equal(t.begin(), t.end(), ref.begin()));
+
+        const std::size_t blocks = (ref.size() + bs - 1) / bs;
+        std::vector<std::size_t> reported;
+        for (auto const& r : t.dirty_ranges()) {
+            CZ_CHECK(r.first < r.second && r.first % bs == 0);
+            for (std::size_t b = r.first / bs; b * bs < r.second; ++b) {
+                reported.push_back(b);
+            }
+        }
+        std::vector<std::size_t> expected;
+        for (auto b : dirty) {
+            if (b < blocks) {
+                expected.push_back(b);
+            }
+        }
+        CZ_CHECK(reported == expected);
+
+        auto const& sums = t.checksums();
+        CZ_CHECK(sums.size() == blocks);
+        for (std::size_t b = 0; b < blocks && b < sums.size(); ++b) {
+            CZ_CHECK(sums[b] == block_hash(ref, b));
+        }
+    }
+
+    void test_random_mutations() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 50; ++round) {
+            std::vector<std::int32_t> ref(rng() % 200);
+            dyn_array<std::int32_t> init;
+            for (auto& x : ref) {
+                x = static_cast<std::int32_t>(rng() % 1000);
+                init.push_back(x);
+            }
+            tracked t(init);
+            std::set<std::size_t> dirty;
+            for (std::size_t b = 0; b * bs < ref.size(); ++b) {
+                dirty.insert(b);
+            }
+            check_state(t, ref, dirty);
+            t.clear_dirty();
+            dirty.clear();
+
+            for (int step = 0; step < 200; ++step) {
+                const std::size_t n = ref.size();
+                const auto v = static_cast<std::int32_t>(rng() % 1000);
+                switch (rng() % 9) {
+                case 0:
+                    if (n != 0) {
+                        const std::size_t i = rng() % n;
+                        t[i] = v;
+                        ref[i] = v;
+                        dirty.insert(i / bs);
+                    }
+                    break;
+                case 1:
+                    if (n != 0) {
+                        const std::size_t i = rng() % n;
+                        t[i] += v;
+                        ++t[i];
+                        ref[i] += v + 1;
+                        dirty.insert(i / bs);
+                    }
+                    break;
+                case 2:
+                    if (n != 0) {
+                        // a write of the value already there is still reported
+                        const std::size_t i = rng() % n;
+                        t[i] = ref[i];
+                        dirty.insert(i / bs);
+                    }
+                    break;
+                case 3:
+                    t.push_back(v);
+                    dirty.insert(n / bs);
+                    ref.push_back(v);
+                    break;
+                case 4:
+                    if (n != 0) {
+                        CZ_CHECK(t.pop_back() == ref.back());
+                        dirty.insert((n - 1) / bs);
+                        ref.pop_back();
+                    }
+                    break;
+                case 5:
+                    if (n != 0) {
+                        const std::size_t i = rng() % n;
+                        t.remove_at(i);
+                        for (std::size_t b = i / bs; b * bs < n; ++b) {
+                            dirty.insert(b);
+                        }
+                        ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(i));
+                    }
+                    break;
+                case 6: {
+                    const std::size_t m = rng() % 250;
+                    t.resize(m);
+                    if (m < n) {
+                        dirty.insert(m / bs);
+                    } else {
+                        for (std::size_t b = n / bs; b * bs < m; ++b) {
+                            dirty.insert(b);
+                        }
+                    }
+                    ref.resize(m);
+                    break;
+                }
+                case 7: {
+                    if (n != 0) {
+                        const std::size_t f = rng() % n, l = f + rng() % (n - f + 1);
+                        t.mark_dirty(f, l);
+                        if (f < l) {
+                            for (std::size_t b = f / bs; b <= (l - 1) / bs; ++b) {
+                                dirty.insert(b);
+                            }
+                        }
+                    }
+                    break;
+                }
+                default:
+                    check_state(t, ref, dirty);
+                    t.clear_dirty();
+                    dirty.clear();
+                    CZ_CHECK(t.dirty_ranges().is_empty());
+                }
+            }
+            check_state(t, ref, dirty);
+        }
+    }
+}
+
+int main() {
+    test_random_mutations();
+    return test::report("tracked_dyn_array");
+}
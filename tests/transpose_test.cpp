@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array_simd.hpp"
+#include "dyn_matrix.hpp"
+
+// transpose32 against the index definition at every level the CPU supports, for shapes on and off the
+// kernels' 4x4 / 8x8 tiles; the square, cycle-following and dyn_matrix in-place transposes and the AoS/SoA
+// helpers against an out-of-place reference
+
+using namespace cz;
+
+namespace {
+
+    void test_transpose32(simd_level) {
+        const std::size_t dims[] = {1, 2, 3, 7, 8, 9, 16, 31, 33, 64, 100};
+        for (std::size_t rows : dims) {
+            for (std::size_t cols : dims) {
+                std::vector<std::uint32_t> src(rows * cols), dst(rows * cols);
+                for (auto& x : src) {
+                    x = static_cast<std::uint32_t>(test::rng()());
+                }
+                detail::simd::transpose32(src.data(), dst.data(), rows, cols);
+                for (std::size_t i = 0; i < rows; ++i) {
+                    for (std::size_t j = 0; j < cols; ++j) {
+                        CZ_CHECK(dst[j * rows + i] == src[i * cols + j]);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    T make(std::uint64_t v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(v % 40, static_cast<char>('a' + v % 26));
+        } else {
+            return static_cast<T>(v);
+        }
+    }
+
+    // dst[j * rows + i] = src[i * cols + j], element by element
+    template <typename T>
+    std::vector<T> reference_transpose(std::vector<T> const& src, std::size_t rows, std::size_t cols) {
+        std::vector<T> dst(src.size());
+        for (std::size_t i = 0; i < rows; ++i) {
+            for (std::size_t j = 0; j < cols; ++j) {
+                dst[j * rows + i] = src[i * cols + j];
+            }
+        }
+        return dst;
+    }
+
+    template <typename T>
+    bool same(T const* p, std::vector<T> const& ref) {
+        for (std::size_t k = 0; k < ref.size(); ++k) {
+            if (!(p[k] == ref[k])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    void test_in_place() {
+        for (std::size_t rows = 1; rows <= 40; ++rows) {
+            for (std::size_t cols = 1; cols <= 40; ++cols) {
+                std::vector<T> src(rows * cols);
+                for (auto& x : src) {
+                    x = make<T>(test::rng()());
+                }
+                const std::vector<T> expected = reference_transpose(src, rows, cols);
+
+                dyn_array<T> arr(src.size());
+                for (std::size_t k = 0; k < src.size(); ++k) {
+                    arr[k] = src[k];
+                }
+                CZ_CHECK(same(transposed(arr, rows, cols).data(), expected));
+
+                transpose_in_place(arr, rows, cols);
+                CZ_CHECK(same(arr.data(), expected));
+                transpose_in_place(arr, cols, rows);
+                CZ_CHECK(same(arr.data(), src));
+
+                if (rows == cols) {
+                    std::vector<T> square = src;
+                    transpose_square_in_place(square.data(), rows);
+                    CZ_CHECK(square == expected);
+                }
+
+                dyn_array<T> row_major(src.size());
+                for (std::size_t k = 0; k < src.size(); ++k) {
+                    row_major[k] = src[k];
+                }
+                dyn_matrix<T> right(rows, cols, row_major);
+                dyn_matrix<T, layout_left> left(rows, cols, row_major);
+                right.transpose_in_place();
+                left.transpose_in_place();
+                CZ_CHECK(right.rows() == cols && right.cols() == rows);
+                CZ_CHECK(left.rows() == cols && left.cols() == rows);
+                bool ok = true;
+                for (std::size_t i = 0; i < rows; ++i) {
+                    for (std::size_t j = 0; j < cols; ++j) {
+                        ok = ok && right(j, i) == src[i * cols + j] && left(j, i) == src[i * cols + j];
+                    }
+                }
+                CZ_CHECK(ok);
+                CZ_CHECK(same(right.data(), expected));
+                CZ_CHECK(same(left.data(), src));
+            }
+        }
+    }
+
+    struct record {
+        std::uint32_t id;
+        double weight;
+        std::string name;
+    };
+
+    void test_aos_soa() {
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{100}}) {
+            dyn_array<record> aos;
+            for (std::size_t k = 0; k < n; ++k) {
+                const std::uint64_t v = test::rng()();
+                aos.push_back(record{static_cast<std::uint32_t>(v), static_cast<double>(v % 1000) / 8, make<std::string>(v)});
+            }
+
+            auto soa = aos_to_soa(aos, &record::id, &record::weight, &record::name);
+            auto const& ids = std::get<0>(soa);
+            auto const& weights = std::get<1>(soa);
+            auto const& names = std::get<2>(soa);
+            CZ_CHECK(ids.size() == n && weights.size() == n && names.size() == n);
+            bool ok = true;
+            for (std::size_t k = 0; k < n; ++k) {
+                ok = ok && ids[k] == aos[k].id && weights[k] == aos[k].weight && names[k] == aos[k].name;
+            }
+            CZ_CHECK(ok);
+
+            // scatter a rewritten column back, leaving the other fields alone
+            dyn_array<std::string> renamed;
+            for (std::size_t k = 0; k < n; ++k) {
+                renamed.push_back(names[k] + "#" + std::to_string(k));
+            }
+            scatter_field(aos, &record::name, renamed);
+            std::vector<std::uint32_t> new_ids(n);
+            for (std::size_t k = 0; k < n; ++k) {
+                new_ids[k] = ids[k] ^ 0x5a5a5a5au;
+            }
+            scatter_field(aos, &record::id, new_ids);
+            for (std::size_t k = 0; k < n; ++k) {
+                ok = ok && aos[k].name == renamed[k] && aos[k].id == new_ids[k] && aos[k].weight == weights[k];
+            }
+            CZ_CHECK(ok);
+            CZ_CHECK(gather_field(aos, &record::name).size() == n);
+        }
+    }
+}
+
+int main() {
+    test::for_each_simd_level([](simd_level level) {
+        test_transpose32(level);
+        // 4-byte trivially copyable elements take the transpose32 path for the out-of-place reference check
+        test_in_place<std::uint32_t>();
+    });
+    test_in_place<std::uint64_t>();
+    test_in_place<std::string>();
+    test_aos_soa();
+    return test::report("transpose");
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "dyn_array.hpp"
+
+// unique, sort_unique and dedup_by_key against std::unique / std::sort on runs of repeats, with a counted
+// element type to check that every vacated slot is destroyed and shrink gives the memory back
+
+using namespace cz;
+
+namespace {
+
+    long live = 0;
+
+    struct counted {
+        int value = 0;
+
+        counted(int v = 0) : value{v} {
+            ++live;
+        }
+
+        counted(counted const& other) : value{other.value} {
+            ++live;
+        }
+
+        counted& operator=(counted const&) = default;
+
+        ~counted() {
+            --live;
+        }
+
+        bool operator==(counted const& other) const noexcept {
+            return value == other.value;
+        }
+
+        bool operator<(counted const& other) const noexcept {
+            return value < other.value;
+        }
+    };
+
+    template <typename T>
+    T make(std::uint64_t v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            return std::string(20 + v % 3, static_cast<char>('a' + v % 3)); // past the small-string buffer
+        } else {
+            return T(static_cast<int>(v));
+        }
+    }
+
+    template <typename T>
+    void test_random() {
+        auto& rng = test::rng();
+        for (int round = 0; round < 300; ++round) {
+            std::vector<T> ref;
+            for (std::size_t k = rng() % 100; k > 0; --k) {
+                const T v = make<T>(rng() % 5);
+                for (std::size_t r = rng() % 4; r > 0; --r) {
+                    ref.push_back(v);
+                }
+            }
+            const dyn_array<T> original(ref.begin(), ref.end());
+            const bool shrink = rng() % 2 == 0;
+
+            {
+                auto a = original;
+                auto expect = ref;
+                expect.erase(std::unique(expect.begin(), expect.end()), expect.end());
+                CZ_CHECK(a.unique(shrink) == ref.size() - expect.size());
+                CZ_CHECK(a.size() == expect.size() && std::equal(a.begin(), a.end(), expect.begin()));
+                CZ_CHECK(!shrink || a.cap() == a.size());
+            }
+            {
+                auto a = original;
+                auto expect = ref;
+                std::sort(expect.begin(), expect.end());
+                expect.erase(std::unique(expect.begin(), expect.end()), expect.end());
+                CZ_CHECK(a.sort_unique(shrink) == ref.size() - expect.size());
+                CZ_CHECK(a.size() == expect.size() && std::equal(a.begin(), a.end(), expect.begin()));
+            }
+            {
+                // runs of equal size or of equal value, keeping the first element of each run
+                auto a = original;
+                const auto key = [](T const& x) {
+                    if constexpr (std::is_same<T, std::string>::value) {
+                        return x.size();
+                    } else {
+                        return x.value % 2;
+                    }
+                };
+                std::vector<T> expect;
+                for (auto const& x : ref) {
+                    if (expect.empty() || key(expect.back()) != key(x)) {
+                        expect.push_back(x);
+                    }
+                }
+                CZ_CHECK(a.dedup_by_key(key, shrink) == ref.size() - expect.size());
+                CZ_CHECK(a.size() == expect.size() && std::equal(a.begin(), a.end(), expect.begin()));
+            }
+        }
+    }
+}
+
+int main() {
+    test_random<counted>();
+    CZ_CHECK(live == 0);
+    test_random<std::string>();
+    return test::report("unique");
+}
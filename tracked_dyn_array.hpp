@@ -0,0 +1,316 @@
+#ifndef TRACKED_DYN_ARRAY_HPP
+#define TRACKED_DYN_ARRAY_HPP
+
+#include <cstdint>
+#include <utility>
+
+#include "dyn_array.hpp"
+
+namespace cz {
+
+    // dyn_array that records which fixed-size blocks were written since the last clear_dirty(), and keeps
+    // a checksum per block; checksums of written blocks are recomputed lazily, the next time they are read
+    template <
+        typename T,
+        typename alloc_t = std::allocator<T>,
+        typename SizeT = std::size_t,
+        std::size_t block_bytes = 4096
+    >
+    class tracked_dyn_array {
+
+        static_assert(block_bytes > 0);
+
+    public:
+
+        using array_type = dyn_array<T, alloc_t, SizeT>;
+        using value_type = T;
+        using allocator_type = alloc_t;
+        using size_type = SizeT;
+        using const_reference = T const&;
+        using const_pointer = T const*;
+        using const_iterator = T const*;
+        using dirty_range = std::pair<size_type, size_type>; // [first, last) element indexes
+
+        static constexpr size_type block_size = sizeof(T) >= block_bytes ? 1 : static_cast<size_type>(block_bytes / sizeof(T));
+
+        // assignments, compound assignments and increments through the proxy mark the element's block dirty
+        class write_proxy {
+            friend class tracked_dyn_array;
+
+            tracked_dyn_array* m_owner;
+            size_type m_idx;
+
+            write_proxy(tracked_dyn_array* owner, size_type idx) noexcept
+                : m_owner{owner}
+                , m_idx{idx} {
+            }
+
+            dyn_array_always_inline T& _written() {
+                m_owner->_mark_block(m_idx / block_size);
+                return m_owner->m_data[m_idx];
+            }
+
+        public:
+
+            write_proxy& operator=(const_reference value) {
+                m_owner->_mark_block(m_idx / block_size);
+                m_owner->m_data[m_idx] = value;
+                return *this;
+            }
+
+            write_proxy& operator=(T&& value) {
+                m_owner->_mark_block(m_idx / block_size);
+                m_owner->m_data[m_idx] = std::move(value);
+                return *this;
+            }
+
+            write_proxy& operator=(write_proxy const& other) {
+                return *this = static_cast<const_reference>(other);
+            }
+
+            template <typename U>
+            write_proxy& operator+=(U const& value) {
+                _written() += value;
+                return *this;
+            }
+
+            template <typename U>
+            write_proxy& operator-=(U const& value) {
+                _written() -= value;
+                return *this;
+            }
+
+            template <typename U>
+            write_proxy& operator*=(U const& value) {
+                _written() *= value;
+                return *this;
+            }
+
+            template <typename U>
+            write_proxy& operator/=(U const& value) {
+                _written() /= value;
+                return *this;
+            }
+
+            write_proxy& operator++() {
+                ++_written();
+                return *this;
+            }
+
+            write_proxy& operator--() {
+                --_written();
+                return *this;
+            }
+
+            value_type operator++(int) {
+                return _written()++;
+            }
+
+            value_type operator--(int) {
+                return _written()--;
+            }
+
+            dyn_array_always_inline operator const_reference() const noexcept {
+                return m_owner->m_data[m_idx];
+            }
+        };
+
+    private:
+
+        array_type m_data;
+        dyn_array<std::uint64_t> m_dirty;     // one bit per block written since clear_dirty()
+        dyn_array<std::uint64_t> m_stale;     // one bit per block written since its checksum was computed
+        dyn_array<std::uint64_t> m_checksums; // per block, current for every block not marked stale
+
+        static dyn_array_always_inline size_type _block_count(size_type n) noexcept {
+            return (n + block_size - 1) / block_size;
+        }
+
+        static void _set_bit(dyn_array<std::uint64_t>& bits, size_type b) {
+            const size_type word = b / 64;
+            if (word >= bits.size()) {
+                bits.resize(word + 1);
+            }
+            bits[word] |= std::uint64_t{1} << (b % 64);
+        }
+
+        void _mark_block(size_type b) {
+            _set_bit(m_dirty, b);
+            _set_bit(m_stale, b);
+        }
+
+        dyn_array_always_inline bool _is_block_marked(size_type b) const noexcept {
+            const size_type word = b / 64;
+            return word < m_dirty.size() && (m_dirty[word] >> (b % 64) & 1) != 0;
+        }
+
+        void _mark_elements(size_type f, size_type l) {
+            if (f >= l) {
+                return;
+            }
+
+            for (size_type b = f / block_size, lb = (l - 1) / block_size; b <= lb; ++b) {
+                _mark_block(b);
+            }
+        }
+
+        std::uint64_t _block_checksum(size_type b) const {
+            const size_type f = b * block_size;
+            const size_type l = std::min<size_type>(f + block_size, m_data.size());
+            return hash(dyn_array_view<T const, size_type>(m_data.data() + f, l - f));
+        }
+
+        // rehashes the blocks written since their checksum was last computed
+        void _refresh_checksums() {
+            const size_type blocks = _block_count(m_data.size());
+            m_checksums.resize(blocks);
+
+            for (size_type word = 0; word < m_stale.size(); ++word) {
+                for (std::uint64_t bits = m_stale[word]; bits != 0; bits &= bits - 1) {
+                    const size_type b = word * 64 + static_cast<size_type>(detail::bits::ctz64(bits));
+                    if (b < blocks) {
+                        m_checksums[b] = _block_checksum(b);
+                    }
+                }
+                m_stale[word] = 0;
+            }
+        }
+
+    public:
+
+        tracked_dyn_array() = default;
+
+        explicit tracked_dyn_array(array_type data)
+            : m_data{std::move(data)} {
+            _mark_elements(0, m_data.size());
+        }
+
+        dyn_array_always_inline write_proxy operator[](size_type idx) noexcept {
+            assert(idx < m_data.size());
+            return write_proxy(this, idx);
+        }
+
+        dyn_array_always_inline const_reference operator[](size_type idx) const noexcept {
+            assert(idx < m_data.size());
+            return m_data[idx];
+        }
+
+        // for writes done through raw pointers or references obtained elsewhere
+        void mark_dirty(size_type f, size_type l) { // [first, last)
+            assert(f <= l && l <= m_data.size());
+            _mark_elements(f, l);
+        }
+
+        void push_back(const_reference value) {
+            _mark_block(m_data.size() / block_size);
+            m_data.push_back(value);
+        }
+
+        void push_back(T&& value) {
+            _mark_block(m_data.size() / block_size);
+            m_data.push_back(std::move(value));
+        }
+
+        template <typename... Types>
+        void emplace_back(Types&&... args) {
+            _mark_block(m_data.size() / block_size);
+            m_data.emplace_back(std::forward<Types>(args)...);
+        }
+
+        value_type pop_back() {
+            assert(m_data.size() > 0);
+            _mark_block((m_data.size() - 1) / block_size);
+            return m_data.pop_back();
+        }
+
+        void remove_at(size_type idx) {
+            _mark_elements(idx, m_data.size());
+            m_data.remove_at(idx);
+        }
+
+        void resize(size_type n) {
+            const size_type old = m_data.size();
+            if (n < old) {
+                _mark_elements(n, n + 1);
+            } else {
+                _mark_elements(old, n);
+            }
+            m_data.resize(n);
+        }
+
+        void clear() {
+            _mark_elements(0, m_data.size());
+            m_data.clear();
+        }
+
+        // merged ranges of every block written since the last clear_dirty(), including writes that happened
+        // to restore the previous bytes: a checksum match is no proof nothing changed
+        dyn_array<dirty_range> dirty_ranges() const {
+            dyn_array<dirty_range> ranges;
+
+            const size_type blocks = _block_count(m_data.size());
+            for (size_type word = 0; word < m_dirty.size(); ++word) {
+                for (std::uint64_t bits = m_dirty[word]; bits != 0; bits &= bits - 1) {
+                    const size_type b = word * 64 + static_cast<size_type>(detail::bits::ctz64(bits));
+                    if (b >= blocks) {
+                        continue;
+                    }
+
+                    const size_type f = b * block_size;
+                    const size_type l = std::min<size_type>(f + block_size, m_data.size());
+                    if (!ranges.is_empty() && ranges.back().second == f) {
+                        ranges.back().second = l;
+                    } else {
+                        ranges.emplace_back(f, l);
+                    }
+                }
+            }
+
+            return ranges;
+        }
+
+        // forgets the dirty blocks once they have been synced; their checksums are brought up to date first
+        void clear_dirty() {
+            _refresh_checksums();
+            for (auto& word : m_dirty) {
+                word = 0;
+            }
+        }
+
+        dyn_array_always_inline bool is_block_dirty(size_type b) const noexcept {
+            return _is_block_marked(b);
+        }
+
+        // one checksum per block of the current contents; rehashes whatever was written since the last call
+        dyn_array<std::uint64_t> const& checksums() {
+            _refresh_checksums();
+            return m_checksums;
+        }
+
+        dyn_array_always_inline array_type const& array() const noexcept {
+            return m_data;
+        }
+
+        dyn_array_always_inline const_pointer data() const noexcept {
+            return m_data.data();
+        }
+
+        dyn_array_always_inline const_iterator begin() const noexcept {
+            return m_data.begin();
+        }
+
+        dyn_array_always_inline const_iterator end() const noexcept {
+            return m_data.end();
+        }
+
+        dyn_array_always_inline size_type size() const noexcept {
+            return m_data.size();
+        }
+
+        dyn_array_always_inline bool is_empty() const noexcept {
+            return m_data.is_empty();
+        }
+    };
+}
+
+#endif